@@ -10,53 +10,18 @@ countries.
 #include "MathUtils.h"
 #include "Log.h"
 
-#include <Vuforia/Vuforia.h>
-#include <Vuforia/Tool.h>
-#include <Vuforia/DataSet.h>
-#include <Vuforia/Device.h>
-#include <Vuforia/Renderer.h>
-#include <Vuforia/CameraDevice.h>
-#include <Vuforia/VideoBackgroundConfig.h>
-#include <Vuforia/UpdateCallback.h>
-#include <Vuforia/Matrices.h>
-#include <Vuforia/State.h>
-#include <Vuforia/TrackerManager.h>
-#include <Vuforia/ObjectTracker.h>
-#include <Vuforia/Trackable.h>
-#include <Vuforia/StateUpdater.h>
-#include <Vuforia/ModelTarget.h>
-#include <Vuforia/VideoBackgroundTextureInfo.h>
-#include <Vuforia/ImageTargetResult.h>
-#include <Vuforia/ModelTargetResult.h>
-#include <Vuforia/RenderingPrimitives.h>
-#include <Vuforia/PositionalDeviceTracker.h>
-#include <Vuforia/DeviceTrackableResult.h>
-#include <Vuforia/GuideView.h>
-#include <Vuforia/Image.h>
-
-#if defined(ANDROID) || defined (__ANDROID__)  // ANDROID
-#include <Vuforia/Android/Vuforia_Android.h>
-#include <Vuforia/GLRenderer.h>
-#elif defined(WINAPI_FAMILY) // UWP
-#include <Vuforia/UWP/Vuforia_UWP.h>
-#include <Vuforia/UWP/DXRenderer.h>
-#else // iOS
-#include <Vuforia/iOS/Vuforia_iOS.h>
-#include <Vuforia/iOS/MetalRenderer.h>
-#endif
-
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <functional>
 #include <string>
+#include <utility>
 
 
 namespace
 {
-    constexpr char licenseKey[] = "";
-
-    constexpr float NEAR_PLANE = 0.01f;
-    constexpr float FAR_PLANE = 5.f;
+    /// Extra extrapolation allowed on top of the prediction latency budget, in seconds
+    constexpr double PREDICTION_HEADROOM = 0.05;
 }
 
 
@@ -64,30 +29,32 @@ namespace
 AppController public methods
 ===============================================================================*/
 
+AppController::AppController(std::unique_ptr<TrackingBackend> backend)
+    : mBackend(std::move(backend))
+{
+}
+
+
+AppController::~AppController()
+{
+    stopTrackingThread();
+}
+
+
 void AppController::initAR(const InitConfig& initConfig, int target)
 {
-    mVuforiaInitFlags = initConfig.vuforiaInitFlags;
     mShowErrorCallback = initConfig.showErrorCallback;
     mInitDoneCallback = initConfig.initDoneCallback;
     mTarget = target;
 
-    mDoneOneTimeRenderingConfiguration = false;
-    mCameraIsActive = false;
-    mCameraIsStarted = false;
-
-    mGuideViewModelTarget = nullptr;
-    
-    if (!initVuforiaInternal(initConfig.appData))
-    {
-        return;
-    }
+    mGuideView = GuideViewState();
     
-    if (!initTrackers())
+    if (!mBackend->init(initConfig.appData, initConfig.vuforiaInitFlags, mShowErrorCallback))
     {
         return;
     }
 
-    if (!loadTrackerData())
+    if (!mBackend->loadData(target))
     {
         return;
     }
@@ -98,271 +65,267 @@ void AppController::initAR(const InitConfig& initConfig, int target)
 
 bool AppController::startAR()
 {
-    if (mCameraIsStarted || mCameraIsActive)
+    if (mBackend->isStarted())
     {
         LOG("Application logic error, attempt to startAR when already started");
         return false;
     }
 
-    // initialize the camera
-    if (! Vuforia::CameraDevice::getInstance().init())
-    {
-        mShowErrorCallback("Failed to initialize the camera");
-        return false;
-    }
+    return mBackend->start();
+}
 
-    // select the default video mode
-    if(! Vuforia::CameraDevice::getInstance().selectVideoMode(mCameraMode))
-    {
-        mShowErrorCallback("Failed to set the camera mode");
-        return false;
-    }
 
-    // set the FPS to its recommended value
-    int recommendedFps = Vuforia::Renderer::getInstance().getRecommendedFps();
-    Vuforia::Renderer::getInstance().setTargetFps(recommendedFps);
+void AppController::pauseAR()
+{
+    joinTrackingThread();
+    mBackend->pause();
+}
 
-    if (!startTrackers() )
-    {
-        mShowErrorCallback("Failed to start trackers");
-        return false;
-    }
 
-    if (!Vuforia::CameraDevice::getInstance().start())
-    {
-        mShowErrorCallback("Failed to start the camera");
-        return false;
-    }
+void AppController::resumeAR()
+{
+    mBackend->resume();
 
-    // Set camera to autofocus
-    if (!Vuforia::CameraDevice::getInstance().setFocusMode(Vuforia::CameraDevice::FOCUS_MODE_CONTINUOUSAUTO))
+    if (mTrackingInterval > 0.0)
     {
-        LOG("Failed to set camera to continuous autofocus, camera may not support this");
+        startTrackingThread(mTrackingInterval);
     }
+}
 
-    mCameraIsActive = true;
-    mCameraIsStarted = true;
-    return true;
-    
+
+void AppController::stopAR()
+{
+    stopTrackingThread();
+    mBackend->stop();
 }
 
 
-void AppController::pauseAR()
+void AppController::startTrackingThread(double interval)
 {
-    bool successfullyPaused = true;
-    std::string cameraErrorMessage;
-    
-    if (mCameraIsActive)
-    {
-        // Stop and deinit the camera
-        if(! Vuforia::CameraDevice::getInstance().stop())
-        {
-            cameraErrorMessage = "Error stopping the camera";
-            successfullyPaused = false;
-        }
-        if(! Vuforia::CameraDevice::getInstance().deinit())
-        {
-            cameraErrorMessage = "Error de-initializing the camera";
-            successfullyPaused = false;
-        }
-        mCameraIsActive = false;
-    }
+    stopTrackingThread();
 
-    stopTrackers();
+    mTrackingInterval = interval;
+    mStopTrackingThread = false;
+    mTrackingThread = std::thread(&AppController::runTrackingThread, this, interval);
+}
 
-    Vuforia::onPause();
-    
-    if(!successfullyPaused)
-    {
-        LOG("Error pausing AR: %s",cameraErrorMessage.c_str());
-    }
+
+void AppController::stopTrackingThread()
+{
+    joinTrackingThread();
+    mTrackingInterval = 0.0;
 }
 
 
-void AppController::resumeAR()
+void AppController::deinitAR()
 {
-    Vuforia::onResume();
+    mBackend->deinit();
+}
 
-    startTrackers();
-    
-    std::string cameraErrorMessage;
-    bool successfullyResumed = true;
-    // if the camera was previously started, but not currently active, then
-    // we restart it
-    if ((mCameraIsStarted) && (!mCameraIsActive))
-    {
-        
-        // initialize the camera
-        if ( !Vuforia::CameraDevice::getInstance().init() )
-        {
-            cameraErrorMessage = "Failed to initialize the camera.";
-            successfullyResumed = false;
-        }
-        else if ( !Vuforia::CameraDevice::getInstance().start() )
-        {
-            cameraErrorMessage = "Failed to start the camera.";
-            successfullyResumed = false;
-        }
-        else
-        {
-             mCameraIsActive = true;
-        }
-    }
-    
-    if(!successfullyResumed)
-    {
-        LOG("Error resuming AR: %s", cameraErrorMessage.c_str());
-    }
 
-    if (mCameraIsStarted)
-    {
-        updateRenderingPrimitives();
-    }
+void AppController::cameraPerformAutoFocus()
+{
+    mBackend->cameraPerformAutoFocus();
 }
 
 
-void AppController::stopAR()
+void AppController::cameraRestoreAutoFocus()
 {
-    // Stop the camera
-    if (mCameraIsActive)
-    {
-        // Stop and deinit the camera
-        Vuforia::CameraDevice::getInstance().stop();
-        Vuforia::CameraDevice::getInstance().deinit();
-        mCameraIsActive = false;
-    }
-    mCameraIsStarted = false;
+    mBackend->cameraRestoreAutoFocus();
+}
+
 
-    // Stop trackers
-    stopTrackers();
+void AppController::updateRenderingPrimitives()
+{
+    mBackend->updateRenderingPrimitives();
 }
 
 
-void AppController::deinitAR()
+bool AppController::configureRendering(int width, int height, int orientation)
 {
-    Vuforia::onPause();
+    return mBackend->configureRendering(width, height, orientation);
+}
 
-    // ask the application to unload the data associated to the trackers
-    if(!unloadTrackerData())
+
+void AppController::publishFrameSnapshot()
+{
+    std::lock_guard<std::mutex> lock(mPublishMutex);
+
+    auto renderState = mBackend->update(mTrackingFrame, mGuideViewImages);
+    if (mTrackingLogWriter.isOpen())
     {
-        LOG("Error unloading tracker data.");
+        mTrackingLogWriter.write(mTrackingFrame);
     }
-    
-    // ask the application to deinit the trackers
-    deinitTrackers();
 
-    Vuforia::deinit();
+    // Predict from now rather than from the camera frame, so the time the frame spent
+    // in Vuforia and in update is part of the extrapolation
+    publishCurrentFrame(std::move(renderState), mBackend->getCurrentTimeStamp());
 }
 
 
-void AppController::cameraPerformAutoFocus()
+void AppController::publishTrackingFrame(const TrackingFrame& frame)
 {
-    Vuforia::CameraDevice::getInstance().setFocusMode(Vuforia::CameraDevice::FOCUS_MODE_TRIGGERAUTO);
+    std::lock_guard<std::mutex> lock(mPublishMutex);
+
+    mTrackingFrame = frame;
+    // Recorded frames carry no Guide View images, only their sizes
+    mGuideViewImages.assign(frame.results.size(), nullptr);
+
+    // The backend clock is unrelated to the recorded timestamps, the capture time stands in for now
+    publishCurrentFrame(nullptr, frame.captureTime);
 }
 
 
-void AppController::cameraRestoreAutoFocus()
+bool AppController::acquireFrameSnapshot()
 {
-    Vuforia::CameraDevice::getInstance().setFocusMode(Vuforia::CameraDevice::FOCUS_MODE_CONTINUOUSAUTO);
+    // Keep the previous snapshot if the producer has not published a new one
+    mFrameSnapshots.acquireLatest();
+    return mFrameSnapshots.getReadBuffer().sequence != 0;
 }
 
 
-void AppController::updateRenderingPrimitives()
+void AppController::initReplay(int target)
 {
-    mCurrentRenderingPrimitives.reset(new Vuforia::RenderingPrimitives(Vuforia::Device::getInstance().getRenderingPrimitives()));
+    std::lock_guard<std::mutex> lock(mPublishMutex);
+
+    mTarget = target;
+    mDevicePosePredictor.reset();
+    mTargetPosePredictor.reset();
+    mGuideView = GuideViewState();
+    mFrameCache.valid = false;
 }
 
 
-bool AppController::configureRendering(int width, int height, int orientation)
+bool AppController::startRecording(const std::string& path)
 {
-    if (!mCameraIsStarted)
-    {
-        return false;
-    }
+    std::lock_guard<std::mutex> lock(mPublishMutex);
+    return mTrackingLogWriter.open(path, mTarget);
+}
+
+
+void AppController::stopRecording()
+{
+    std::lock_guard<std::mutex> lock(mPublishMutex);
+    mTrackingLogWriter.close();
+}
 
-    mOrientation = orientation;
-    mDisplayAspectRatio = (float)width / height;
 
-    setVuforiaOrientation(orientation);
+bool AppController::isRecording() const
+{
+    std::lock_guard<std::mutex> lock(mPublishMutex);
+    return mTrackingLogWriter.isOpen();
+}
+
 
-    if (!mDoneOneTimeRenderingConfiguration)
+bool AppController::prepareToRender(double* viewport, Vuforia::RenderData* renderData,
+                                    Vuforia::TextureUnit* videoBackgroundTextureUnit, Vuforia::TextureData* videoBackgroundTexture)
+{
+    if (!acquireFrameSnapshot() || mBackend->getRenderingPrimitives() == nullptr)
     {
-        mDoneOneTimeRenderingConfiguration = true;
-        // Tell Vuforia Engine we've created a drawing surface
-        Vuforia::onSurfaceCreated();
+        return false;
     }
 
-    int smallerSize = std::min(width, height);
-    int largerSize = std::max(width, height);
-    if (isScreenPortrait())
+    // Replayed snapshots have nothing to render the video background from
+    const auto* renderState = mFrameSnapshots.getReadBuffer().renderState.get();
+    if (renderState == nullptr)
     {
-        Vuforia::onSurfaceChanged(smallerSize, largerSize);
+        return false;
     }
-    else
+
+    mRenderingFrame = true;
+    return mBackend->beginRender(*renderState, viewport, renderData, videoBackgroundTextureUnit, videoBackgroundTexture);
+}
+
+
+void AppController::finishRender(Vuforia::RenderData* renderData)
+{
+    if (mRenderingFrame)
     {
-        Vuforia::onSurfaceChanged(largerSize, smallerSize);
+        mBackend->endRender(renderData);
+        mRenderingFrame = false;
     }
+}
+
 
-    configureVideoBackground(float(width), float(height));
 
+bool AppController::getOrigin(Vuforia::Matrix44F& projectionMatrix,
+                              Vuforia::Matrix44F& modelViewMatrix)
+{
+    const auto& snapshot = mFrameSnapshots.getReadBuffer();
+    if (!snapshot.originValid)
+    {
+        return false;
+    }
+
+    projectionMatrix = snapshot.originProjection;
+    modelViewMatrix = snapshot.originModelView;
     return true;
 }
 
 
-bool AppController::prepareToRender(double* viewport, Vuforia::RenderData* renderData,
-                                    Vuforia::TextureUnit* videoBackgroundTextureUnit, Vuforia::TextureData* videoBackgroundTexture)
+bool AppController::getImageTargetResult(Vuforia::Matrix44F& projectionMatrix,
+                                         Vuforia::Matrix44F& modelViewMatrix,
+                                         Vuforia::Matrix44F& scaledModelViewMatrix)
 {
-    mVuforiaState = Vuforia::TrackerManager::getInstance().getStateUpdater().updateState();
-    auto& renderer = Vuforia::Renderer::getInstance();
-    renderer.begin(mVuforiaState, renderData);
-
-    if (mCurrentRenderingPrimitives == nullptr)
+    const auto& snapshot = mFrameSnapshots.getReadBuffer();
+    if (!snapshot.targetValid || mTarget != IMAGE_TARGET_ID)
     {
-        updateRenderingPrimitives();
+        return false;
     }
-    
-    // Set up the viewport
-    Vuforia::Vec4I viewportInfo;
-    // We're writing directly to the screen, so the viewport is relative to the screen
-    viewportInfo = mCurrentRenderingPrimitives->getViewport(Vuforia::VIEW_SINGULAR);
-    viewport[0] = viewportInfo.data[0];
-    viewport[1] = viewportInfo.data[1];
-    viewport[2] = viewportInfo.data[2];
-    viewport[3] = viewportInfo.data[3];
-    viewport[4] = 0.0f;
-    viewport[5] = 1.0f;
-
-    if (videoBackgroundTexture != nullptr)
+
+    projectionMatrix = snapshot.targetProjection;
+    modelViewMatrix = snapshot.targetModelView;
+    scaledModelViewMatrix = snapshot.targetModelViewScaled;
+    return true;
+}
+
+
+bool AppController::getModelTargetResult(Vuforia::Matrix44F& projectionMatrix,
+                                         Vuforia::Matrix44F& modelViewMatrix,
+                                         Vuforia::Matrix44F& scaledModelViewMatrix)
+{
+    const auto& snapshot = mFrameSnapshots.getReadBuffer();
+    if (!snapshot.targetValid || mTarget != MODEL_TARGET_ID)
     {
-        renderer.setVideoBackgroundTexture(*videoBackgroundTexture);
+        return false;
     }
 
-    return renderer.updateVideoBackgroundTexture(videoBackgroundTextureUnit);
+    projectionMatrix = snapshot.targetProjection;
+    modelViewMatrix = snapshot.targetModelView;
+    scaledModelViewMatrix = snapshot.targetModelViewScaled;
+    return true;
 }
 
 
-void AppController::finishRender(Vuforia::RenderData* renderData)
+bool AppController::getModelTargetGuideView(Vuforia::Matrix44F& projectionMatrix,
+                                            Vuforia::Matrix44F& modelViewMatrix,
+                                            Vuforia::Image** guideViewImage)
 {
-    Vuforia::Renderer::getInstance().end(renderData);
+    const auto& snapshot = mFrameSnapshots.getReadBuffer();
+    if (!snapshot.guideViewValid)
+    {
+        return false;
+    }
+
+    projectionMatrix = snapshot.guideViewProjection;
+    modelViewMatrix = snapshot.guideViewModelView;
+    *guideViewImage = snapshot.guideViewImage;
+    return true;
 }
 
 
-bool AppController::getOrigin(Vuforia::Matrix44F& projectionMatrix,
-                              Vuforia::Matrix44F& modelViewMatrix)
+bool AppController::computeOrigin(Vuforia::Matrix44F& projectionMatrix,
+                                  Vuforia::Matrix44F& modelViewMatrix)
 {
-    auto origin = mVuforiaState.getDeviceTrackableResult();
-    if (origin != nullptr)
+    if (mTrackingFrame.hasDeviceResult)
     {
-        if (origin->getStatus() == Vuforia::TrackableResult::STATUS::TRACKED &&
-            origin->getStatusInfo() == Vuforia::TrackableResult::STATUS_INFO::NORMAL)
+        const TrackingResult& origin = mTrackingFrame.deviceResult;
+        if (origin.status == TrackingResult::TRACKED &&
+            origin.statusInfo == TrackingResult::NORMAL)
         {
-            Vuforia::Matrix44F viewMatrix = Vuforia::Tool::convertPose2GLMatrix(origin->getPose());
-            modelViewMatrix = MathUtils::Matrix44FTranspose(MathUtils::Matrix44FInverse(viewMatrix));
-
-            projectionMatrix = Vuforia::Tool::convertPerspectiveProjection2GLMatrix(
-                mCurrentRenderingPrimitives->getProjectionMatrix(Vuforia::VIEW_SINGULAR,
-                                                                 mVuforiaState.getCameraCalibration()),
-                NEAR_PLANE, FAR_PLANE);
+            const auto& frameCache = getFrameCache();
+            modelViewMatrix = frameCache.viewMatrix;
+            projectionMatrix = frameCache.projectionMatrix;
 
             return true;
         }
@@ -372,34 +335,26 @@ bool AppController::getOrigin(Vuforia::Matrix44F& projectionMatrix,
 }
 
 
-bool AppController::getImageTargetResult(Vuforia::Matrix44F& projectionMatrix,
-                                         Vuforia::Matrix44F& modelViewMatrix,
-                                         Vuforia::Matrix44F& scaledModelViewMatrix)
+bool AppController::computeImageTargetResult(Vuforia::Matrix44F& projectionMatrix,
+                                             Vuforia::Matrix44F& modelViewMatrix,
+                                             Vuforia::Matrix44F& scaledModelViewMatrix)
 {
-    const auto& trackableResultList = mVuforiaState.getTrackableResults();
-    for (const auto* result : trackableResultList)
+    for (size_t i = 0; i < mTrackingFrame.results.size(); i++)
     {
+        const TrackingResult& result = mTrackingFrame.results[i];
 
-        if (result->isOfType(Vuforia::ImageTargetResult::getClassType()) && mTarget == IMAGE_TARGET_ID)
+        if (result.type == TrackingResultType::IMAGE_TARGET && mTarget == IMAGE_TARGET_ID)
         {
-            const Vuforia::ImageTargetResult* itResult = static_cast<const Vuforia::ImageTargetResult*>(result);
-            const Vuforia::ImageTarget& target = itResult->getTrackable();
-
-            Vuforia::Matrix44F viewMatrix = Vuforia::Tool::convertPose2GLMatrix(mVuforiaState.getDeviceTrackableResult()->getPose());
-            viewMatrix = MathUtils::Matrix44FTranspose(MathUtils::Matrix44FInverse(viewMatrix));
-
-            // Get the projection matrix
-            projectionMatrix = Vuforia::Tool::convertPerspectiveProjection2GLMatrix(
-                mCurrentRenderingPrimitives->getProjectionMatrix(Vuforia::VIEW_SINGULAR,
-                                                                 mVuforiaState.getCameraCalibration()),
-                NEAR_PLANE, FAR_PLANE);
+            // View and projection matrices are shared by all getters for this frame
+            const auto& frameCache = getFrameCache();
+            projectionMatrix = frameCache.projectionMatrix;
 
             // Get object pose and populate modelViewMatrix
-            modelViewMatrix = Vuforia::Tool::convertPose2GLMatrix(result->getPose());
-            MathUtils::multiplyMatrix(viewMatrix, modelViewMatrix, modelViewMatrix);
+            modelViewMatrix = getPredictedPose(result, mTargetPosePredictor);
+            MathUtils::multiplyMatrix(frameCache.viewMatrix, modelViewMatrix, modelViewMatrix);
 
             // Calculate a scaled modelViewMatrix for rendering a unit bounding box
-            auto targetSize = target.getSize();
+            auto targetSize = result.size;
             // z-dimension will be zero for planar target
             // set it here to the larger dimension so that
             // a 3D augmentation can be shown
@@ -414,50 +369,44 @@ bool AppController::getImageTargetResult(Vuforia::Matrix44F& projectionMatrix,
 }
 
 
-bool AppController::getModelTargetResult(Vuforia::Matrix44F& projectionMatrix,
-                                         Vuforia::Matrix44F& modelViewMatrix,
-                                         Vuforia::Matrix44F& scaledModelViewMatrix)
+bool AppController::computeModelTargetResult(Vuforia::Matrix44F& projectionMatrix,
+                                             Vuforia::Matrix44F& modelViewMatrix,
+                                             Vuforia::Matrix44F& scaledModelViewMatrix)
 {
-    const auto& trackableResultList = mVuforiaState.getTrackableResults();
-    for (const auto* result : trackableResultList)
+    for (size_t i = 0; i < mTrackingFrame.results.size(); i++)
     {
+        const TrackingResult& result = mTrackingFrame.results[i];
 
-        if (result->isOfType(Vuforia::ModelTargetResult::getClassType()) && mTarget == MODEL_TARGET_ID)
+        if (result.type == TrackingResultType::MODEL_TARGET && mTarget == MODEL_TARGET_ID)
         {
-            const Vuforia::ModelTargetResult* mtResult = static_cast<const Vuforia::ModelTargetResult*>(result);
-            const Vuforia::ModelTarget& target = mtResult->getTrackable();
-            
-            if(mtResult->getStatus() == Vuforia::TrackableResult::NO_POSE)
+            if(result.status == TrackingResult::NO_POSE)
             {
-                if(mtResult->getStatusInfo() == Vuforia::TrackableResult::NO_DETECTION_RECOMMENDING_GUIDANCE)
+                if(result.statusInfo == TrackingResult::NO_DETECTION_RECOMMENDING_GUIDANCE)
                 {
-                    mGuideViewModelTarget = &target;
+                    mGuideView.active = true;
+                    mGuideView.width = result.guideViewWidth;
+                    mGuideView.height = result.guideViewHeight;
+                    mGuideView.image = mGuideViewImages[i];
                 }
                 continue;
             }
             else
             {
-                mGuideViewModelTarget = nullptr;
-
-                Vuforia::Matrix44F viewMatrix = Vuforia::Tool::convertPose2GLMatrix(mVuforiaState.getDeviceTrackableResult()->getPose());
-                viewMatrix = MathUtils::Matrix44FTranspose(MathUtils::Matrix44FInverse(viewMatrix));
+                mGuideView.active = false;
 
-                // Get the projection matrix
-                projectionMatrix = Vuforia::Tool::convertPerspectiveProjection2GLMatrix(
-                    mCurrentRenderingPrimitives->getProjectionMatrix(Vuforia::VIEW_SINGULAR,
-                                                                     mVuforiaState.getCameraCalibration()),
-                    NEAR_PLANE, FAR_PLANE);
+                // View and projection matrices are shared by all getters for this frame
+                const auto& frameCache = getFrameCache();
+                projectionMatrix = frameCache.projectionMatrix;
 
                 // Get object pose and populate modelViewMatrix
-                modelViewMatrix = Vuforia::Tool::convertPose2GLMatrix(result->getPose());
-                MathUtils::multiplyMatrix(viewMatrix, modelViewMatrix, modelViewMatrix);
+                modelViewMatrix = getPredictedPose(result, mTargetPosePredictor);
+                MathUtils::multiplyMatrix(frameCache.viewMatrix, modelViewMatrix, modelViewMatrix);
 
                 // Calculate a scaled modelViewMatrix for rendering a unit bounding box
-                Vuforia::Obb3D boundingBox = target.getBoundingBox();
-                Vuforia::Vec3F translateCenter = Vuforia::Vec3F(boundingBox.getCenter().data[0], boundingBox.getCenter().data[1], boundingBox.getCenter().data[2]);
+                Vuforia::Vec3F translateCenter = result.obbCenter;
                 
                 Vuforia::Matrix44F scaleMatrix;
-                Vuforia::Vec3F targetScale = target.getSize();
+                Vuforia::Vec3F targetScale = result.size;
                 MathUtils::makeScalingMatrix(targetScale, scaleMatrix);
 
                 Vuforia::Matrix44F translateMatrix;
@@ -475,41 +424,36 @@ bool AppController::getModelTargetResult(Vuforia::Matrix44F& projectionMatrix,
 }
 
 
-bool AppController::getModelTargetGuideView(Vuforia::Matrix44F& projectionMatrix,
-                                            Vuforia::Matrix44F& modelViewMatrix,
-                                            Vuforia::Image **guideViewImage)
+bool AppController::computeModelTargetGuideView(Vuforia::Matrix44F& projectionMatrix,
+                                                Vuforia::Matrix44F& modelViewMatrix,
+                                                Vuforia::Image **guideViewImage)
 {
-    if (mGuideViewModelTarget == nullptr)
+    if (!mGuideView.active)
     {
         return false;
     }
     
-    auto guideViewList = mGuideViewModelTarget->getGuideViews();
-    if(guideViewList.size() !=0)
+    if(mGuideView.width != 0 && mGuideView.height != 0)
     {
-        auto guideViewTarget = guideViewList.at(0);
-        
-        auto guideImage = guideViewTarget->getImage();
-        
-        const Vuforia::CameraCalibration* cameraCalibration = mVuforiaState.getCameraCalibration();
-        if(cameraCalibration != nullptr)
+        if(mTrackingFrame.hasCameraCalibration)
         {
             modelViewMatrix = MathUtils::Matrix44FIdentity();
             projectionMatrix = MathUtils::Matrix44FIdentity();
 
             Vuforia::Vec2F scale;
 
-            float guideViewAspectRatio = (float)guideImage->getWidth() / guideImage->getHeight();
+            float guideViewAspectRatio = (float)mGuideView.width / mGuideView.height;
+            float displayAspectRatio = mTrackingFrame.displayAspectRatio;
 
             float planeDistance = 0.01f;
-            float fieldOfView = mVuforiaState.getCameraCalibration()->getFieldOfViewRads().data[1];
-            float nearPlaneHeight = 1.0f * planeDistance * std::tanf(fieldOfView * 0.5f);
-            float nearPlaneWidth = nearPlaneHeight * mDisplayAspectRatio;
+            float fieldOfView = mTrackingFrame.cameraFieldOfViewRads.data[1];
+            float nearPlaneHeight = 1.0f * planeDistance * std::tan(fieldOfView * 0.5f);
+            float nearPlaneWidth = nearPlaneHeight * displayAspectRatio;
             float planeWidth;
             float planeHeight;
 
 
-            if(guideViewAspectRatio >= 1.0f && mDisplayAspectRatio >= 1.0f) // guideview landscape, camera landscape
+            if(guideViewAspectRatio >= 1.0f && displayAspectRatio >= 1.0f) // guideview landscape, camera landscape
             {
                 // scale so that the long side of the camera (width)
                 // is the same length as guideview width
@@ -517,14 +461,14 @@ bool AppController::getModelTargetGuideView(Vuforia::Matrix44F& projectionMatrix
                 planeHeight = planeWidth / guideViewAspectRatio;
             }
 
-            else if(guideViewAspectRatio < 1.0f && mDisplayAspectRatio < 1.0f) // guideview portrait, camera portrait
+            else if(guideViewAspectRatio < 1.0f && displayAspectRatio < 1.0f) // guideview portrait, camera portrait
             {
                 // scale so that the long side of the camera (height)
                 // is the same length as guideview height
                 planeHeight = nearPlaneHeight;
                 planeWidth = planeHeight * guideViewAspectRatio;
             }
-            else if (mDisplayAspectRatio < 1.0f) // guideview landscape, camera portrait
+            else if (displayAspectRatio < 1.0f) // guideview landscape, camera portrait
             {
                 // scale so that the long side of the camera (height)
                 // is the same length as guideview width
@@ -544,7 +488,8 @@ bool AppController::getModelTargetGuideView(Vuforia::Matrix44F& projectionMatrix
 
             modelViewMatrix = MathUtils::Matrix44FScale(Vuforia::Vec3F(scale.data[0], scale.data[1], 1.0f), modelViewMatrix);
 
-            *guideViewImage = const_cast<Vuforia::Image*>(guideImage);
+            // nullptr for replayed frames
+            *guideViewImage = const_cast<Vuforia::Image*>(mGuideView.image);
             return true;
         }
 
@@ -555,433 +500,176 @@ bool AppController::getModelTargetGuideView(Vuforia::Matrix44F& projectionMatrix
 }
 
 
-/*===============================================================================
-AppController private methods
-===============================================================================*/
-
-bool AppController::initVuforiaInternal(void* appData)
+void AppController::setPosePredictionModel(PosePredictor::Model model)
 {
-#if defined (__ANDROID__)  // ANDROID
-    Vuforia::setInitParameters(jobject(appData), mVuforiaInitFlags, licenseKey);
-
-#elif defined(WINAPI_FAMILY) // UWP
-    (void)appData;
-    Vuforia::setInitParameters(licenseKey);
+    std::lock_guard<std::mutex> lock(mPublishMutex);
 
-#elif defined(__APPLE__)// iOS
-    Vuforia::setInitParameters(mVuforiaInitFlags, licenseKey);
+    mDevicePosePredictor.setModel(model);
+    mTargetPosePredictor.setModel(model);
+    mFrameCache.valid = false;
+}
 
-#else
-#error "Unsupported platform"
-#endif
 
-    // Vuforia::init() will return positive numbers up to 100 as it progresses
-    // towards success.  Negative numbers indicate error conditions
-    int progress = 0;
-    while (progress >= 0 && progress < 100)
-    {
-        progress = Vuforia::init();
-    }
-    
-    if (progress == 100)
-    {
-        return true;
-    }
-    
-    // Failed to initialise Vuforia Engine:
-    std::string cameraAccessErrorMessage = "";
+void AppController::setPredictionLatency(double seconds)
+{
+    std::lock_guard<std::mutex> lock(mPublishMutex);
 
-    switch(progress)
-    {
-        case Vuforia::INIT_NO_CAMERA_ACCESS:
-            // On most platforms the user must explicitly grant camera access
-            // If the access request is denied this code is returned
-            cameraAccessErrorMessage = "Vuforia cannot initialize because access to the camera was denied.";
-            break;
-                
-        case Vuforia::INIT_LICENSE_ERROR_NO_NETWORK_TRANSIENT:
-            cameraAccessErrorMessage = "Vuforia failed to initialize because the license check encountered a temporary network error.";
-            break;
-                
-        case Vuforia::INIT_LICENSE_ERROR_NO_NETWORK_PERMANENT:
-            cameraAccessErrorMessage = "Vuforia failed to initialize because the license check encountered a permanent network error.";
-            break;
-                
-        case Vuforia::INIT_LICENSE_ERROR_INVALID_KEY:
-            cameraAccessErrorMessage = "Vuforia failed to initialize because the license key is invalid.";
-            break;
-                
-        case Vuforia::INIT_LICENSE_ERROR_CANCELED_KEY:
-            cameraAccessErrorMessage = "Vuforia failed to initialize because the license key was cancelled.";
-            break;
-                
-        case Vuforia::INIT_LICENSE_ERROR_MISSING_KEY:
-            cameraAccessErrorMessage = "Vuforia failed to initialize because the license key was missing.";
-            break;
-                
-        case Vuforia::INIT_LICENSE_ERROR_PRODUCT_TYPE_MISMATCH:
-            cameraAccessErrorMessage = "Vuforia failed to initialize because the license key is for the wrong product type.";
-            break;
-                
-        case Vuforia::INIT_DEVICE_NOT_SUPPORTED:
-            cameraAccessErrorMessage = "Vuforia failed to initialize because the device is not supported.";
-            break;
-                
-        default:
-            cameraAccessErrorMessage = "Vuforia initialization failed.";
-            break;
-    }
-    // Vuforia Engine initialization error
-    mShowErrorCallback(cameraAccessErrorMessage.c_str());
+    mPredictionLatency = seconds;
 
-    return false;
+    // Allow a little headroom over the budget for the time between the camera frame and publishing
+    double maxPredictionTime = seconds + PREDICTION_HEADROOM;
+    mDevicePosePredictor.setMaxPredictionTime(maxPredictionTime);
+    mTargetPosePredictor.setMaxPredictionTime(maxPredictionTime);
 }
 
 
-void AppController::setVuforiaOrientation(int orientation) const
+void AppController::setPredictionTargetTime(double targetTime)
 {
-#if defined(ANDROID) || defined (__ANDROID__)  // ANDROID
-    
-#elif defined(WINAPI_FAMILY) // UWP
-    switch (orientation)
-    {
-    case 0: // Portrait
-        Vuforia::setCurrentOrientation(Vuforia::DISPLAY_ORIENTATION::PORTRAIT);
-        break;
-    case 1: // "PortraitUpsideDown"
-        Vuforia::setCurrentOrientation(Vuforia::DISPLAY_ORIENTATION::PORTRAIT_FLIPPED);
-        break;
-    case 2: // "LandscapeLeft"
-        Vuforia::setCurrentOrientation(Vuforia::DISPLAY_ORIENTATION::LANDSCAPE);
-        break;
-    case 3: // "LandscapeRight"
-        Vuforia::setCurrentOrientation(Vuforia::DISPLAY_ORIENTATION::LANDSCAPE_FLIPPED);
-        break;
-    }
+    std::lock_guard<std::mutex> lock(mPublishMutex);
 
-#else // iOS
-    switch (orientation)
-    {
-        case 0: // Portrait
-            Vuforia::setRotation(Vuforia::ROTATE_IOS_90);
-            break;
-        case 1: // "PortraitUpsideDown"
-            Vuforia::setRotation(Vuforia::ROTATE_IOS_270);
-            break;
-        case 2: // "LandscapeLeft"
-            Vuforia::setRotation(Vuforia::ROTATE_IOS_180);
-            break;
-        case 3: // "LandscapeRight"
-            Vuforia::setRotation(Vuforia::ROTATE_IOS_0);
-            break;
-    }
-#endif    
+    mRequestedPredictionTargetTime = targetTime;
+    mHasRequestedPredictionTargetTime = true;
 }
 
 
-bool AppController::initTrackers()
-{
-    // Initialize the object tracker
-    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
-    
-    Vuforia::Tracker* tracker = trackerManager.initTracker(Vuforia::PositionalDeviceTracker::getClassType());
-    if (tracker == nullptr)
-    {
-        LOG("Error: Failed to initialise the Device tracker (it may have been initialised already)");
-        mShowErrorCallback("Error initializing the device tracker");
-        return false;
-    }
-    
-    Vuforia::Tracker* trackerBase = trackerManager.initTracker(Vuforia::ObjectTracker::getClassType());
-    if (trackerBase == NULL)
-    {
-        LOG("Error: Failed to initialize ObjectTracker.");
-        mShowErrorCallback("Error initializing the object tracker");
-        return false;
-    }
 
-    return true;
+double AppController::getCurrentTimeStamp() const
+{
+    return mBackend->getCurrentTimeStamp();
 }
 
 
-bool AppController::loadTrackerData()
+/*===============================================================================
+AppController private methods
+===============================================================================*/
+
+const AppController::FrameCache& AppController::getFrameCache()
 {
-    if (mCurrentDataSet != nullptr)
+    if (mFrameCache.valid)
     {
-        mShowErrorCallback("Attempt to load a dataset when one is already loaded");
-        return false;
+        ++mFrameCacheHits;
+        return mFrameCache;
     }
+    ++mFrameCacheMisses;
 
-    if (mTarget == IMAGE_TARGET_ID)
+    if (mTrackingFrame.hasDeviceResult)
     {
-        mCurrentDataSet = loadAndActivateDataSet("StonesAndChips.xml");
-        if (mCurrentDataSet == nullptr)
-        {
-            mShowErrorCallback("Error loading dataset for Image Target");
-            return false;
-        }
+        // The device pose is a rigid transform, the view matrix is its inverse
+        Vuforia::Matrix44F devicePose = getPredictedPose(mTrackingFrame.deviceResult, mDevicePosePredictor);
+        mFrameCache.viewMatrix = MathUtils::Matrix44FInverseRigid(devicePose);
     }
     else
     {
-        mCurrentDataSet = loadAndActivateDataSet("VuforiaMars_ModelTarget.xml");
-        if (mCurrentDataSet == nullptr)
-        {
-            mShowErrorCallback("Error loading dataset for Model Target");
-            return false;
-        }
+        mFrameCache.viewMatrix = MathUtils::Matrix44FIdentity();
     }
 
-    return true;
-}
+    mFrameCache.projectionMatrix = mTrackingFrame.projectionMatrix;
 
+    mFrameCache.valid = true;
+    return mFrameCache;
+}
 
-bool AppController::unloadTrackerData()
+void AppController::publishCurrentFrame(std::shared_ptr<const TrackingBackend::RenderState> renderState,
+                                        double publishTime)
 {
-    // Get the image tracker:
-    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
-    Vuforia::ObjectTracker* objectTracker = static_cast<Vuforia::ObjectTracker*>(trackerManager.getTracker(Vuforia::ObjectTracker::getClassType()));
-    if (objectTracker == nullptr)
-    {
-        return false;
-    }
-    
-    if (!objectTracker->deactivateDataSet(mCurrentDataSet))
+    mFrameCache.valid = false;
+
+    if (mHasRequestedPredictionTargetTime)
     {
-        LOG("Warning: Failed to deactivate the data set.");
+        mPredictionTargetTime = mRequestedPredictionTargetTime;
+        mHasRequestedPredictionTargetTime = false;
     }
-    
-    if (!objectTracker->destroyDataSet(mCurrentDataSet))
+    else
     {
-        LOG("Warning: Failed to destory the data set.");
+        mPredictionTargetTime = publishTime + mPredictionLatency;
     }
-    
-    mCurrentDataSet = nullptr;
+    updatePosePredictors();
 
-    return true;
+    auto& snapshot = mFrameSnapshots.getWriteBuffer();
+    snapshot.sequence = ++mFrameSnapshotSequence;
+    snapshot.renderState = std::move(renderState);
+    snapshot.originValid = computeOrigin(snapshot.originProjection, snapshot.originModelView);
+    snapshot.targetValid =
+        computeImageTargetResult(snapshot.targetProjection, snapshot.targetModelView, snapshot.targetModelViewScaled) ||
+        computeModelTargetResult(snapshot.targetProjection, snapshot.targetModelView, snapshot.targetModelViewScaled);
+    snapshot.guideViewImage = nullptr;
+    snapshot.guideViewValid = !snapshot.targetValid &&
+        computeModelTargetGuideView(snapshot.guideViewProjection, snapshot.guideViewModelView, &snapshot.guideViewImage);
+
+    mFrameSnapshots.publish();
 }
 
 
-bool AppController::startTrackers()
+void AppController::updatePosePredictors()
 {
-    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
-    Vuforia::Tracker* deviceTracker = trackerManager.getTracker(Vuforia::PositionalDeviceTracker::getClassType());
-    if(deviceTracker != 0)
+    // Sampled with every model, with Model::NONE the error statistics are the baseline
+    // of rendering the tracked poses. getPredictedPose skips the extrapolation.
+    const TrackingResult& deviceResult = mTrackingFrame.deviceResult;
+    if (mTrackingFrame.hasDeviceResult && deviceResult.status != TrackingResult::NO_POSE)
     {
-        deviceTracker->start();
+        mDevicePosePredictor.addSample(deviceResult.timestamp, SampleMath::Pose::fromMatrix34(deviceResult.pose));
     }
-    Vuforia::Tracker* tracker = trackerManager.getTracker(Vuforia::ObjectTracker::getClassType());
-    if(tracker == 0)
+
+    const auto targetType = (mTarget == IMAGE_TARGET_ID) ? TrackingResultType::IMAGE_TARGET
+                                                         : TrackingResultType::MODEL_TARGET;
+    for (size_t i = 0; i < mTrackingFrame.results.size(); i++)
     {
-        return false;
+        const TrackingResult& result = mTrackingFrame.results[i];
+        if (result.type == targetType && result.status != TrackingResult::NO_POSE)
+        {
+            mTargetPosePredictor.addSample(result.timestamp, SampleMath::Pose::fromMatrix34(result.pose));
+            break;
+        }
     }
-    tracker->start();
-    return true;
 }
 
 
-void AppController::stopTrackers()
+Vuforia::Matrix44F AppController::getPredictedPose(const TrackingResult& result,
+                                                   const PosePredictor& predictor) const
 {
-    // Stop the tracker
-    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
-    
-    // Stop the object tracker
-    Vuforia::Tracker* objectTracker = trackerManager.getTracker(Vuforia::ObjectTracker::getClassType());
-    
-    if (objectTracker != nullptr)
-    {
-        objectTracker->stop();
-        LOG("Successfully stopped the ObjectTracker");
-    }
-    else
-    {
-        LOG("Error: Failed to get the ObjectTracker from the tracker manager");
-    }
-    
-    Vuforia::Tracker* deviceTracker = trackerManager.getTracker(Vuforia::PositionalDeviceTracker::getClassType());
-    
-    if (deviceTracker != nullptr)
-    {
-        deviceTracker->stop();
-        LOG("Successfully stopped the PositionalDeviceTracker");
-    }
-    else
+    SampleMath::Pose pose;
+    if (predictor.getModel() != PosePredictor::Model::NONE && predictor.hasSamples() &&
+        predictor.getLatestTimestamp() == result.timestamp &&
+        predictor.predict(mPredictionTargetTime, pose))
     {
-        LOG("Error: Failed to get the PositionalDeviceTracker from the tracker manager");
+        return pose.toMatrix44();
     }
-}
-
 
-void AppController::deinitTrackers()
-{
-    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
-    trackerManager.deinitTracker(Vuforia::ObjectTracker::getClassType());
-    trackerManager.deinitTracker(Vuforia::PositionalDeviceTracker::getClassType());
+    return MathUtils::convertPose2GLMatrix(result.pose);
 }
 
 
-void AppController::configureVideoBackground(float viewWidth, float viewHeight)
+void AppController::runTrackingThread(double interval)
 {
-    // Get the default video mode
-    Vuforia::CameraDevice& cameraDevice = Vuforia::CameraDevice::getInstance();
-    Vuforia::VideoMode videoMode = cameraDevice.getCurrentVideoMode();
-    
-    // Configure the video background
-    Vuforia::VideoBackgroundConfig config;
-    config.mPosition.data[0] = 0;
-    config.mPosition.data[1] = 0;
-    
-    // Determine the orientation of the view.  Note, this simple test assumes
-    // that a view is portrait if its height is greater than its width.  This is
-    // not always true: it is perfectly reasonable for a view with portrait
-    // orientation to be wider than it is high.  The test is suitable for the
-    // dimensions used in this sample
-    if (isScreenPortrait())
-    {
-        // --- View is portrait ---
-        
-        // Compare aspect ratios of video and screen.  If they are different we
-        // use the full screen size while maintaining the video's aspect ratio,
-        // which naturally entails some cropping of the video
-        float aspectRatioVideo = (float)videoMode.mWidth / (float)videoMode.mHeight;
-        float aspectRatioView = viewHeight / viewWidth;
-        
-        if (aspectRatioVideo < aspectRatioView)
-        {
-            // Video (when rotated) is wider than the view: crop left and right
-            // (top and bottom of video)
-            
-            // --============--
-            // - =          = _
-            // - =          = _
-            // - =          = _
-            // - =          = _
-            // - =          = _
-            // - =          = _
-            // - =          = _
-            // - =          = _
-            // --============--
-            
-            config.mSize.data[0] = int(videoMode.mHeight * (viewHeight / float(videoMode.mWidth)));
-            config.mSize.data[1] = int(viewHeight);
-        }
-        else
-        {
-            // Video (when rotated) is narrower than the view: crop top and
-            // bottom (left and right of video).  Also used when aspect ratios
-            // match (no cropping)
-            
-            // ------------
-            // -          -
-            // -          -
-            // ============
-            // =          =
-            // =          =
-            // =          =
-            // =          =
-            // =          =
-            // =          =
-            // =          =
-            // =          =
-            // ============
-            // -          -
-            // -          -
-            // ------------
-            
-            config.mSize.data[0] = int(viewWidth);
-            config.mSize.data[1] = int(videoMode.mWidth * (viewWidth / float(videoMode.mHeight)));
-        }
-        
-    }
-    else
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(interval));
+    auto nextUpdate = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mTrackingThreadMutex);
+    while (!mStopTrackingThread)
     {
-        // --- View is landscape ---
-        
-        // Compare aspect ratios of video and screen.  If they are different we
-        // use the full screen size while maintaining the video's aspect ratio,
-        // which naturally entails some cropping of the video
-        float aspectRatioVideo = (float)videoMode.mWidth / (float)videoMode.mHeight;
-        float aspectRatioView = viewWidth / viewHeight;
-        
-        if (aspectRatioVideo < aspectRatioView)
-        {
-            // Video is taller than the view: crop top and bottom
-            
-            // --------------------
-            // ====================
-            // =                  =
-            // =                  =
-            // =                  =
-            // =                  =
-            // ====================
-            // --------------------
-            
-            config.mSize.data[0] = int(viewWidth);
-            config.mSize.data[1] = int(videoMode.mHeight * (viewWidth / float(videoMode.mWidth)));
-        }
-        else
-        {
-            // Video is wider than the view: crop left and right.  Also used
-            // when aspect ratios match (no cropping)
-            
-            // ---====================---
-            // -  =                  =  -
-            // -  =                  =  -
-            // -  =                  =  -
-            // -  =                  =  -
-            // ---====================---
-            
-            config.mSize.data[0] = int(videoMode.mWidth * (viewHeight / float(videoMode.mHeight)));
-            config.mSize.data[1] = int(viewHeight);
-        }
-        
+        lock.unlock();
+        publishFrameSnapshot();
+        lock.lock();
+
+        // Skip the updates a slow one overran instead of catching up on them back to back
+        nextUpdate = std::max(nextUpdate + period, std::chrono::steady_clock::now());
+        mTrackingThreadWake.wait_until(lock, nextUpdate, [this] { return mStopTrackingThread; });
     }
-    
-    // Set the config
-    Vuforia::Renderer::getInstance().setVideoBackgroundConfig(config);
-    updateRenderingPrimitives();
 }
 
 
-Vuforia::DataSet* AppController::loadAndActivateDataSet(std::string path)
+void AppController::joinTrackingThread()
 {
-    LOG("Loading data set from %s", path.c_str());
-    Vuforia::DataSet* dataSet = nullptr;
-    
-    // Get the Vuforia tracker manager image tracker
-    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
-    Vuforia::ObjectTracker* objectTracker = static_cast<Vuforia::ObjectTracker*>(trackerManager.getTracker(Vuforia::ObjectTracker::getClassType()));
-    
-    if (objectTracker == nullptr)
+    if (!mTrackingThread.joinable())
     {
-        LOG("Error: Failed to get the ObjectTracker from the TrackerManager");
+        return;
     }
-    else
+
     {
-        dataSet = objectTracker->createDataSet();
-        if (dataSet == nullptr)
-        {
-            LOG("Error: Failed to create data set");
-        }
-        else
-        {
-            // Load the data set from the app's resources
-            if (!dataSet->load(path.c_str(), Vuforia::STORAGE_APPRESOURCE))
-            {
-                LOG("Error: Failed to load data set");
-                objectTracker->destroyDataSet(dataSet);
-                dataSet = nullptr;
-            }
-            else
-            {
-                if (!objectTracker->activateDataSet(dataSet))
-                {
-                    LOG("Error: Failed to activate data set");
-                    objectTracker->destroyDataSet(dataSet);
-                    dataSet = nullptr;
-                }
-            }
-        }
+        std::lock_guard<std::mutex> lock(mTrackingThreadMutex);
+        mStopTrackingThread = true;
     }
-    
-    return dataSet;
+    mTrackingThreadWake.notify_one();
+    mTrackingThread.join();
 }
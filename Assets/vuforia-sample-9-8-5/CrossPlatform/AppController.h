@@ -11,25 +11,36 @@ countries.
 #ifdef _MSC_VER
 #pragma warning(disable:4251)
 #endif
-#include <Vuforia/CameraDevice.h>
-#include <Vuforia/DataSet.h>
-#include <Vuforia/Image.h>
 #include <Vuforia/Matrices.h>
-#include <Vuforia/ModelTarget.h>
-#include <Vuforia/Renderer.h>
-#include <Vuforia/RenderingPrimitives.h>
 #ifdef _MSC_VER
 #pragma warning(default:4251)
 #endif
 
+#include "PosePredictor.h"
+#include "TrackingBackend.h"
+#include "TrackingFrame.h"
+#include "TrackingLog.h"
+#include "TripleBuffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdio>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 
 /// The AppController provides a platform independent encapsulation of the  Vuforia lifecycle
-/// and dataset loading.
+/// and dataset loading. The engine specific work is done by a TrackingBackend.
+/**
+ * Tracking results reach the renderer as FrameSnapshots. They are published either by a
+ * tracking thread of the AppController (startTrackingThread) or by calls to
+ * publishFrameSnapshot, and the render thread takes the latest one without locking.
+ */
 class AppController
 {
     
@@ -52,6 +63,37 @@ public:
         InitDoneCallback initDoneCallback {};
     };
 
+    /// Tracking results of one frame, published by publishFrameSnapshot for the render thread
+    struct FrameSnapshot
+    {
+        /// Incremented for every published snapshot, 0 until the first one
+        std::uint64_t sequence = 0;
+        /// Backend state the results were computed from, passed back to the backend for rendering.
+        /// nullptr for snapshots from publishTrackingFrame.
+        std::shared_ptr<const TrackingBackend::RenderState> renderState;
+        /// World origin, valid when the device pose is tracked normally
+        bool originValid = false;
+        Vuforia::Matrix44F originProjection;
+        Vuforia::Matrix44F originModelView;
+        /// Image Target or Model Target, valid when the selected target is tracked
+        bool targetValid = false;
+        Vuforia::Matrix44F targetProjection;
+        Vuforia::Matrix44F targetModelView;
+        Vuforia::Matrix44F targetModelViewScaled;
+        /// Model Target Guide View, valid when guidance should be shown
+        bool guideViewValid = false;
+        Vuforia::Matrix44F guideViewProjection;
+        Vuforia::Matrix44F guideViewModelView;
+        /// nullptr for replayed snapshots, recorded frames do not contain the image
+        Vuforia::Image* guideViewImage = nullptr;
+    };
+
+
+    /// backend does the tracking and video background rendering, usually a VuforiaBackend
+    explicit AppController(std::unique_ptr<TrackingBackend> backend);
+
+    /// Stops the tracking thread
+    ~AppController();
 
     /// Initialize Vuforia. When the initialization is completed successfully the callback method initDone callback will be invoked.
     /// If initialization fails the error callback will be invoked.
@@ -62,12 +104,14 @@ public:
     bool startAR();
     
     /// Call this method when the app is paused.
+    /// Waits for the tracking thread to finish its update before the backend is paused.
     void pauseAR();
     
     /// Call this method when the app resumes from paused.
+    /// Restarts the tracking thread if it was running when the app was paused.
     void resumeAR();
 
-    /// Stop the AR session
+    /// Stop the AR session, stops the tracking thread first
     void stopAR();
 
     /// Clean up and deinitialize Vuforia.
@@ -89,10 +133,43 @@ public:
     bool configureRendering(int width, int height, int orientation);
 
     /// Query whether the camera is currently started
-    bool isCameraStarted() { return mCameraIsStarted; }
+    bool isCameraStarted() { return mBackend->isStarted(); }
+
+    /// Call publishFrameSnapshot every interval seconds on a thread of its own, so updating
+    /// the tracking state does not hold up rendering. Call after startAR. pauseAR and stopAR
+    /// wait for the update in flight, so the backend is never paused under it.
+    void startTrackingThread(double interval);
+
+    /// Stop the tracking thread and wait for the update in flight
+    void stopTrackingThread();
+
+    /// Update the Vuforia state and publish the tracking results as a FrameSnapshot.
+    /// The tracking thread calls this; without one, call it once per frame before
+    /// prepareToRender, and never while Vuforia is being paused.
+    void publishFrameSnapshot();
+
+    /// Publish a recorded frame instead of updating from Vuforia, see TrackingReplay.
+    /// Runs the same prediction and getter computations as publishFrameSnapshot.
+    void publishTrackingFrame(const TrackingFrame& frame);
+
+    /// Take the latest published snapshot for the getters. prepareToRender calls this,
+    /// call it directly only when snapshots are consumed without rendering.
+    /// Returns false if no snapshot has been published yet.
+    bool acquireFrameSnapshot();
+
+    /// Prepare to feed recorded frames for target through publishTrackingFrame.
+    /// Vuforia does not need to be initialized.
+    void initReplay(int target);
+
+    /// Write every frame published by publishFrameSnapshot to a TrackingLog file at path.
+    /// Can be called from any thread, recording starts with the next published frame.
+    bool startRecording(const std::string& path);
+    void stopRecording();
+    bool isRecording() const;
 
-    /// Call this method at the start of Vuforia rendering.
-    /// Gets the latest video background texture from Vuforia.
+    /// Call this method at the start of Vuforia rendering, on the render thread.
+    /// Takes the latest FrameSnapshot and gets its video background texture from Vuforia.
+    /// Returns false if no snapshot has been published yet or the backend has nothing to render for it.
     bool prepareToRender(double* viewport, Vuforia::RenderData* renderData,
                          Vuforia::TextureUnit* videoBackgroundTextureUnit, Vuforia::TextureData* videoBackgroundTextureData = nullptr);
 
@@ -102,7 +179,10 @@ public:
     
     /// Get the current RenderingPrimitives
     /// Will return nullptr until configureRendering has been called
-    const Vuforia::RenderingPrimitives* getRenderingPrimitives() { return mCurrentRenderingPrimitives.get(); }
+    const Vuforia::RenderingPrimitives* getRenderingPrimitives() { return mBackend->getRenderingPrimitives(); }
+
+    /// The FrameSnapshot taken by the last prepareToRender, the getters below read from it
+    const FrameSnapshot& getFrameSnapshot() const { return mFrameSnapshots.getReadBuffer(); }
 
     /// Get rendering information for the world origin position.
     /// Returns false if the world origin position is not currently available.
@@ -122,81 +202,147 @@ public:
     /// Returns false if Guide View rendering isn't required for the current frame.
     bool getModelTargetGuideView(Vuforia::Matrix44F& projectionMatrix,
                                  Vuforia::Matrix44F& modelViewMatrix, Vuforia::Image** guideViewImage);
+
+    /// Number of getter calls that reused the per-frame view/projection cache
+    std::uint64_t getFrameCacheHits() const { return mFrameCacheHits; }
+
+    /// Number of getter calls that had to fill the per-frame view/projection cache
+    /// Expected to be at most one per frame.
+    std::uint64_t getFrameCacheMisses() const { return mFrameCacheMisses; }
+
+    /// The prediction settings below apply from the next published snapshot and can be
+    /// changed from any thread.
+
+    /// Select how device and target poses are extrapolated to the display time.
+    /// The default, PosePredictor::Model::NONE, renders the poses as tracked.
+    void setPosePredictionModel(PosePredictor::Model model);
+
+    /// Latency budget in seconds: unless setPredictionTargetTime is called, poses are predicted
+    /// this far past the current Vuforia time when publishFrameSnapshot runs, or past the capture
+    /// time of frames given to publishTrackingFrame. Also limits how far poses are extrapolated.
+    void setPredictionLatency(double seconds);
+
+    /// Predict the poses of the next published snapshot to targetTime instead of using the latency
+    /// budget. The time is in the Vuforia clock (see getCurrentTimeStamp). Only applies to the next
+    /// publishFrameSnapshot, later snapshots go back to using the latency budget.
+    void setPredictionTargetTime(double targetTime);
+
+    /// Current time in the clock used by Vuforia timestamps, in seconds
+    double getCurrentTimeStamp() const;
+
+    /// Predictors for the device pose and the pose of the selected target, for error statistics.
+    /// Publishing updates them, read them while the tracking thread is stopped.
+    const PosePredictor& getDevicePosePredictor() const { return mDevicePosePredictor; }
+    const PosePredictor& getTargetPosePredictor() const { return mTargetPosePredictor; }
     
+private: // types
+
+    /// Values derived from the tracking frame that are shared by all the getters in a frame
+    struct FrameCache
+    {
+        /// False until the cache has been filled for the current mTrackingFrame
+        bool valid = false;
+        /// Inverse of the device pose, identity if there is no device pose
+        Vuforia::Matrix44F viewMatrix;
+        /// GL projection matrix for the current frame
+        Vuforia::Matrix44F projectionMatrix;
+    };
+
+    /// Model Target Guide View to show while the target is not tracked
+    struct GuideViewState
+    {
+        bool active = false;
+        std::int32_t width = 0;
+        std::int32_t height = 0;
+        /// nullptr for replayed frames
+        const Vuforia::Image* image = nullptr;
+    };
+
 private: // methods
-    
-    /// Used by initAR to prepare and invoke Vuforia initialization.
-    bool initVuforiaInternal(void* appData);
-    
-    /// Convert orientation parameter to platform specific value and pass to Vuforia.
-    void setVuforiaOrientation(int orientation) const;
-    
-    /// Create the set of Vuforia Trackers needed in the application
-    bool initTrackers();
-    
-    /// Clean up Trackers created by initTrackers
-    void deinitTrackers();
-    
-    /// Load and activate the dataset for the currently selected target.
-    bool loadTrackerData();
 
-    /// Deactivate and unload the currently selected target.
-    bool unloadTrackerData();
-    
-    /// Start Vuforia trackers
-    bool startTrackers();
-    
-    /// Stop Vuforia trackers
-    void stopTrackers();
-    
-    /// Convenience method, returns trye if the screen is in portrait orientation.
-    bool isScreenPortrait() const { return mOrientation == 0 || mOrientation == 1; }
-    
-    /// Calculate the video background configuration to pass to Vuforia.
-    void configureVideoBackground(float viewWidth, float viewHeight);
-    
-    /// Utility method to load and activate datasets
-    /// Can be used before trackers are started.
-    /// During an active Vuforia session dataset activation is only allowed in the Vuforia_onUpdate() callback.
-    Vuforia::DataSet* loadAndActivateDataSet(std::string path);
-    
+    /// Return the per-frame cache, filling it if this is the first use since publishFrameSnapshot
+    const FrameCache& getFrameCache();
+
+    /// Run prediction and the getter computations on mTrackingFrame and publish the snapshot.
+    /// Poses are predicted to publishTime plus the latency budget, publishTime in the Vuforia clock.
+    void publishCurrentFrame(std::shared_ptr<const TrackingBackend::RenderState> renderState, double publishTime);
+
+    /// Compute the snapshot entries from mTrackingFrame, see the matching public getters
+    bool computeOrigin(Vuforia::Matrix44F& projectionMatrix, Vuforia::Matrix44F& modelViewMatrix);
+    bool computeImageTargetResult(Vuforia::Matrix44F& projectionMatrix,
+                                  Vuforia::Matrix44F& modelViewMatrix, Vuforia::Matrix44F& scaledModelViewMatrix);
+    bool computeModelTargetResult(Vuforia::Matrix44F& projectionMatrix,
+                                  Vuforia::Matrix44F& modelViewMatrix, Vuforia::Matrix44F& scaledModelViewMatrix);
+    bool computeModelTargetGuideView(Vuforia::Matrix44F& projectionMatrix,
+                                     Vuforia::Matrix44F& modelViewMatrix, Vuforia::Image** guideViewImage);
+
+    /// Add the poses of the new tracking frame to the pose predictors
+    void updatePosePredictors();
+
+    /// Body of the tracking thread
+    void runTrackingThread(double interval);
+
+    /// Wait for the tracking thread to exit, mTrackingInterval is kept for resumeAR
+    void joinTrackingThread();
+
+    /// Return the GL pose of a trackable result, predicted to mPredictionTargetTime if prediction is enabled
+    Vuforia::Matrix44F getPredictedPose(const TrackingResult& result, const PosePredictor& predictor) const;
+
 private: // data members
 
     /// Callback to inform the user of an error
     ErrorCallback mShowErrorCallback;
     /// Callback to inform the user that initialization is complete
     InitDoneCallback mInitDoneCallback;
-    /// Vuforia initialization flags
-    int mVuforiaInitFlags = 0;
     /// The target to use, either IMAGE_TARGET_ID or MODEL_TARGET_ID
     int mTarget = IMAGE_TARGET_ID;
 
-    /// Local cache of current screen orientation for calculating rendering data
-    int mOrientation = 0;
-
-    /// The Vuforia camera mode to use, either DEFAULT, SPEED or QUALITY.
-    Vuforia::CameraDevice::MODE mCameraMode = Vuforia::CameraDevice::MODE_DEFAULT;
-    /// True when the Vuforia camera is currently started.
-    bool mCameraIsActive = false;
-    /// True when the Vuforia camera has been started. The camera may currently
-    /// be stopped because AR has been paused.
-    bool mCameraIsStarted = false;
-
-    /// Flag to ensure we only perform once-per-session rendering setup the first time
-    /// configureRendering is called
-    bool mDoneOneTimeRenderingConfiguration = false;
-    /// Local copy of current RenderingPrimitives
-    std::unique_ptr<Vuforia::RenderingPrimitives> mCurrentRenderingPrimitives;
-    /// Remember the display aspect ratio for later configuration of Guide View rendering
-    float mDisplayAspectRatio;
-
-    /// After the first call to prepareToRender this holds a copy of the Vuforia state.
-    Vuforia::State mVuforiaState;
-    /// The currently activated Vuforia DataSet.
-    Vuforia::DataSet*  mCurrentDataSet = nullptr;
-    /// If a Model Target Guide View should be displayed this points to the object providing
-    /// details of what the App should render.
-    const Vuforia::ModelTarget* mGuideViewModelTarget = nullptr;
+    /// Engine the tracking data and video background come from
+    std::unique_ptr<TrackingBackend> mBackend;
+
+    /// Tracking data of the frame being published, from the backend or replayed
+    TrackingFrame mTrackingFrame;
+    /// Guide View image of each Model Target result in mTrackingFrame, these are not recorded
+    std::vector<const Vuforia::Image*> mGuideViewImages;
+    /// Held while a frame is published, guards the publishing state below that the
+    /// setters, the recording calls and initReplay change from other threads
+    mutable std::mutex mPublishMutex;
+    /// Open while recording
+    TrackingLogWriter mTrackingLogWriter;
+    /// Snapshots handed from publishFrameSnapshot to prepareToRender and the getters
+    TripleBuffer<FrameSnapshot> mFrameSnapshots;
+    /// Sequence number of the last published snapshot
+    std::uint64_t mFrameSnapshotSequence = 0;
+    /// True between a prepareToRender that started Vuforia rendering and finishRender
+    bool mRenderingFrame = false;
+    /// View and projection matrices derived from mTrackingFrame, invalidated when a frame is published
+    FrameCache mFrameCache;
+    /// Statistics for mFrameCache usage, counted on the publishing thread
+    std::atomic<std::uint64_t> mFrameCacheHits{ 0 };
+    std::atomic<std::uint64_t> mFrameCacheMisses{ 0 };
+    /// Pose history and extrapolation for the device and for the selected target
+    PosePredictor mDevicePosePredictor;
+    PosePredictor mTargetPosePredictor;
+    /// Time the poses of the current frame are predicted to, in the Vuforia clock
+    double mPredictionTargetTime = 0.0;
+    /// Target time requested with setPredictionTargetTime for the next snapshot
+    double mRequestedPredictionTargetTime = 0.0;
+    bool mHasRequestedPredictionTargetTime = false;
+    /// How far past the current Vuforia time at publishing poses are predicted, in seconds
+    double mPredictionLatency = 0.0;
+    /// If a Model Target Guide View should be displayed this holds the details of what the
+    /// App should render.
+    GuideViewState mGuideView;
+
+    /// Publishes snapshots between startTrackingThread and stopTrackingThread, except
+    /// while paused. Started and stopped from the lifecycle calls only.
+    std::thread mTrackingThread;
+    /// Update interval of the tracking thread in seconds, 0 when it is not wanted
+    double mTrackingInterval = 0.0;
+    /// Wakes the tracking thread early to stop it
+    std::mutex mTrackingThreadMutex;
+    std::condition_variable mTrackingThreadWake;
+    bool mStopTrackingThread = false;
 };
 
 #endif /* __APPCONTROLLER_H__ */
@@ -23,7 +23,7 @@
 // Use logging method implemented in UWP/Log.cpp
 void LOG(const char* message, ...);
 
-#elif defined(__APPLE__) // iOS
+#else // iOS, and desktop builds of the CrossPlatform code such as load tests
 #   define LOG(...) do { printf(__VA_ARGS__); printf("\n"); } while (0)
 #endif
 
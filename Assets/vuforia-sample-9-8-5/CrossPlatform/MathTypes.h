@@ -0,0 +1,298 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MATH_TYPES_H__
+#define __MATH_TYPES_H__
+
+#include <Vuforia/Vectors.h>
+#include <Vuforia/Matrices.h>
+
+#include <cmath>
+
+
+/// Header-only vector and matrix types for the sample math code.
+/**
+ * The types have the same layout as the corresponding Vuforia PODs (a plain float array
+ * named data) and convert to and from them implicitly, so they can be passed anywhere a
+ * Vuforia::Vec*F or Vuforia::Matrix44F is expected.
+ * Everything that does not need a square root or trigonometry is constexpr, so constant
+ * matrices and vectors are evaluated at compile time.
+ * Matrices use the same storage convention as MathUtils: translation in data[12..14].
+ */
+namespace SampleMath
+{
+    /// 2D vector, layout compatible with Vuforia::Vec2F
+    struct Vec2
+    {
+        float data[2];
+
+        constexpr Vec2() : data{ 0.0f, 0.0f } {}
+        constexpr Vec2(float x, float y) : data{ x, y } {}
+        constexpr Vec2(const Vuforia::Vec2F& v) : data{ v.data[0], v.data[1] } {}
+
+        operator Vuforia::Vec2F() const { return Vuforia::Vec2F(data[0], data[1]); }
+
+        constexpr float operator[](int i) const { return data[i]; }
+        constexpr float& operator[](int i) { return data[i]; }
+    };
+
+
+    /// 3D vector, layout compatible with Vuforia::Vec3F
+    struct Vec3
+    {
+        float data[3];
+
+        constexpr Vec3() : data{ 0.0f, 0.0f, 0.0f } {}
+        constexpr Vec3(float x, float y, float z) : data{ x, y, z } {}
+        constexpr Vec3(const Vuforia::Vec3F& v) : data{ v.data[0], v.data[1], v.data[2] } {}
+
+        operator Vuforia::Vec3F() const { return Vuforia::Vec3F(data[0], data[1], data[2]); }
+
+        constexpr float operator[](int i) const { return data[i]; }
+        constexpr float& operator[](int i) { return data[i]; }
+    };
+
+
+    /// 4D vector, layout compatible with Vuforia::Vec4F
+    struct Vec4
+    {
+        float data[4];
+
+        constexpr Vec4() : data{ 0.0f, 0.0f, 0.0f, 0.0f } {}
+        constexpr Vec4(float x, float y, float z, float w) : data{ x, y, z, w } {}
+        constexpr Vec4(const Vuforia::Vec4F& v) : data{ v.data[0], v.data[1], v.data[2], v.data[3] } {}
+
+        operator Vuforia::Vec4F() const { return Vuforia::Vec4F(data[0], data[1], data[2], data[3]); }
+
+        constexpr float operator[](int i) const { return data[i]; }
+        constexpr float& operator[](int i) { return data[i]; }
+    };
+
+
+    /// 4x4 matrix, layout compatible with Vuforia::Matrix44F
+    struct Mat4
+    {
+        float data[16];
+
+        /// Zero matrix
+        constexpr Mat4() : data{} {}
+
+        /// Elements in storage order
+        constexpr Mat4(float m0, float m1, float m2, float m3,
+                       float m4, float m5, float m6, float m7,
+                       float m8, float m9, float m10, float m11,
+                       float m12, float m13, float m14, float m15)
+            : data{ m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15 } {}
+
+        constexpr Mat4(const Vuforia::Matrix44F& m) : data{}
+        {
+            for (int i = 0; i < 16; i++)
+                data[i] = m.data[i];
+        }
+
+        constexpr operator Vuforia::Matrix44F() const
+        {
+            Vuforia::Matrix44F r{};
+            for (int i = 0; i < 16; i++)
+                r.data[i] = data[i];
+            return r;
+        }
+
+        constexpr float operator[](int i) const { return data[i]; }
+        constexpr float& operator[](int i) { return data[i]; }
+    };
+
+    static_assert(sizeof(Vec2) == sizeof(Vuforia::Vec2F), "Vec2 must match the Vuforia::Vec2F layout");
+    static_assert(sizeof(Vec3) == sizeof(Vuforia::Vec3F), "Vec3 must match the Vuforia::Vec3F layout");
+    static_assert(sizeof(Vec4) == sizeof(Vuforia::Vec4F), "Vec4 must match the Vuforia::Vec4F layout");
+    static_assert(sizeof(Mat4) == sizeof(Vuforia::Matrix44F), "Mat4 must match the Vuforia::Matrix44F layout");
+
+
+    // VECTOR OPERATORS
+
+    constexpr Vec2 operator-(const Vec2& v) { return Vec2(-v.data[0], -v.data[1]); }
+    constexpr Vec2 operator+(const Vec2& a, const Vec2& b) { return Vec2(a.data[0] + b.data[0], a.data[1] + b.data[1]); }
+    constexpr Vec2 operator-(const Vec2& a, const Vec2& b) { return Vec2(a.data[0] - b.data[0], a.data[1] - b.data[1]); }
+    constexpr Vec2 operator*(const Vec2& v, float s) { return Vec2(v.data[0] * s, v.data[1] * s); }
+    constexpr Vec2 operator*(float s, const Vec2& v) { return v * s; }
+
+    constexpr Vec3 operator-(const Vec3& v) { return Vec3(-v.data[0], -v.data[1], -v.data[2]); }
+    constexpr Vec3 operator+(const Vec3& a, const Vec3& b)
+    {
+        return Vec3(a.data[0] + b.data[0], a.data[1] + b.data[1], a.data[2] + b.data[2]);
+    }
+    constexpr Vec3 operator-(const Vec3& a, const Vec3& b)
+    {
+        return Vec3(a.data[0] - b.data[0], a.data[1] - b.data[1], a.data[2] - b.data[2]);
+    }
+    constexpr Vec3 operator*(const Vec3& v, float s) { return Vec3(v.data[0] * s, v.data[1] * s, v.data[2] * s); }
+    constexpr Vec3 operator*(float s, const Vec3& v) { return v * s; }
+
+    constexpr Vec4 operator-(const Vec4& v) { return Vec4(-v.data[0], -v.data[1], -v.data[2], -v.data[3]); }
+    constexpr Vec4 operator+(const Vec4& a, const Vec4& b)
+    {
+        return Vec4(a.data[0] + b.data[0], a.data[1] + b.data[1], a.data[2] + b.data[2], a.data[3] + b.data[3]);
+    }
+    constexpr Vec4 operator-(const Vec4& a, const Vec4& b)
+    {
+        return Vec4(a.data[0] - b.data[0], a.data[1] - b.data[1], a.data[2] - b.data[2], a.data[3] - b.data[3]);
+    }
+    constexpr Vec4 operator*(const Vec4& v, float s)
+    {
+        return Vec4(v.data[0] * s, v.data[1] * s, v.data[2] * s, v.data[3] * s);
+    }
+    constexpr Vec4 operator*(float s, const Vec4& v) { return v * s; }
+
+
+    // VECTOR FUNCTIONS
+
+    constexpr float dot(const Vec2& a, const Vec2& b) { return a.data[0] * b.data[0] + a.data[1] * b.data[1]; }
+
+    constexpr float dot(const Vec3& a, const Vec3& b)
+    {
+        return a.data[0] * b.data[0] + a.data[1] * b.data[1] + a.data[2] * b.data[2];
+    }
+
+    constexpr Vec3 cross(const Vec3& a, const Vec3& b)
+    {
+        return Vec3(a.data[1] * b.data[2] - a.data[2] * b.data[1],
+                    a.data[2] * b.data[0] - a.data[0] * b.data[2],
+                    a.data[0] * b.data[1] - a.data[1] * b.data[0]);
+    }
+
+    inline float length(const Vec2& v) { return std::sqrt(dot(v, v)); }
+    inline float length(const Vec3& v) { return std::sqrt(dot(v, v)); }
+
+    inline float distance(const Vec2& a, const Vec2& b) { return length(a - b); }
+    inline float distance(const Vec3& a, const Vec3& b) { return length(a - b); }
+
+    /// Return v / ||v||, or v unchanged if it has zero length
+    inline Vec3 normalize(const Vec3& v)
+    {
+        float len = length(v);
+        if (len != 0.0f)
+            len = 1.0f / len;
+        return v * len;
+    }
+
+
+    // MATRIX CONSTRUCTION
+
+    constexpr Mat4 identity()
+    {
+        return Mat4(1.0f, 0.0f, 0.0f, 0.0f,
+                    0.0f, 1.0f, 0.0f, 0.0f,
+                    0.0f, 0.0f, 1.0f, 0.0f,
+                    0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    constexpr Mat4 translation(const Vec3& t)
+    {
+        return Mat4(1.0f, 0.0f, 0.0f, 0.0f,
+                    0.0f, 1.0f, 0.0f, 0.0f,
+                    0.0f, 0.0f, 1.0f, 0.0f,
+                    t.data[0], t.data[1], t.data[2], 1.0f);
+    }
+
+    constexpr Mat4 scaling(const Vec3& s)
+    {
+        return Mat4(s.data[0], 0.0f, 0.0f, 0.0f,
+                    0.0f, s.data[1], 0.0f, 0.0f,
+                    0.0f, 0.0f, s.data[2], 0.0f,
+                    0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    constexpr Mat4 transpose(const Mat4& m)
+    {
+        Mat4 r;
+        for (int i = 0; i < 4; i++)
+            for (int j = 0; j < 4; j++)
+                r.data[i * 4 + j] = m.data[i + 4 * j];
+        return r;
+    }
+
+    /// 180 degree rotation around the X axis, converts between the Vuforia world and camera coordinate systems
+    constexpr Mat4 ROTATE_180_X = Mat4(1.0f, 0.0f, 0.0f, 0.0f,
+                                       0.0f, -1.0f, 0.0f, 0.0f,
+                                       0.0f, 0.0f, -1.0f, 0.0f,
+                                       0.0f, 0.0f, 0.0f, 1.0f);
+
+
+    // MATRIX OPERATIONS
+
+    /// Matrix product (result = a * b), adds in the same order as MathUtils::multiplyMatrix
+    constexpr Mat4 operator*(const Mat4& a, const Mat4& b)
+    {
+        Mat4 r;
+        for (int j = 0; j < 4; j++)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                r.data[j * 4 + i] = a.data[i] * b.data[j * 4] +
+                    a.data[4 + i] * b.data[j * 4 + 1] +
+                    a.data[8 + i] * b.data[j * 4 + 2] +
+                    a.data[12 + i] * b.data[j * 4 + 3];
+            }
+        }
+        return r;
+    }
+
+    /// Transform a point (pre multiply, w = 1)
+    constexpr Vec3 transformPoint(const Mat4& m, const Vec3& v)
+    {
+        return Vec3(m.data[0] * v.data[0] + m.data[4] * v.data[1] + m.data[8] * v.data[2] + m.data[12],
+                    m.data[1] * v.data[0] + m.data[5] * v.data[1] + m.data[9] * v.data[2] + m.data[13],
+                    m.data[2] * v.data[0] + m.data[6] * v.data[1] + m.data[10] * v.data[2] + m.data[14]);
+    }
+
+    /// Transform a normal (pre multiply, rotation only)
+    constexpr Vec3 transformNormal(const Mat4& m, const Vec3& v)
+    {
+        return Vec3(m.data[0] * v.data[0] + m.data[4] * v.data[1] + m.data[8] * v.data[2],
+                    m.data[1] * v.data[0] + m.data[5] * v.data[1] + m.data[9] * v.data[2],
+                    m.data[2] * v.data[0] + m.data[6] * v.data[1] + m.data[10] * v.data[2]);
+    }
+
+    /// Transform a 4D vector (pre multiply, result = m * v)
+    constexpr Vec4 operator*(const Mat4& m, const Vec4& v)
+    {
+        return Vec4(m.data[0] * v.data[0] + m.data[4] * v.data[1] + m.data[8] * v.data[2] + m.data[12] * v.data[3],
+                    m.data[1] * v.data[0] + m.data[5] * v.data[1] + m.data[9] * v.data[2] + m.data[13] * v.data[3],
+                    m.data[2] * v.data[0] + m.data[6] * v.data[1] + m.data[10] * v.data[2] + m.data[14] * v.data[3],
+                    m.data[3] * v.data[0] + m.data[7] * v.data[1] + m.data[11] * v.data[2] + m.data[15] * v.data[3]);
+    }
+
+    /// Transform a 4D vector (post multiply, result = v * m)
+    constexpr Vec4 operator*(const Vec4& v, const Mat4& m)
+    {
+        return Vec4(m.data[0] * v.data[0] + m.data[1] * v.data[1] + m.data[2] * v.data[2] + m.data[3] * v.data[3],
+                    m.data[4] * v.data[0] + m.data[5] * v.data[1] + m.data[6] * v.data[2] + m.data[7] * v.data[3],
+                    m.data[8] * v.data[0] + m.data[9] * v.data[1] + m.data[10] * v.data[2] + m.data[11] * v.data[3],
+                    m.data[12] * v.data[0] + m.data[13] * v.data[1] + m.data[14] * v.data[2] + m.data[15] * v.data[3]);
+    }
+
+    /// Translate m by t (post multiply, result = m * T(t)) without a full matrix product
+    constexpr Mat4 translated(const Mat4& m, const Vec3& t)
+    {
+        Mat4 r = m;
+        for (int i = 0; i < 4; i++)
+            r.data[12 + i] += (m.data[i] * t.data[0] + m.data[4 + i] * t.data[1] + m.data[8 + i] * t.data[2]);
+        return r;
+    }
+
+    /// Scale m by s (post multiply, result = m * S(s)) without a full matrix product
+    constexpr Mat4 scaled(const Mat4& m, const Vec3& s)
+    {
+        Mat4 r = m;
+        for (int j = 0; j < 3; j++)
+            for (int i = 0; i < 4; i++)
+                r.data[j * 4 + i] *= s.data[j];
+        return r;
+    }
+}
+
+#endif // __MATH_TYPES_H__
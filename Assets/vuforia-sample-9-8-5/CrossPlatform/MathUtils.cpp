@@ -7,91 +7,248 @@ countries.
 
 #include "MathUtils.h"
 #include "Log.h"
+#include "Simd.h"
 
 #define _USE_MATH_DEFINES
+#include <algorithm>
 #include <cmath>
+#include <thread>
+#include <vector>
+
+// The SIMD and scalar matrix kernels below perform the same multiplies and adds
+// in the same order so they produce bit-identical results. This relies on the
+// compiler not contracting a multiply followed by an add into a fused multiply-add.
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+// When enabled Matrix44FInverseRigid logs a warning if its input is not a rigid transform
+#if !defined(MATHUTILS_VALIDATE_RIGID)
+#if defined(_DEBUG)
+#define MATHUTILS_VALIDATE_RIGID 1
+#else
+#define MATHUTILS_VALIDATE_RIGID 0
+#endif
+#endif
+
+
+namespace
+{
+    /// Compute C = A * B for 4x4 matrices stored as 16 consecutive floats.
+    /// Each 4-float group of C is a linear combination of the four 4-float groups of A
+    /// weighted by the matching group of B, evaluated as ((a0*b0 + a1*b1) + a2*b2) + a3*b3.
+    /// C must not alias A or B.
+    inline void multiplyMatrixScalar(const float* a, const float* b, float* c)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            const float* bj = b + j * 4;
+            for (int i = 0; i < 4; i++)
+            {
+                c[j * 4 + i] = a[i] * bj[0] + a[4 + i] * bj[1] + a[8 + i] * bj[2] + a[12 + i] * bj[3];
+            }
+        }
+    }
 
-Vuforia::Vec2F
-MathUtils::Vec2FZero()
-{
-    Vuforia::Vec2F v;
-
-    v.data[0] = 0.0f;
-    v.data[1] = 0.0f;
-
-    return v;
-}
-
-
-Vuforia::Vec2F
-MathUtils::Vec2FUnit()
-{
-    Vuforia::Vec2F v;
-
-    v.data[0] = 1.0f;
-    v.data[1] = 1.0f;
-
-    return v;
-}
-
-Vuforia::Vec2F
-MathUtils::Vec2FOpposite(const Vuforia::Vec2F& v)
-{
-    Vuforia::Vec2F r;
+#if defined(SIMD_USE_SSE)
+    /// SSE version of multiplyMatrixScalar.
+    /// All of A is loaded before C is written and group j of B is read before group j of C
+    /// is written, so C may alias A or B.
+    inline void multiplyMatrixSIMD(const float* a, const float* b, float* c)
+    {
+        const __m128 a0 = _mm_loadu_ps(a);
+        const __m128 a1 = _mm_loadu_ps(a + 4);
+        const __m128 a2 = _mm_loadu_ps(a + 8);
+        const __m128 a3 = _mm_loadu_ps(a + 12);
 
-    r.data[0] = -v.data[0];
-    r.data[1] = -v.data[1];
+        for (int j = 0; j < 4; j++)
+        {
+            const float* bj = b + j * 4;
+            __m128 r = _mm_mul_ps(a0, _mm_set1_ps(bj[0]));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(bj[1])));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(bj[2])));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(bj[3])));
+            _mm_storeu_ps(c + j * 4, r);
+        }
+    }
+#elif defined(SIMD_USE_NEON)
+    /// NEON version of multiplyMatrixScalar.
+    /// Multiplies and adds are issued separately (no vmla/vfma) to match the scalar rounding.
+    /// All of A is loaded before C is written and group j of B is read before group j of C
+    /// is written, so C may alias A or B.
+    inline void multiplyMatrixSIMD(const float* a, const float* b, float* c)
+    {
+        const float32x4_t a0 = vld1q_f32(a);
+        const float32x4_t a1 = vld1q_f32(a + 4);
+        const float32x4_t a2 = vld1q_f32(a + 8);
+        const float32x4_t a3 = vld1q_f32(a + 12);
 
-    return r;
-}
+        for (int j = 0; j < 4; j++)
+        {
+            const float32x4_t bj = vld1q_f32(b + j * 4);
+            float32x4_t r = vmulq_lane_f32(a0, vget_low_f32(bj), 0);
+            r = vaddq_f32(r, vmulq_lane_f32(a1, vget_low_f32(bj), 1));
+            r = vaddq_f32(r, vmulq_lane_f32(a2, vget_high_f32(bj), 0));
+            r = vaddq_f32(r, vmulq_lane_f32(a3, vget_high_f32(bj), 1));
+            vst1q_f32(c + j * 4, r);
+        }
+    }
+#endif
 
+    /// Number of points gathered into SoA form at a time by the AoS transforms
+    constexpr size_t TRANSFORM_BLOCK_SIZE = 64;
 
-Vuforia::Vec2F
-MathUtils::Vec2FAdd(const Vuforia::Vec2F& v1, const Vuforia::Vec2F& v2)
-{
-    Vuforia::Vec2F r;
+    /// Transform n points (or normals when W is false) stored as separate x, y and z arrays.
+    /// Each output is evaluated as ((m0*x + m4*y) + m8*z) + m12 like Vec3FTransform,
+    /// four points at a time when SIMD is available. Outputs may alias the inputs.
+    template <bool W>
+    void transformSoA(const float* m, const float* x, const float* y, const float* z,
+                      float* ox, float* oy, float* oz, size_t n)
+    {
+        size_t i = 0;
 
-    r.data[0] = v1.data[0] + v2.data[0];
-    r.data[1] = v1.data[1] + v2.data[1];
+#if defined(SIMD_USE_SSE)
+        const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+        const __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+        const __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+        const __m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]);
 
-    return r;
-}
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m128 vx = _mm_loadu_ps(x + i);
+            const __m128 vy = _mm_loadu_ps(y + i);
+            const __m128 vz = _mm_loadu_ps(z + i);
+
+            __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, vx), _mm_mul_ps(m4, vy)), _mm_mul_ps(m8, vz));
+            __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, vx), _mm_mul_ps(m5, vy)), _mm_mul_ps(m9, vz));
+            __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, vx), _mm_mul_ps(m6, vy)), _mm_mul_ps(m10, vz));
+            if (W)
+            {
+                rx = _mm_add_ps(rx, m12);
+                ry = _mm_add_ps(ry, m13);
+                rz = _mm_add_ps(rz, m14);
+            }
+
+            _mm_storeu_ps(ox + i, rx);
+            _mm_storeu_ps(oy + i, ry);
+            _mm_storeu_ps(oz + i, rz);
+        }
+#elif defined(SIMD_USE_NEON)
+        const float32x4_t m0 = vdupq_n_f32(m[0]), m1 = vdupq_n_f32(m[1]), m2 = vdupq_n_f32(m[2]);
+        const float32x4_t m4 = vdupq_n_f32(m[4]), m5 = vdupq_n_f32(m[5]), m6 = vdupq_n_f32(m[6]);
+        const float32x4_t m8 = vdupq_n_f32(m[8]), m9 = vdupq_n_f32(m[9]), m10 = vdupq_n_f32(m[10]);
+        const float32x4_t m12 = vdupq_n_f32(m[12]), m13 = vdupq_n_f32(m[13]), m14 = vdupq_n_f32(m[14]);
 
-Vuforia::Vec2F
-MathUtils::Vec2FSub(const Vuforia::Vec2F& v1, const Vuforia::Vec2F& v2)
-{
-    Vuforia::Vec2F r;
+        for (; i + 4 <= n; i += 4)
+        {
+            const float32x4_t vx = vld1q_f32(x + i);
+            const float32x4_t vy = vld1q_f32(y + i);
+            const float32x4_t vz = vld1q_f32(z + i);
+
+            float32x4_t rx = vaddq_f32(vaddq_f32(vmulq_f32(m0, vx), vmulq_f32(m4, vy)), vmulq_f32(m8, vz));
+            float32x4_t ry = vaddq_f32(vaddq_f32(vmulq_f32(m1, vx), vmulq_f32(m5, vy)), vmulq_f32(m9, vz));
+            float32x4_t rz = vaddq_f32(vaddq_f32(vmulq_f32(m2, vx), vmulq_f32(m6, vy)), vmulq_f32(m10, vz));
+            if (W)
+            {
+                rx = vaddq_f32(rx, m12);
+                ry = vaddq_f32(ry, m13);
+                rz = vaddq_f32(rz, m14);
+            }
+
+            vst1q_f32(ox + i, rx);
+            vst1q_f32(oy + i, ry);
+            vst1q_f32(oz + i, rz);
+        }
+#endif
 
-    r.data[0] = v1.data[0] - v2.data[0];
-    r.data[1] = v1.data[1] - v2.data[1];
+        for (; i < n; i++)
+        {
+            const float vx = x[i], vy = y[i], vz = z[i];
+            float rx = m[0] * vx + m[4] * vy + m[8] * vz;
+            float ry = m[1] * vx + m[5] * vy + m[9] * vz;
+            float rz = m[2] * vx + m[6] * vy + m[10] * vz;
+            if (W)
+            {
+                rx += m[12];
+                ry += m[13];
+                rz += m[14];
+            }
+            ox[i] = rx;
+            oy[i] = ry;
+            oz[i] = rz;
+        }
+    }
 
-    return r;
-}
+    /// Transform n points (or normals when W is false) stored as xyz triples with a stride.
+    /// Blocks of points are gathered into SoA form, transformed and scattered back,
+    /// so out may be the same array as in.
+    template <bool W>
+    void transformAoS(const float* m, const float* in, float* out, size_t n, size_t inStride, size_t outStride)
+    {
+        float x[TRANSFORM_BLOCK_SIZE];
+        float y[TRANSFORM_BLOCK_SIZE];
+        float z[TRANSFORM_BLOCK_SIZE];
 
-float
-MathUtils::Vec2FDist(const Vuforia::Vec2F& v1, const Vuforia::Vec2F& v2)
-{
-    float dx = v1.data[0] - v2.data[0];
-    float dy = v1.data[1] - v2.data[1];
+        for (size_t start = 0; start < n; start += TRANSFORM_BLOCK_SIZE)
+        {
+            const size_t count = std::min(TRANSFORM_BLOCK_SIZE, n - start);
+
+            const float* src = in + start * inStride;
+            for (size_t i = 0; i < count; i++, src += inStride)
+            {
+                x[i] = src[0];
+                y[i] = src[1];
+                z[i] = src[2];
+            }
+
+            transformSoA<W>(m, x, y, z, x, y, z, count);
+
+            float* dst = out + start * outStride;
+            for (size_t i = 0; i < count; i++, dst += outStride)
+            {
+                dst[0] = x[i];
+                dst[1] = y[i];
+                dst[2] = z[i];
+            }
+        }
+    }
 
-    return sqrtf(dx * dx + dy * dy);
-}
+    /// Split an AoS transform across worker threads, the calling thread takes the last chunk
+    template <bool W>
+    void transformAoSParallel(const float* m, const float* in, float* out, size_t n,
+                              size_t inStride, size_t outStride, unsigned int numThreads)
+    {
+        if (numThreads == 0)
+        {
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
 
-Vuforia::Vec2F
-MathUtils::Vec2FScale(const Vuforia::Vec2F& v, float s)
-{
-    Vuforia::Vec2F r;
+        if (n < MathUtils::PARALLEL_TRANSFORM_THRESHOLD || numThreads == 1)
+        {
+            transformAoS<W>(m, in, out, n, inStride, outStride);
+            return;
+        }
 
-    r.data[0] = v.data[0] * s;
-    r.data[1] = v.data[1] * s;
+        // Keep chunks a multiple of the block size so every thread runs full SIMD blocks
+        size_t chunk = (n + numThreads - 1) / numThreads;
+        chunk = (chunk + TRANSFORM_BLOCK_SIZE - 1) / TRANSFORM_BLOCK_SIZE * TRANSFORM_BLOCK_SIZE;
 
-    return r;
-}
+        std::vector<std::thread> workers;
+        size_t start = 0;
+        for (; start + chunk < n; start += chunk)
+        {
+            workers.emplace_back(transformAoS<W>, m, in + start * inStride, out + start * outStride,
+                                 chunk, inStride, outStride);
+        }
+        transformAoS<W>(m, in + start * inStride, out + start * outStride, n - start, inStride, outStride);
 
-float
-MathUtils::Vec2FNorm(const Vuforia::Vec2F& v)
-{
-    return sqrtf(v.data[0] * v.data[0] + v.data[1] * v.data[1]);
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
 }
 
 
@@ -102,151 +259,6 @@ MathUtils::printVector(const Vuforia::Vec2F& v)
 }
 
 
-Vuforia::Vec3F
-MathUtils::Vec3FZero()
-{
-    Vuforia::Vec3F v;
-
-    v.data[0] = 0.0f;
-    v.data[1] = 0.0f;
-    v.data[2] = 0.0f;
-
-    return v;
-}
-
-
-Vuforia::Vec3F
-MathUtils::Vec3FUnit()
-{
-    Vuforia::Vec3F v;
-
-    v.data[0] = 1.0f;
-    v.data[1] = 1.0f;
-    v.data[2] = 1.0f;
-
-    return v;
-}
-
-Vuforia::Vec3F
-MathUtils::Vec3FOpposite(const Vuforia::Vec3F& v)
-{
-    Vuforia::Vec3F r;
-
-    r.data[0] = -v.data[0];
-    r.data[1] = -v.data[1];
-    r.data[2] = -v.data[2];
-
-    return r;
-}
-
-
-Vuforia::Vec3F
-MathUtils::Vec3FAdd(const Vuforia::Vec3F& v1, const Vuforia::Vec3F& v2)
-{
-    Vuforia::Vec3F r;
-
-    r.data[0] = v1.data[0] + v2.data[0];
-    r.data[1] = v1.data[1] + v2.data[1];
-    r.data[2] = v1.data[2] + v2.data[2];
-
-    return r;
-}
-
-
-Vuforia::Vec3F
-MathUtils::Vec3FSub(const Vuforia::Vec3F& v1, const Vuforia::Vec3F& v2)
-{
-    Vuforia::Vec3F r;
-
-    r.data[0] = v1.data[0] - v2.data[0];
-    r.data[1] = v1.data[1] - v2.data[1];
-    r.data[2] = v1.data[2] - v2.data[2];
-
-    return r;
-}
-
-float
-MathUtils::Vec3FDist(const Vuforia::Vec3F& v1, const Vuforia::Vec3F& v2)
-{
-    float dx = v1.data[0] - v2.data[0];
-    float dy = v1.data[1] - v2.data[1];
-    float dz = v1.data[2] - v2.data[2];
-
-    return sqrtf(dx * dx + dy * dy + dz* dz);
-}
-
-Vuforia::Vec3F
-MathUtils::Vec3FScale(const Vuforia::Vec3F& v, float s)
-{
-    Vuforia::Vec3F r;
-
-    r.data[0] = v.data[0] * s;
-    r.data[1] = v.data[1] * s;
-    r.data[2] = v.data[2] * s;
-
-    return r;
-}
-
-
-float
-MathUtils::Vec3FDot(const Vuforia::Vec3F& v1, const Vuforia::Vec3F& v2)
-{
-    return v1.data[0] * v2.data[0] + v1.data[1] * v2.data[1] + v1.data[2] * v2.data[2];
-}
-
-
-Vuforia::Vec3F
-MathUtils::Vec3FCross(const Vuforia::Vec3F& v1, const Vuforia::Vec3F& v2)
-{
-    Vuforia::Vec3F r;
-
-    r.data[0] = v1.data[1] * v2.data[2] - v1.data[2] * v2.data[1];
-    r.data[1] = v1.data[2] * v2.data[0] - v1.data[0] * v2.data[2];
-    r.data[2] = v1.data[0] * v2.data[1] - v1.data[1] * v2.data[0];
-
-    return r;
-}
-
-
-Vuforia::Vec3F
-MathUtils::Vec3FNormalize(const Vuforia::Vec3F& v)
-{
-    Vuforia::Vec3F r;
-
-    float length = sqrtf(v.data[0] * v.data[0] + v.data[1] * v.data[1] + v.data[2] * v.data[2]);
-    if (length != 0.0f)
-        length = 1.0f / length;
-
-    r.data[0] = v.data[0] * length;
-    r.data[1] = v.data[1] * length;
-    r.data[2] = v.data[2] * length;
-
-    return r;
-}
-
-
-Vuforia::Vec3F
-MathUtils::Vec3FTransform(const Vuforia::Matrix44F& m, const Vuforia::Vec3F& v)
-{
-    Vuforia::Vec3F r;
-
-    // consider vector v as 4d vector with w=1.0
-    r.data[0] = m.data[0] * v.data[0] +
-        m.data[4] * v.data[1] +
-        m.data[8] * v.data[2] +
-        m.data[12];
-    r.data[1] = m.data[1] * v.data[0] +
-        m.data[5] * v.data[1] +
-        m.data[9] * v.data[2] +
-        m.data[13];
-    r.data[2] = m.data[2] * v.data[0] +
-        m.data[6] * v.data[1] +
-        m.data[10] * v.data[2] +
-        m.data[14];
-
-    return r;
-}
-
 // code from SampleMaths, not sure about implementation here
 Vuforia::Vec3F
 MathUtils::Vec3FTransformR(const Vuforia::Vec3F& v, const Vuforia::Matrix44F& m)
@@ -279,23 +291,6 @@ MathUtils::Vec3FTransformR(const Vuforia::Vec3F& v, const Vuforia::Matrix44F& m)
     return r;
 }
 
-Vuforia::Vec3F
-MathUtils::Vec3FTransformNormal(const Vuforia::Matrix44F& m, const Vuforia::Vec3F& v)
-{
-    Vuforia::Vec3F r;
-
-    r.data[0] = m.data[0] * v.data[0] +
-        m.data[4] * v.data[1] +
-        m.data[8] * v.data[2];
-    r.data[1] = m.data[1] * v.data[0] +
-        m.data[5] * v.data[1] +
-        m.data[9] * v.data[2];
-    r.data[2] = m.data[2] * v.data[0] +
-        m.data[6] * v.data[1] +
-        m.data[10] * v.data[2];
-
-    return r;
-}
 
 Vuforia::Vec3F
 MathUtils::Vec3FTransformNormalR(const Vuforia::Vec3F& v, const Vuforia::Matrix44F& m)
@@ -316,108 +311,13 @@ MathUtils::Vec3FTransformNormalR(const Vuforia::Vec3F& v, const Vuforia::Matrix4
 }
 
 
-
-float
-MathUtils::Vec3FNorm(const Vuforia::Vec3F& v)
-{
-    return sqrtf(v.data[0] * v.data[0] + v.data[1] * v.data[1] + v.data[2] * v.data[2]);
-}
-
-
 void
 MathUtils::printVector(const Vuforia::Vec3F& v)
 {
     LOG("Vector = { %7.3f %7.3f %7.3f}\n", v.data[0], v.data[1], v.data[2]);
 }
 
-Vuforia::Vec4F
-MathUtils::Vec4FZero()
-{
-    Vuforia::Vec4F v;
-
-    v.data[0] = 0.0f;
-    v.data[1] = 0.0f;
-    v.data[2] = 0.0f;
-    v.data[3] = 0.0f;
-
-    return v;
-}
-
-Vuforia::Vec4F
-MathUtils::Vec4FUnit()
-{
-    Vuforia::Vec4F v;
-
-    v.data[0] = 1.0f;
-    v.data[1] = 1.0f;
-    v.data[2] = 1.0f;
-    v.data[3] = 1.0f;
-
-    return v;
-}
-
-Vuforia::Vec4F
-MathUtils::Vec4FScale(const Vuforia::Vec4F& v, float s)
-{
-    Vuforia::Vec4F r;
-
-    r.data[0] = v.data[0] * s;
-    r.data[1] = v.data[1] * s;
-    r.data[2] = v.data[2] * s;
-    r.data[3] = v.data[3] * s;
-
-    return r;
-}
-
-Vuforia::Vec4F
-MathUtils::Vec4FTransform(const Vuforia::Matrix44F& m, const Vuforia::Vec4F& v)
-{
-    Vuforia::Vec4F r;
-
-    r.data[0] = m.data[0] * v.data[0] +
-        m.data[4] * v.data[1] +
-        m.data[8] * v.data[2] +
-        m.data[12] * v.data[3];
-    r.data[1] = m.data[1] * v.data[0] +
-        m.data[5] * v.data[1] +
-        m.data[9] * v.data[2] +
-        m.data[13] * v.data[3];
-    r.data[2] = m.data[2] * v.data[0] +
-        m.data[6] * v.data[1] +
-        m.data[10] * v.data[2] +
-        m.data[14] * v.data[3];
-    r.data[3] = m.data[3] * v.data[0] +
-        m.data[7] * v.data[1] +
-        m.data[11] * v.data[2] +
-        m.data[15] * v.data[3];
-
-    return r;
-}
-
-Vuforia::Vec4F
-MathUtils::Vec4FTransformR(const Vuforia::Vec4F& v, const Vuforia::Matrix44F& m)
-{
-    Vuforia::Vec4F r;
 
-    r.data[0] = m.data[0] * v.data[0] +
-        m.data[1] * v.data[1] +
-        m.data[2] * v.data[2] +
-        m.data[3] * v.data[3];
-    r.data[1] = m.data[4] * v.data[0] +
-        m.data[5] * v.data[1] +
-        m.data[6] * v.data[2] +
-        m.data[7] * v.data[3];
-    r.data[2] = m.data[8] * v.data[0] +
-        m.data[9] * v.data[1] +
-        m.data[10] * v.data[2] +
-        m.data[11] * v.data[3];
-    r.data[3] = m.data[12] * v.data[0] +
-        m.data[13] * v.data[1] +
-        m.data[14] * v.data[2] +
-        m.data[15] * v.data[3];
-
-    return r;
-}
 void
 MathUtils::printVector(const Vuforia::Vec4F& v)
 {
@@ -425,50 +325,6 @@ MathUtils::printVector(const Vuforia::Vec4F& v)
 }
 
 
-Vuforia::Matrix34F
-MathUtils::Matrix34FIdentity()
-{
-    Vuforia::Matrix34F r;
-
-    for (int i = 0; i < 12; i++)
-        r.data[i] = 0.0f;
-
-    r.data[0] = 1.0f;
-    r.data[5] = 1.0f;
-    r.data[10] = 1.0f;
-
-    return r;
-}
-
-
-Vuforia::Matrix44F
-MathUtils::Matrix44FIdentity()
-{
-    Vuforia::Matrix44F r;
-
-    for (int i = 0; i < 16; i++)
-        r.data[i] = 0.0f;
-
-    r.data[0] = 1.0f;
-    r.data[5] = 1.0f;
-    r.data[10] = 1.0f;
-    r.data[15] = 1.0f;
-
-    return r;
-}
-
-
-Vuforia::Matrix44F
-MathUtils::Matrix44FTranspose(const Vuforia::Matrix44F& m)
-{
-    Vuforia::Matrix44F r;
-    for (int i = 0; i < 4; i++)
-        for (int j = 0; j < 4; j++)
-            r.data[i * 4 + j] = m.data[i + 4 * j];
-    return r;
-}
-
-
 float
 MathUtils::Matrix44FDeterminate(const Vuforia::Matrix44F& m)
 {
@@ -566,34 +422,115 @@ MathUtils::Matrix44FInverse(const Vuforia::Matrix44F& m)
 
 
 Vuforia::Matrix44F
-MathUtils::Matrix44FTranslate(const Vuforia::Vec3F& trans, const Vuforia::Matrix44F& m)
+MathUtils::Matrix44FInverseRigid(const Vuforia::Matrix44F& m)
 {
+#if MATHUTILS_VALIDATE_RIGID
+    if (!Matrix44FIsRigid(m))
+    {
+        LOG("Warning: Matrix44FInverseRigid called with a matrix that is not a rigid transform");
+    }
+#endif
+
     Vuforia::Matrix44F r;
 
-    r = copyMatrix(m);
-    translateMatrix(trans, r);
+    // Transpose the rotation part
+    r.data[0] = m.data[0];  r.data[4] = m.data[1];  r.data[8] = m.data[2];
+    r.data[1] = m.data[4];  r.data[5] = m.data[5];  r.data[9] = m.data[6];
+    r.data[2] = m.data[8];  r.data[6] = m.data[9];  r.data[10] = m.data[10];
+
+    // Translation is -R^T * t
+    r.data[12] = -(r.data[0] * m.data[12] + r.data[4] * m.data[13] + r.data[8] * m.data[14]);
+    r.data[13] = -(r.data[1] * m.data[12] + r.data[5] * m.data[13] + r.data[9] * m.data[14]);
+    r.data[14] = -(r.data[2] * m.data[12] + r.data[6] * m.data[13] + r.data[10] * m.data[14]);
+
+    r.data[3] = 0.0f;
+    r.data[7] = 0.0f;
+    r.data[11] = 0.0f;
+    r.data[15] = 1.0f;
 
     return r;
 }
 
+
 Vuforia::Matrix44F
-MathUtils::Matrix44FRotate(float angle, const Vuforia::Vec3F& axis, const Vuforia::Matrix44F& m)
+MathUtils::Matrix44FInverseAffine(const Vuforia::Matrix44F& m)
 {
     Vuforia::Matrix44F r;
 
-    r = copyMatrix(m);
-    rotateMatrix(angle, axis, r);
+    // Inverse of the upper 3x3 part from its cofactors
+    float c00 = m.data[5] * m.data[10] - m.data[9] * m.data[6];
+    float c01 = m.data[9] * m.data[2] - m.data[1] * m.data[10];
+    float c02 = m.data[1] * m.data[6] - m.data[5] * m.data[2];
+
+    float det = m.data[0] * c00 + m.data[4] * c01 + m.data[8] * c02;
+    float invDet = 1.0f / det;
+
+    r.data[0] = c00 * invDet;
+    r.data[1] = c01 * invDet;
+    r.data[2] = c02 * invDet;
+    r.data[4] = (m.data[8] * m.data[6] - m.data[4] * m.data[10]) * invDet;
+    r.data[5] = (m.data[0] * m.data[10] - m.data[8] * m.data[2]) * invDet;
+    r.data[6] = (m.data[4] * m.data[2] - m.data[0] * m.data[6]) * invDet;
+    r.data[8] = (m.data[4] * m.data[9] - m.data[8] * m.data[5]) * invDet;
+    r.data[9] = (m.data[8] * m.data[1] - m.data[0] * m.data[9]) * invDet;
+    r.data[10] = (m.data[0] * m.data[5] - m.data[4] * m.data[1]) * invDet;
+
+    // Translation is -A^-1 * t
+    r.data[12] = -(r.data[0] * m.data[12] + r.data[4] * m.data[13] + r.data[8] * m.data[14]);
+    r.data[13] = -(r.data[1] * m.data[12] + r.data[5] * m.data[13] + r.data[9] * m.data[14]);
+    r.data[14] = -(r.data[2] * m.data[12] + r.data[6] * m.data[13] + r.data[10] * m.data[14]);
+
+    r.data[3] = 0.0f;
+    r.data[7] = 0.0f;
+    r.data[11] = 0.0f;
+    r.data[15] = 1.0f;
 
     return r;
 }
 
+
+bool
+MathUtils::Matrix44FIsRigid(const Vuforia::Matrix44F& m, float tolerance)
+{
+    // No projective part
+    if (std::fabs(m.data[3]) > tolerance || std::fabs(m.data[7]) > tolerance ||
+        std::fabs(m.data[11]) > tolerance || std::fabs(m.data[15] - 1.0f) > tolerance)
+    {
+        return false;
+    }
+
+    // Rotation columns are orthonormal (R^T * R = I)
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = i; j < 3; j++)
+        {
+            float dot = m.data[i * 4] * m.data[j * 4] +
+                m.data[i * 4 + 1] * m.data[j * 4 + 1] +
+                m.data[i * 4 + 2] * m.data[j * 4 + 2];
+            float expected = (i == j) ? 1.0f : 0.0f;
+            if (std::fabs(dot - expected) > tolerance)
+            {
+                return false;
+            }
+        }
+    }
+
+    // Not a reflection
+    float det = m.data[0] * (m.data[5] * m.data[10] - m.data[9] * m.data[6]) +
+        m.data[4] * (m.data[9] * m.data[2] - m.data[1] * m.data[10]) +
+        m.data[8] * (m.data[1] * m.data[6] - m.data[5] * m.data[2]);
+
+    return std::fabs(det - 1.0f) <= tolerance;
+}
+
+
 Vuforia::Matrix44F
-MathUtils::Matrix44FScale(const Vuforia::Vec3F& scale, const Vuforia::Matrix44F& m)
+MathUtils::Matrix44FRotate(float angle, const Vuforia::Vec3F& axis, const Vuforia::Matrix44F& m)
 {
     Vuforia::Matrix44F r;
 
     r = copyMatrix(m);
-    scaleMatrix(scale, r);
+    rotateMatrix(angle, axis, r);
 
     return r;
 }
@@ -663,13 +600,6 @@ MathUtils::printMatrix(const Vuforia::Matrix44F& m)
 }
 
 
-Vuforia::Matrix44F
-MathUtils::copyMatrix(const Vuforia::Matrix44F& m)
-{
-    return m;
-}
-
-
 void
 MathUtils::makeRotationMatrix(float angle, const Vuforia::Vec3F& axis, Vuforia::Matrix44F& m)
 {
@@ -710,26 +640,6 @@ MathUtils::makeRotationMatrix(float angle, const Vuforia::Vec3F& axis, Vuforia::
 }
 
 
-void
-MathUtils::makeTranslationMatrix(const Vuforia::Vec3F& trans, Vuforia::Matrix44F& m)
-{
-    m = Matrix44FIdentity();
-
-    m.data[12] = trans.data[0];
-    m.data[13] = trans.data[1];
-    m.data[14] = trans.data[2];
-}
-
-void
-MathUtils::makeScalingMatrix(const Vuforia::Vec3F& scale, Vuforia::Matrix44F& m)
-{
-    m = Matrix44FIdentity();
-
-    m.data[0] = scale.data[0];
-    m.data[5] = scale.data[1];
-    m.data[10] = scale.data[2];
-}
-
 void
 MathUtils::makePerspectiveMatrix(float fovy, float aspectRatio, float nearPlane, float farPlane, Vuforia::Matrix44F& m)
 {
@@ -818,19 +728,6 @@ MathUtils::makeLookAtMatrix(const Vuforia::Vec3F& eye, const Vuforia::Vec3F& cen
 
 }
 
-void
-MathUtils::translateMatrix(const Vuforia::Vec3F& v, Vuforia::Matrix44F& m)
-{
-    // m = m * translate_m
-    m.data[12] += (m.data[0] * v.data[0] + m.data[4] * v.data[1] + m.data[8] * v.data[2]);
-
-    m.data[13] += (m.data[1] * v.data[0] + m.data[5] * v.data[1] + m.data[9] * v.data[2]);
-
-    m.data[14] += (m.data[2] * v.data[0] + m.data[6] * v.data[1] + m.data[10] * v.data[2]);
-
-    m.data[15] += (m.data[3] * v.data[0] + m.data[7] * v.data[1] + m.data[11] * v.data[2]);
-}
-
 
 void
 MathUtils::rotateMatrix(float angle, const Vuforia::Vec3F& axis, Vuforia::Matrix44F& m)
@@ -846,46 +743,74 @@ MathUtils::rotateMatrix(float angle, const Vuforia::Vec3F& axis, Vuforia::Matrix
 
 
 void
-MathUtils::scaleMatrix(const Vuforia::Vec3F& scale, Vuforia::Matrix44F & m)
+MathUtils::multiplyMatrix(const Vuforia::Matrix44F& matrixA, const Vuforia::Matrix44F& matrixB, Vuforia::Matrix44F& matrixC)
 {
-    //m =  m * scale_m
-    m.data[0] *= scale.data[0];
-    m.data[1] *= scale.data[0];
-    m.data[2] *= scale.data[0];
-    m.data[3] *= scale.data[0];
+    // matrixC= matrixA * matrixB
+#if defined(SIMD_USE_SSE) || defined(SIMD_USE_NEON)
+    multiplyMatrixSIMD(matrixA.data, matrixB.data, matrixC.data);
+#else
+    if (&matrixC != &matrixA && &matrixC != &matrixB)
+    {
+        // No aliasing, write the result straight to the output
+        multiplyMatrixScalar(matrixA.data, matrixB.data, matrixC.data);
+    }
+    else
+    {
+        Vuforia::Matrix44F aTmp;
+        multiplyMatrixScalar(matrixA.data, matrixB.data, aTmp.data);
+        matrixC = aTmp;
+    }
+#endif
+}
 
-    m.data[4] *= scale.data[1];
-    m.data[5] *= scale.data[1];
-    m.data[6] *= scale.data[1];
-    m.data[7] *= scale.data[1];
 
-    m.data[8] *= scale.data[2];
-    m.data[9] *= scale.data[2];
-    m.data[10] *= scale.data[2];
-    m.data[11] *= scale.data[2];
+void
+MathUtils::transformPoints(const Vuforia::Matrix44F& m, const float* in, float* out, size_t n,
+                           size_t inStride, size_t outStride)
+{
+    transformAoS<true>(m.data, in, out, n, inStride, outStride);
 }
 
 
 void
-MathUtils::multiplyMatrix(const Vuforia::Matrix44F& matrixA, const Vuforia::Matrix44F& matrixB, Vuforia::Matrix44F& matrixC)
+MathUtils::transformNormals(const Vuforia::Matrix44F& m, const float* in, float* out, size_t n,
+                            size_t inStride, size_t outStride)
 {
-    int i, j, k;
-    Vuforia::Matrix44F aTmp;
+    transformAoS<false>(m.data, in, out, n, inStride, outStride);
+}
 
-    // matrixC= matrixA * matrixB
-    for (i = 0; i < 4; i++)
-    {
-        for (j = 0; j < 4; j++)
-        {
-            aTmp.data[j * 4 + i] = 0.0;
 
-            for (k = 0; k < 4; k++)
-                aTmp.data[j * 4 + i] += matrixA.data[k * 4 + i] * matrixB.data[j * 4 + k];
-        }
-    }
+void
+MathUtils::transformPointsSoA(const Vuforia::Matrix44F& m,
+                              const float* inX, const float* inY, const float* inZ,
+                              float* outX, float* outY, float* outZ, size_t n)
+{
+    transformSoA<true>(m.data, inX, inY, inZ, outX, outY, outZ, n);
+}
 
-    for (i = 0; i < 16; i++)
-        matrixC.data[i] = aTmp.data[i];
+
+void
+MathUtils::transformNormalsSoA(const Vuforia::Matrix44F& m,
+                               const float* inX, const float* inY, const float* inZ,
+                               float* outX, float* outY, float* outZ, size_t n)
+{
+    transformSoA<false>(m.data, inX, inY, inZ, outX, outY, outZ, n);
+}
+
+
+void
+MathUtils::transformPointsParallel(const Vuforia::Matrix44F& m, const float* in, float* out, size_t n,
+                                   size_t inStride, size_t outStride, unsigned int numThreads)
+{
+    transformAoSParallel<true>(m.data, in, out, n, inStride, outStride, numThreads);
+}
+
+
+void
+MathUtils::transformNormalsParallel(const Vuforia::Matrix44F& m, const float* in, float* out, size_t n,
+                                    size_t inStride, size_t outStride, unsigned int numThreads)
+{
+    transformAoSParallel<false>(m.data, in, out, n, inStride, outStride, numThreads);
 }
 
 
@@ -926,13 +851,28 @@ void
 MathUtils::convertPoseBetweenWorldAndCamera(const Vuforia::Matrix44F& matrixIn, Vuforia::Matrix44F& matrixOut)
 {
     // Transform trackable pose from World Coordinate System to Camera Coordinate System
-    // (180 degree rotation between both CS)
-    Vuforia::Matrix44F convertCS;
-    MathUtils::makeRotationMatrix(180.0f, Vuforia::Vec3F(1.0f, 0.0f, 0.0f), convertCS);
+    // (180 degree rotation between both CS, evaluated at compile time)
+    static constexpr Vuforia::Matrix44F convertCS = SampleMath::ROTATE_180_X;
 
-    Vuforia::Matrix44F tmp;
-    MathUtils::multiplyMatrix(convertCS, matrixIn, tmp);
+    // multiplyMatrix handles matrixIn and matrixOut being the same matrix
+    MathUtils::multiplyMatrix(convertCS, matrixIn, matrixOut);
+}
 
-    for (int i = 0; i < 16; i++)
-        matrixOut.data[i] = tmp.data[i];
+
+Vuforia::Matrix44F
+MathUtils::convertPose2GLMatrix(const Vuforia::Matrix34F& pose)
+{
+    Vuforia::Matrix44F m;
+
+    // Column-major copy of the 3x4 rows, bottom row (0, 0, 0, 1)
+    for (int col = 0; col < 4; col++)
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            m.data[col * 4 + row] = pose.data[row * 4 + col];
+        }
+        m.data[col * 4 + 3] = (col == 3) ? 1.0f : 0.0f;
+    }
+
+    return m;
 }
@@ -8,14 +8,20 @@ countries.
 #ifndef __MATH_UTILS_H__
 #define __MATH_UTILS_H__
 
+#include "MathTypes.h"
+
 #include <Vuforia/Vectors.h>
 #include <Vuforia/Matrices.h>
 
+#include <cstddef>
+
 /// Utility class for Math operations.
 /**
  *
  * Provide a set of linear algebra operations for Vufoira vector and matrix.
  * All 4x4 matrix transformation consider row storage
+ * The simple operations are inline wrappers around the constexpr types in MathTypes.h,
+ * new code can use those types directly.
  */
 class MathUtils
 {
@@ -130,6 +136,19 @@ public:
     /// Computer the inverse of the matrix and return the result ( result = inverse(m) )
     static Vuforia::Matrix44F Matrix44FInverse(const Vuforia::Matrix44F& m);
 
+    /// Compute the inverse of a rigid transform (rotation and translation only) and return the result
+    /// ( result = [R^T | -R^T * t] ). Gives the same result as Matrix44FTranspose(Matrix44FInverse(m)).
+    /// The input is not checked unless MATHUTILS_VALIDATE_RIGID is enabled (default in debug builds).
+    static Vuforia::Matrix44F Matrix44FInverseRigid(const Vuforia::Matrix44F& m);
+
+    /// Compute the inverse of an affine transform (rotation, scale, shear and translation) and return the result
+    /// ( result = [A^-1 | -A^-1 * t] ). Gives the same result as Matrix44FTranspose(Matrix44FInverse(m)).
+    static Vuforia::Matrix44F Matrix44FInverseAffine(const Vuforia::Matrix44F& m);
+
+    /// Check whether the matrix is a rigid transform: orthonormal rotation with determinant +1,
+    /// no projective part. Each element is compared within tolerance.
+    static bool Matrix44FIsRigid(const Vuforia::Matrix44F& m, float tolerance = 1e-3f);
+
     /// Translate the matrix m by a vector v and return the result (post-multiply, result = M * T(trans) )
     static Vuforia::Matrix44F Matrix44FTranslate(const Vuforia::Vec3F& trans, const Vuforia::Matrix44F& m);
 
@@ -201,8 +220,48 @@ public:
     static void scaleMatrix(const Vuforia::Vec3F& scale, Vuforia::Matrix44F& m);
 
     /// Multiply the two matrices A and B and writes the result to C (C = mA*mB)
+    /// Uses SSE or NEON when available, C may be the same matrix as A or B
     static void multiplyMatrix(const Vuforia::Matrix44F& mA, const Vuforia::Matrix44F& mB, Vuforia::Matrix44F& mC);
 
+    // BATCH METHODS (transform whole vertex arrays)
+
+    /// Transform n 3D points by a 4x4 matrix (pre multiply, w = 1, same result as Vec3FTransform for each point)
+    /// Strides are in floats between consecutive points, use 3 for tightly packed xyz.
+    /// in and out may be the same array if the strides are equal.
+    static void transformPoints(const Vuforia::Matrix44F& m, const float* in, float* out, size_t n,
+                                size_t inStride = 3, size_t outStride = 3);
+
+    /// Transform n normals by a 4x4 matrix (rotation only, same result as Vec3FTransformNormal for each normal)
+    /// Strides are in floats between consecutive normals, use 3 for tightly packed xyz.
+    /// in and out may be the same array if the strides are equal.
+    static void transformNormals(const Vuforia::Matrix44F& m, const float* in, float* out, size_t n,
+                                 size_t inStride = 3, size_t outStride = 3);
+
+    /// Transform n 3D points stored as separate x, y and z arrays (pre multiply, w = 1)
+    /// Output arrays may be the same as the input arrays.
+    static void transformPointsSoA(const Vuforia::Matrix44F& m,
+                                   const float* inX, const float* inY, const float* inZ,
+                                   float* outX, float* outY, float* outZ, size_t n);
+
+    /// Transform n normals stored as separate x, y and z arrays (rotation only)
+    /// Output arrays may be the same as the input arrays.
+    static void transformNormalsSoA(const Vuforia::Matrix44F& m,
+                                    const float* inX, const float* inY, const float* inZ,
+                                    float* outX, float* outY, float* outZ, size_t n);
+
+    /// Same as transformPoints, splitting the array across worker threads when n is at least
+    /// PARALLEL_TRANSFORM_THRESHOLD. numThreads = 0 uses the number of hardware threads.
+    static void transformPointsParallel(const Vuforia::Matrix44F& m, const float* in, float* out, size_t n,
+                                        size_t inStride = 3, size_t outStride = 3, unsigned int numThreads = 0);
+
+    /// Same as transformNormals, splitting the array across worker threads when n is at least
+    /// PARALLEL_TRANSFORM_THRESHOLD. numThreads = 0 uses the number of hardware threads.
+    static void transformNormalsParallel(const Vuforia::Matrix44F& m, const float* in, float* out, size_t n,
+                                         size_t inStride = 3, size_t outStride = 3, unsigned int numThreads = 0);
+
+    /// Below this number of elements the parallel transforms run on the calling thread
+    static constexpr size_t PARALLEL_TRANSFORM_THRESHOLD = 64 * 1024;
+
     /// Use the matrix to project the extents of the video background to the viewport
     /// This will generate normalized coordinates (i.e. full viewport has -1,+1 range)
     /// to create a rectangle that can be used to set a scissor on the video background
@@ -212,7 +271,231 @@ public:
 
     /// Convert world pose matrix to camera pose matrix or camera pose matrix to world pose matrix
     static void convertPoseBetweenWorldAndCamera(const Vuforia::Matrix44F& matrixIn, Vuforia::Matrix44F& matrixOut);
+
+    /// Convert a Vuforia 3x4 row-major pose to a GL-style 4x4 matrix
+    /// Same result as Vuforia::Tool::convertPose2GLMatrix but does not need the Vuforia engine.
+    static Vuforia::Matrix44F convertPose2GLMatrix(const Vuforia::Matrix34F& pose);
 };
 
+// INLINE DEFINITIONS (thin wrappers around SampleMath)
+
+inline Vuforia::Vec2F
+MathUtils::Vec2FZero()
+{
+    return SampleMath::Vec2(0.0f, 0.0f);
+}
+
+inline Vuforia::Vec2F
+MathUtils::Vec2FUnit()
+{
+    return SampleMath::Vec2(1.0f, 1.0f);
+}
+
+inline Vuforia::Vec2F
+MathUtils::Vec2FOpposite(const Vuforia::Vec2F& v)
+{
+    return -SampleMath::Vec2(v);
+}
+
+inline Vuforia::Vec2F
+MathUtils::Vec2FAdd(const Vuforia::Vec2F& v1, const Vuforia::Vec2F& v2)
+{
+    return SampleMath::Vec2(v1) + SampleMath::Vec2(v2);
+}
+
+inline Vuforia::Vec2F
+MathUtils::Vec2FSub(const Vuforia::Vec2F& v1, const Vuforia::Vec2F& v2)
+{
+    return SampleMath::Vec2(v1) - SampleMath::Vec2(v2);
+}
+
+inline float
+MathUtils::Vec2FDist(const Vuforia::Vec2F& v1, const Vuforia::Vec2F& v2)
+{
+    return SampleMath::distance(v1, v2);
+}
+
+inline Vuforia::Vec2F
+MathUtils::Vec2FScale(const Vuforia::Vec2F& v, float s)
+{
+    return SampleMath::Vec2(v) * s;
+}
+
+inline float
+MathUtils::Vec2FNorm(const Vuforia::Vec2F& v)
+{
+    return SampleMath::length(v);
+}
+
+inline Vuforia::Vec3F
+MathUtils::Vec3FZero()
+{
+    return SampleMath::Vec3(0.0f, 0.0f, 0.0f);
+}
+
+inline Vuforia::Vec3F
+MathUtils::Vec3FUnit()
+{
+    return SampleMath::Vec3(1.0f, 1.0f, 1.0f);
+}
+
+inline Vuforia::Vec3F
+MathUtils::Vec3FOpposite(const Vuforia::Vec3F& v)
+{
+    return -SampleMath::Vec3(v);
+}
+
+inline Vuforia::Vec3F
+MathUtils::Vec3FAdd(const Vuforia::Vec3F& v1, const Vuforia::Vec3F& v2)
+{
+    return SampleMath::Vec3(v1) + SampleMath::Vec3(v2);
+}
+
+inline Vuforia::Vec3F
+MathUtils::Vec3FSub(const Vuforia::Vec3F& v1, const Vuforia::Vec3F& v2)
+{
+    return SampleMath::Vec3(v1) - SampleMath::Vec3(v2);
+}
+
+inline float
+MathUtils::Vec3FDist(const Vuforia::Vec3F& v1, const Vuforia::Vec3F& v2)
+{
+    return SampleMath::distance(v1, v2);
+}
+
+inline Vuforia::Vec3F
+MathUtils::Vec3FScale(const Vuforia::Vec3F& v, float s)
+{
+    return SampleMath::Vec3(v) * s;
+}
+
+inline float
+MathUtils::Vec3FDot(const Vuforia::Vec3F& v1, const Vuforia::Vec3F& v2)
+{
+    return SampleMath::dot(v1, v2);
+}
+
+inline Vuforia::Vec3F
+MathUtils::Vec3FCross(const Vuforia::Vec3F& v1, const Vuforia::Vec3F& v2)
+{
+    return SampleMath::cross(v1, v2);
+}
+
+inline Vuforia::Vec3F
+MathUtils::Vec3FNormalize(const Vuforia::Vec3F& v)
+{
+    return SampleMath::normalize(v);
+}
+
+inline Vuforia::Vec3F
+MathUtils::Vec3FTransform(const Vuforia::Matrix44F& m, const Vuforia::Vec3F& v)
+{
+    return SampleMath::transformPoint(m, v);
+}
+
+inline Vuforia::Vec3F
+MathUtils::Vec3FTransformNormal(const Vuforia::Matrix44F& m, const Vuforia::Vec3F& v)
+{
+    return SampleMath::transformNormal(m, v);
+}
+
+inline float
+MathUtils::Vec3FNorm(const Vuforia::Vec3F& v)
+{
+    return SampleMath::length(v);
+}
+
+inline Vuforia::Vec4F
+MathUtils::Vec4FZero()
+{
+    return SampleMath::Vec4(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+inline Vuforia::Vec4F
+MathUtils::Vec4FUnit()
+{
+    return SampleMath::Vec4(1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+inline Vuforia::Vec4F
+MathUtils::Vec4FScale(const Vuforia::Vec4F& v, float s)
+{
+    return SampleMath::Vec4(v) * s;
+}
+
+inline Vuforia::Vec4F
+MathUtils::Vec4FTransform(const Vuforia::Matrix44F& m, const Vuforia::Vec4F& v)
+{
+    return SampleMath::Mat4(m) * SampleMath::Vec4(v);
+}
+
+inline Vuforia::Vec4F
+MathUtils::Vec4FTransformR(const Vuforia::Vec4F& v, const Vuforia::Matrix44F& m)
+{
+    return SampleMath::Vec4(v) * SampleMath::Mat4(m);
+}
+
+inline Vuforia::Matrix34F
+MathUtils::Matrix34FIdentity()
+{
+    return Vuforia::Matrix34F{ { 1.0f, 0.0f, 0.0f, 0.0f,
+                                 0.0f, 1.0f, 0.0f, 0.0f,
+                                 0.0f, 0.0f, 1.0f, 0.0f } };
+}
+
+inline Vuforia::Matrix44F
+MathUtils::Matrix44FIdentity()
+{
+    return SampleMath::identity();
+}
+
+inline Vuforia::Matrix44F
+MathUtils::Matrix44FTranspose(const Vuforia::Matrix44F& m)
+{
+    return SampleMath::transpose(m);
+}
+
+inline Vuforia::Matrix44F
+MathUtils::Matrix44FTranslate(const Vuforia::Vec3F& trans, const Vuforia::Matrix44F& m)
+{
+    return SampleMath::translated(m, trans);
+}
+
+inline Vuforia::Matrix44F
+MathUtils::Matrix44FScale(const Vuforia::Vec3F& scale, const Vuforia::Matrix44F& m)
+{
+    return SampleMath::scaled(m, scale);
+}
+
+inline Vuforia::Matrix44F
+MathUtils::copyMatrix(const Vuforia::Matrix44F& m)
+{
+    return m;
+}
+
+inline void
+MathUtils::makeTranslationMatrix(const Vuforia::Vec3F& v, Vuforia::Matrix44F& m)
+{
+    m = SampleMath::translation(v);
+}
+
+inline void
+MathUtils::makeScalingMatrix(const Vuforia::Vec3F& scale, Vuforia::Matrix44F& m)
+{
+    m = SampleMath::scaling(scale);
+}
+
+inline void
+MathUtils::translateMatrix(const Vuforia::Vec3F& v, Vuforia::Matrix44F& m)
+{
+    m = SampleMath::translated(m, v);
+}
+
+inline void
+MathUtils::scaleMatrix(const Vuforia::Vec3F& scale, Vuforia::Matrix44F& m)
+{
+    m = SampleMath::scaled(m, scale);
+}
+
 
 #endif  // __MATH_UTILS_H__
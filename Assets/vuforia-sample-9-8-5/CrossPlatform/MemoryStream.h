@@ -8,10 +8,25 @@ countries.
 #ifndef __MEMORY_STREAM_H__
 #define __MEMORY_STREAM_H__
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <istream>
 #include <streambuf>
+#include <string_view>
+#include <type_traits>
 
-/// streambuf implementation where the buffer is in memory
+/// True if the host stores integers and floats little endian
+inline bool isLittleEndianHost()
+{
+    const std::uint16_t one = 1;
+    unsigned char low;
+    std::memcpy(&low, &one, 1);
+    return low == 1;
+}
+
+/// streambuf implementation where the buffer is in memory. Supports seeking, and
+/// bulk reads copy straight out of the buffer.
 class MemoryStreamBuf : public std::streambuf
 {
 public:
@@ -20,6 +35,58 @@ public:
         char* p(const_cast<char*>(base));
         this->setg(p, p, p + size);
     }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which = std::ios_base::in) override
+    {
+        if ((which & std::ios_base::in) == 0)
+        {
+            return pos_type(off_type(-1));
+        }
+
+        off_type origin = 0;
+        if (dir == std::ios_base::cur)
+        {
+            origin = gptr() - eback();
+        }
+        else if (dir == std::ios_base::end)
+        {
+            origin = egptr() - eback();
+        }
+
+        // Written so that neither sum can overflow
+        const off_type size = egptr() - eback();
+        if ((off < 0 && -off > origin) || (off > 0 && off > size - origin))
+        {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + (origin + off), egptr());
+        return pos_type(origin + off);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override
+    {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+
+    std::streamsize xsgetn(char_type* s, std::streamsize count) override
+    {
+        std::streamsize n = std::min<std::streamsize>(std::max<std::streamsize>(count, 0), egptr() - gptr());
+        if (n > 0)
+        {
+            std::memcpy(s, gptr(), static_cast<size_t>(n));
+            // setg, gbump takes an int
+            setg(eback(), gptr() + n, egptr());
+        }
+        return n;
+    }
+
+    std::streamsize showmanyc() override
+    {
+        // Only called once the buffer is used up, there is nothing behind it
+        return gptr() < egptr() ? egptr() - gptr() : -1;
+    }
 };
 
 /// istream implementation to read from a buffer in memory
@@ -31,4 +98,110 @@ public:
         , std::istream(static_cast<std::streambuf*>(this)) {}
 };
 
+/// Bounds checked reader of little endian binary data in memory, without the
+/// istream overhead. A read that does not fit in the rest of the data returns
+/// false and leaves the position where it was.
+class ByteReader
+{
+public:
+    ByteReader(char const* base, size_t size)
+        : mBase(base), mSize(size) {}
+
+    size_t getSize() const { return mSize; }
+    size_t getPosition() const { return mPosition; }
+    size_t getRemaining() const { return mSize - mPosition; }
+
+    /// Move to position, which may be the end of the data
+    bool seek(size_t position)
+    {
+        if (position > mSize)
+        {
+            return false;
+        }
+        mPosition = position;
+        return true;
+    }
+
+    bool skip(size_t count)
+    {
+        if (count > getRemaining())
+        {
+            return false;
+        }
+        mPosition += count;
+        return true;
+    }
+
+    /// Read an integer, float or enum stored little endian
+    template <typename T>
+    bool read(T& value)
+    {
+        return readArray(&value, 1);
+    }
+
+    /// Read count values stored little endian into values
+    template <typename T>
+    bool readArray(T* values, size_t count)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                      "ByteReader reads integers, floats and enums");
+        if (count > getRemaining() / sizeof(T))
+        {
+            return false;
+        }
+
+        const char* data = mBase + mPosition;
+        if (isLittleEndianHost())
+        {
+            std::memcpy(values, data, count * sizeof(T));
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                char bytes[sizeof(T)];
+                std::reverse_copy(data + i * sizeof(T), data + (i + 1) * sizeof(T), bytes);
+                std::memcpy(&values[i], bytes, sizeof(T));
+            }
+        }
+        mPosition += count * sizeof(T);
+        return true;
+    }
+
+    /// The next size bytes, without copying. The view points into the data.
+    bool readView(size_t size, std::string_view& view)
+    {
+        if (size > getRemaining())
+        {
+            return false;
+        }
+        view = std::string_view(mBase + mPosition, size);
+        mPosition += size;
+        return true;
+    }
+
+    /// The next count values stored little endian, without copying. Fails unless they
+    /// are aligned for T and the host is little endian, callers then fall back to
+    /// readArray.
+    template <typename T>
+    bool readView(size_t count, const T*& values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ByteReader views raw bytes");
+        const char* data = mBase + mPosition;
+        if (count > getRemaining() / sizeof(T) || !isLittleEndianHost() ||
+            reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0)
+        {
+            return false;
+        }
+        values = reinterpret_cast<const T*>(data);
+        mPosition += count * sizeof(T);
+        return true;
+    }
+
+private:
+    const char* mBase;
+    size_t mSize;
+    size_t mPosition = 0;
+};
+
 #endif // __MEMORY_STREAM_H__
@@ -0,0 +1,444 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshBuilder.h"
+
+#include "tiny_obj_loader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+
+namespace
+{
+    /// Marks a missing index and the end of a vertex chain
+    constexpr std::uint32_t EMPTY_SLOT = std::numeric_limits<std::uint32_t>::max();
+
+    /// A unique (vertex, texture coordinate) index pair of an OBJ model, one vertex of the mesh
+    struct ObjVertex
+    {
+        /// Texture coordinate index, EMPTY_SLOT if the corners have none
+        std::uint32_t texcoord;
+        /// Next vertex with the same position, EMPTY_SLOT at the end of the chain
+        std::uint32_t next;
+    };
+    // The fill pass keeps the vertices in the texcoord of the mesh vertices
+    static_assert(sizeof(ObjVertex) == sizeof(MeshVertex::texcoord), "ObjVertex must fit in MeshVertex::texcoord");
+
+    /// What buildFromObj keeps between the tinyobj callbacks
+    struct ObjStream
+    {
+        bool fillPass = false;
+        bool failed = false;
+        std::string error;
+
+        /// v and vt lines read so far in this pass, relative indices count back from them
+        std::uint32_t numPositions = 0;
+        std::uint32_t numTexcoords = 0;
+        /// One past the largest vertex and texture coordinate index used, checked once all
+        /// lines are read. The vertex indices are also the size of firstVertex.
+        std::uint32_t texcoordEnd = 0;
+        size_t numCorners = 0;
+        size_t numTriangles = 0;
+
+        /// First vertex of every position, EMPTY_SLOT for unused positions.
+        /// The vertices at a position are chained through ObjVertex::next.
+        std::vector<std::uint32_t> firstVertex;
+        /// Count pass: the unique vertices, in the order of their first corner. The fill pass
+        /// reads them from the texcoord of the mesh vertices instead, see getObjVertex.
+        std::vector<ObjVertex> vertices;
+
+        /// Materials by name, in the order of their first usemtl line, and the current one
+        std::unordered_map<std::string, std::int32_t> materialNames;
+        std::int32_t material = -1;
+        /// Smoothing group of the s line before the current face, 0 before any. Count pass:
+        /// whether the model has any s lines.
+        std::uint32_t smoothingGroup = 0;
+        bool hasSmoothingGroups = false;
+
+        /// Count pass: material and smoothing group runs of the triangles, null if not requested
+        std::vector<TriangleRun<std::int32_t>>* materialRuns = nullptr;
+        std::vector<TriangleRun<std::uint32_t>>* smoothingGroupRuns = nullptr;
+
+        /// Fill pass: texture coordinates of the vt lines, already flipped for DirectX
+        std::vector<float> texcoords;
+        Mesh* mesh = nullptr;
+        size_t numIndices = 0;
+    };
+
+    void fail(ObjStream& stream, const char* message)
+    {
+        if (!stream.failed)
+        {
+            stream.failed = true;
+            stream.error = message;
+        }
+    }
+
+    /// Zero based index of a one based or relative OBJ index, EMPTY_SLOT if it is not given
+    /// (0) or before the first line
+    std::uint32_t resolveObjIndex(int index, std::uint32_t numDefined)
+    {
+        if (index > 0)
+        {
+            return static_cast<std::uint32_t>(index - 1);
+        }
+        if (index < 0 && std::uint32_t(-std::int64_t(index)) <= numDefined)
+        {
+            return static_cast<std::uint32_t>(numDefined + std::int64_t(index));
+        }
+        return EMPTY_SLOT;
+    }
+
+    /// Vertex v found by the count pass. Between the passes the vertices move into the
+    /// texcoord of the mesh vertices, which they hold until the texture coordinates are
+    /// resolved, so the fill pass needs no array of its own for them.
+    ObjVertex getObjVertex(const ObjStream& stream, std::uint32_t v)
+    {
+        if (!stream.fillPass)
+        {
+            return stream.vertices[v];
+        }
+        ObjVertex vertex;
+        std::memcpy(&vertex, stream.mesh->vertices[v].texcoord, sizeof(vertex));
+        return vertex;
+    }
+
+    /// The vertex of position and texcoord, created in the count pass if it is new
+    std::uint32_t findObjVertex(ObjStream& stream, std::uint32_t position, std::uint32_t texcoord)
+    {
+        std::uint32_t last = EMPTY_SLOT;
+        for (std::uint32_t v = stream.firstVertex[position]; v != EMPTY_SLOT;)
+        {
+            ObjVertex vertex = getObjVertex(stream, v);
+            if (vertex.texcoord == texcoord)
+            {
+                return v;
+            }
+            last = v;
+            v = vertex.next;
+        }
+
+        if (stream.fillPass || stream.vertices.size() >= EMPTY_SLOT - 1)
+        {
+            return EMPTY_SLOT;
+        }
+        auto vertex = static_cast<std::uint32_t>(stream.vertices.size());
+        if (last == EMPTY_SLOT)
+        {
+            stream.firstVertex[position] = vertex;
+        }
+        else
+        {
+            stream.vertices[last].next = vertex;
+        }
+        stream.vertices.push_back({ texcoord, EMPTY_SLOT });
+        return vertex;
+    }
+
+    /// Start a run at firstTriangle if value differs from the last run
+    template <typename T>
+    void extendRuns(std::vector<TriangleRun<T>>* runs, size_t firstTriangle, T value)
+    {
+        if (runs != nullptr && (runs->empty() || runs->back().value != value))
+        {
+            runs->push_back({ static_cast<std::uint32_t>(firstTriangle), value });
+        }
+    }
+
+    void objVertexCallback(void* userData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z, tinyobj::real_t)
+    {
+        auto& stream = *static_cast<ObjStream*>(userData);
+        std::uint32_t position = stream.numPositions++;
+        if (!stream.fillPass || stream.failed || position >= stream.firstVertex.size() ||
+            stream.firstVertex[position] == EMPTY_SLOT)
+        {
+            return;
+        }
+
+        // Every vertex at this position gets it, the bounds only cover used positions
+        Mesh& mesh = *stream.mesh;
+        const float pos[3] = { x, y, z };
+        for (std::uint32_t v = stream.firstVertex[position]; v != EMPTY_SLOT; v = getObjVertex(stream, v).next)
+        {
+            std::copy(pos, pos + 3, mesh.vertices[v].pos);
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            mesh.boundsMin[c] = std::min(mesh.boundsMin[c], pos[c]);
+            mesh.boundsMax[c] = std::max(mesh.boundsMax[c], pos[c]);
+        }
+    }
+
+    void objTexcoordCallback(void* userData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t)
+    {
+        auto& stream = *static_cast<ObjStream*>(userData);
+        std::uint32_t texcoord = stream.numTexcoords++;
+        if (stream.fillPass && !stream.failed)
+        {
+            stream.texcoords[2 * size_t(texcoord) + 0] = x;
+            stream.texcoords[2 * size_t(texcoord) + 1] = 1.0f - y; // vertical flip, convert GL to DX
+        }
+    }
+
+    void objFaceCallback(void* userData, tinyobj::index_t* corners, int numCorners)
+    {
+        auto& stream = *static_cast<ObjStream*>(userData);
+        if (stream.failed)
+        {
+            return;
+        }
+
+        std::uint32_t first = EMPTY_SLOT;
+        std::uint32_t previous = EMPTY_SLOT;
+        for (int i = 0; i < numCorners; i++)
+        {
+            // A position may be used before its v line, the first pass grows firstVertex for it
+            std::uint32_t position = resolveObjIndex(corners[i].vertex_index, stream.numPositions);
+            if (position == EMPTY_SLOT)
+            {
+                fail(stream, "Face vertex index out of range");
+                return;
+            }
+            if (position >= stream.firstVertex.size())
+            {
+                if (stream.fillPass || position >= EMPTY_SLOT - 1)
+                {
+                    fail(stream, "Face vertex index out of range");
+                    return;
+                }
+                stream.firstVertex.resize(size_t(position) + 1, EMPTY_SLOT);
+            }
+
+            std::uint32_t texcoord = EMPTY_SLOT;
+            if (corners[i].texcoord_index != 0)
+            {
+                texcoord = resolveObjIndex(corners[i].texcoord_index, stream.numTexcoords);
+                if (texcoord == EMPTY_SLOT)
+                {
+                    fail(stream, "Face texture coordinate index out of range");
+                    return;
+                }
+                stream.texcoordEnd = std::max(stream.texcoordEnd, texcoord + 1);
+            }
+
+            std::uint32_t vertex = findObjVertex(stream, position, texcoord);
+            if (vertex == EMPTY_SLOT)
+            {
+                fail(stream, "Too many vertices");
+                return;
+            }
+
+            // The count pass only counts the triangles, the fill pass writes the fan
+            if (i >= 2 && stream.fillPass)
+            {
+                Mesh& mesh = *stream.mesh;
+                size_t n = stream.numIndices;
+                if (!mesh.indices16.empty())
+                {
+                    mesh.indices16[n + 0] = static_cast<std::uint16_t>(first);
+                    mesh.indices16[n + 1] = static_cast<std::uint16_t>(previous);
+                    mesh.indices16[n + 2] = static_cast<std::uint16_t>(vertex);
+                }
+                else
+                {
+                    mesh.indices32[n + 0] = first;
+                    mesh.indices32[n + 1] = previous;
+                    mesh.indices32[n + 2] = vertex;
+                }
+                stream.numIndices = n + 3;
+            }
+            if (i == 0)
+            {
+                first = vertex;
+            }
+            previous = vertex;
+        }
+
+        if (numCorners >= 3 && !stream.fillPass)
+        {
+            extendRuns(stream.materialRuns, stream.numTriangles, stream.material);
+            extendRuns(stream.smoothingGroupRuns, stream.numTriangles, stream.smoothingGroup);
+        }
+        stream.numCorners += size_t(numCorners);
+        stream.numTriangles += numCorners >= 3 ? size_t(numCorners) - 2 : 0;
+    }
+
+    void objMaterialCallback(void* userData, const char* name, int)
+    {
+        // Numbered the same way in both passes
+        auto& stream = *static_cast<ObjStream*>(userData);
+        auto material = stream.materialNames.emplace(name, static_cast<std::int32_t>(stream.materialNames.size()));
+        stream.material = material.first->second;
+    }
+
+    void objSmoothingGroupCallback(void* userData, unsigned int smoothingGroup)
+    {
+        auto& stream = *static_cast<ObjStream*>(userData);
+        stream.smoothingGroup = smoothingGroup;
+        stream.hasSmoothingGroups = true;
+    }
+
+    /// Run one pass of buildFromObj over the OBJ text
+    bool streamObj(const char* data, size_t size, ObjStream& stream, std::string* err)
+    {
+        tinyobj::callback_t callback;
+        callback.vertex_cb = objVertexCallback;
+        callback.texcoord_cb = objTexcoordCallback;
+        callback.index_cb = objFaceCallback;
+        callback.usemtl_cb = objMaterialCallback;
+        callback.smoothing_group_cb = objSmoothingGroupCallback;
+
+        stream.numPositions = 0;
+        stream.numTexcoords = 0;
+        stream.material = -1;
+        stream.smoothingGroup = 0;
+        stream.numCorners = 0;
+        stream.numTriangles = 0;
+
+        std::string loaderError;
+        if (!tinyobj::LoadObjFromBufferWithCallback(data, size, callback, &stream, nullptr, nullptr, &loaderError))
+        {
+            fail(stream, loaderError.c_str());
+        }
+        if (stream.failed && err != nullptr)
+        {
+            *err = stream.error;
+        }
+        return !stream.failed;
+    }
+
+    template <typename T>
+    size_t getCapacityBytes(const std::vector<T>& v)
+    {
+        return v.capacity() * sizeof(T);
+    }
+}
+
+
+bool
+MeshBuilder::buildFromObj(const char* data, size_t size, Mesh& mesh, MeshBuildStats* stats, std::string* err,
+                          std::vector<TriangleRun<std::int32_t>>* materialRuns,
+                          std::vector<TriangleRun<std::uint32_t>>* smoothingGroupRuns)
+{
+    mesh.vertices.clear();
+    mesh.indices16.clear();
+    mesh.indices32.clear();
+    mesh.lods.clear();
+    mesh.submeshes.clear();
+    mesh.normals.clear();
+    mesh.tangents.clear();
+
+    // Count pass: find the unique vertices, count the triangles and collect their runs
+    ObjStream stream;
+    if (materialRuns != nullptr)
+    {
+        materialRuns->clear();
+        stream.materialRuns = materialRuns;
+    }
+    if (smoothingGroupRuns != nullptr)
+    {
+        smoothingGroupRuns->clear();
+        stream.smoothingGroupRuns = smoothingGroupRuns;
+    }
+    if (!streamObj(data, size, stream, err))
+    {
+        return false;
+    }
+    if (stream.firstVertex.size() > stream.numPositions || stream.texcoordEnd > stream.numTexcoords)
+    {
+        if (err != nullptr)
+        {
+            *err = "Face index out of range";
+        }
+        return false;
+    }
+    if (stream.numTriangles == 0 || stream.numTriangles > std::numeric_limits<std::uint32_t>::max())
+    {
+        if (err != nullptr)
+        {
+            *err = stream.numTriangles == 0 ? "No triangles" : "Too many triangles";
+        }
+        return false;
+    }
+    if (smoothingGroupRuns != nullptr && !stream.hasSmoothingGroups)
+    {
+        smoothingGroupRuns->clear();
+    }
+    stream.firstVertex.shrink_to_fit();
+    const size_t runBytes = (materialRuns != nullptr ? getCapacityBytes(*materialRuns) : 0) +
+                            (smoothingGroupRuns != nullptr ? getCapacityBytes(*smoothingGroupRuns) : 0);
+
+    // Move the vertices into the mesh, they hold the texcoord slots until the fill pass is done
+    const size_t numVertices = stream.vertices.size();
+    const size_t numCorners = stream.numCorners;
+    mesh.vertices.resize(numVertices);
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        std::memcpy(mesh.vertices[i].texcoord, &stream.vertices[i], sizeof(ObjVertex));
+    }
+    const size_t movePeakBytes = getCapacityBytes(stream.firstVertex) + getCapacityBytes(stream.vertices) +
+                                 getCapacityBytes(mesh.vertices) + runBytes;
+    std::vector<ObjVertex>().swap(stream.vertices);
+
+    // Fill pass: every array at its final size
+    const float maxFloat = std::numeric_limits<float>::max();
+    mesh.boundsMin = SampleMath::Vec3(maxFloat, maxFloat, maxFloat);
+    mesh.boundsMax = SampleMath::Vec3(-maxFloat, -maxFloat, -maxFloat);
+    if (numVertices <= 0x10000)
+    {
+        mesh.indices16.resize(3 * stream.numTriangles);
+    }
+    else
+    {
+        mesh.indices32.resize(3 * stream.numTriangles);
+    }
+    stream.texcoords.resize(2 * size_t(stream.numTexcoords));
+    stream.mesh = &mesh;
+    stream.fillPass = true;
+    if (!streamObj(data, size, stream, err))
+    {
+        return false;
+    }
+
+    // The texture coordinates may come after the faces, so they are only resolved now,
+    // replacing the vertices in the texcoord slots
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        std::uint32_t texcoord = getObjVertex(stream, static_cast<std::uint32_t>(i)).texcoord;
+        MeshVertex& vertex = mesh.vertices[i];
+        if (texcoord == EMPTY_SLOT)
+        {
+            vertex.texcoord[0] = 0.0f;
+            vertex.texcoord[1] = 0.0f;
+        }
+        else
+        {
+            vertex.texcoord[0] = stream.texcoords[2 * size_t(texcoord) + 0];
+            vertex.texcoord[1] = stream.texcoords[2 * size_t(texcoord) + 1];
+        }
+    }
+
+    if (stats != nullptr)
+    {
+        stats->cornerCount = numCorners;
+        stats->vertexCount = numVertices;
+        stats->outputBytes = getCapacityBytes(mesh.vertices) + getCapacityBytes(mesh.indices16) +
+                             getCapacityBytes(mesh.indices32);
+        // The most is held either while the vertices move into the mesh or at the end of the
+        // fill pass
+        const size_t fillPeakBytes = stats->outputBytes + getCapacityBytes(stream.firstVertex) +
+                                     getCapacityBytes(stream.texcoords) + runBytes;
+        stats->peakBytes = std::max(movePeakBytes, fillPeakBytes);
+    }
+
+    return true;
+}
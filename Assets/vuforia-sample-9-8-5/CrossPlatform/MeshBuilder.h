@@ -0,0 +1,68 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_BUILDER_H__
+#define __MESH_BUILDER_H__
+
+#include "MeshCache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/// Result of MeshBuilder::buildFromObj
+struct MeshBuildStats
+{
+    /// Face corners in the OBJ model, the vertex count of a non-indexed mesh
+    size_t cornerCount = 0;
+    /// Unique vertices in the built mesh
+    size_t vertexCount = 0;
+    /// Bytes of the vertices and indices of the built mesh
+    size_t outputBytes = 0;
+    /// Most bytes held at once by buildFromObj, the output included, not counting the
+    /// OBJ text
+    size_t peakBytes = 0;
+
+    /// How many corners share each vertex on average
+    float getDedupRatio() const { return vertexCount > 0 ? float(cornerCount) / float(vertexCount) : 0.0f; }
+};
+
+/// Builds indexed meshes from OBJ models
+/**
+ * Face corners with the same (vertex, texture coordinate) index pair become one vertex, so
+ * shared vertices are stored and transformed once. Vertices are emitted in the order of
+ * their first corner, which keeps the index stream local for the vertex cache. Indices are
+ * 16 bit if the mesh has at most 65536 vertices.
+ * The OBJ text is streamed through the tinyobj callback API in two passes: the first finds
+ * the unique vertices and counts the triangles, the second fills vertex and index arrays
+ * allocated once at their final size. The model is never held as a tinyobj::attrib_t and
+ * shapes, and the vertices found by the first pass wait in the texture coordinates of the
+ * mesh vertices during the second, so building needs little more memory than the mesh. The vertices of a position
+ * are chained, finding the vertex of a corner walks the few vertices of its position
+ * while the text is parsed, so there is no separate hashing step to spread over threads.
+ */
+namespace MeshBuilder
+{
+    /// Build mesh from the text of an OBJ model, data does not need to be null-terminated.
+    /// Corners with the same (vertex, texture coordinate) index pair become one vertex,
+    /// the normals are not part of a MeshVertex. Faces are triangulated as fans, missing
+    /// texture coordinates are set to 0,0.
+    /// If materialRuns is not null it receives the material runs of the triangles, for
+    /// MeshPartitioner. The MTL files are not read, so materials are numbered by their
+    /// first usemtl line; faces before any usemtl have material -1.
+    /// If smoothingGroupRuns is not null it receives the s group runs of the triangles, for
+    /// MeshNormals, 0 before any s line. It is left empty if the model has no s lines.
+    /// Returns false, with the reason in err, if the model does not parse, has indices out
+    /// of range, or has no triangles.
+    bool buildFromObj(const char* data, size_t size, Mesh& mesh, MeshBuildStats* stats = nullptr,
+                      std::string* err = nullptr, std::vector<TriangleRun<std::int32_t>>* materialRuns = nullptr,
+                      std::vector<TriangleRun<std::uint32_t>>* smoothingGroupRuns = nullptr);
+}
+
+#endif // __MESH_BUILDER_H__
@@ -0,0 +1,490 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshCache.h"
+
+#include "Log.h"
+#include "MemoryStream.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+    /// Identifies the file type, "VMSH"
+    constexpr std::uint32_t CACHE_MAGIC = 0x48534D56;
+    /// Increment when the layout of the header, of MeshVertex, of MeshLod or of Submesh changes
+    constexpr std::uint32_t CACHE_VERSION = 4;
+
+    /// Alignment of the vertex and index arrays in the file
+    constexpr std::uint64_t CACHE_ALIGNMENT = 16;
+
+    struct CacheHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t sourceHash;
+        /// sizeof(MeshVertex), catches caches from builds with a different layout
+        std::uint32_t vertexStride;
+        std::uint32_t vertexCount;
+        /// 2 or 4, or 0 for a non-indexed mesh
+        std::uint32_t indexSize;
+        std::uint32_t indexCount;
+        std::uint64_t vertexOffset;
+        std::uint64_t indexOffset;
+        std::uint32_t lodCount;
+        std::uint32_t submeshCount;
+        std::uint64_t lodOffset;
+        std::uint64_t submeshOffset;
+        /// vertexCount, or 0 for a mesh without normals
+        std::uint32_t normalCount;
+        std::uint32_t reserved;
+        std::uint64_t normalOffset;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    static_assert(std::is_trivially_copyable<CacheHeader>::value, "CacheHeader is written as raw bytes");
+    static_assert(sizeof(CacheHeader) == 10 * sizeof(std::uint32_t) + 6 * sizeof(std::uint64_t) + 6 * sizeof(float),
+                  "CacheHeader has no padding, it is read back field by field");
+
+    /// Read the fields of header in the order they are written
+    bool readHeader(ByteReader& in, CacheHeader& header)
+    {
+        return in.read(header.magic) && in.read(header.version) && in.read(header.sourceHash) &&
+               in.read(header.vertexStride) && in.read(header.vertexCount) && in.read(header.indexSize) &&
+               in.read(header.indexCount) && in.read(header.vertexOffset) && in.read(header.indexOffset) &&
+               in.read(header.lodCount) && in.read(header.submeshCount) && in.read(header.lodOffset) &&
+               in.read(header.submeshOffset) && in.read(header.normalCount) && in.read(header.reserved) &&
+               in.read(header.normalOffset) && in.readArray(header.boundsMin, 3) && in.readArray(header.boundsMax, 3);
+    }
+
+    /// View count elements at offset, null if count is 0
+    template <typename T>
+    bool viewArray(ByteReader& in, std::uint64_t offset, std::uint32_t count, const T*& values)
+    {
+        values = nullptr;
+        return count == 0 || (in.seek(static_cast<size_t>(offset)) && in.readView(count, values));
+    }
+
+    constexpr std::uint64_t align(std::uint64_t offset)
+    {
+        return (offset + CACHE_ALIGNMENT - 1) & ~(CACHE_ALIGNMENT - 1);
+    }
+
+    /// True if count elements of elementSize bytes at offset lie between begin and fileSize.
+    /// end receives offset + count * elementSize. Safe against overflow for any header values.
+    bool fitsInFile(std::uint64_t begin, std::uint64_t offset, std::uint32_t count, std::uint32_t elementSize,
+                    std::uint64_t fileSize, std::uint64_t& end)
+    {
+        // count * elementSize fits in 64 bits, both are 32 bit
+        std::uint64_t size = std::uint64_t(count) * elementSize;
+        if (offset < begin || offset > fileSize || size > fileSize - offset)
+        {
+            return false;
+        }
+        end = offset + size;
+        return true;
+    }
+
+    bool writePadding(std::FILE* file, std::uint64_t from, std::uint64_t to)
+    {
+        static const unsigned char zeros[CACHE_ALIGNMENT] = {};
+        size_t count = static_cast<size_t>(to - from);
+        return count == 0 || std::fwrite(zeros, 1, count, file) == count;
+    }
+}
+
+
+/*===============================================================================
+MeshCache
+===============================================================================*/
+
+std::uint64_t
+MeshCache::hash(const void* data, size_t size, std::uint64_t seed)
+{
+    // FNV-1a, eight bytes at a time
+    constexpr std::uint64_t PRIME = 0x100000001B3ULL;
+    std::uint64_t h = 0xCBF29CE484222325ULL ^ seed;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (; size >= 8; bytes += 8, size -= 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes, 8);
+        h = (h ^ word) * PRIME;
+        h ^= h >> 32;
+    }
+    for (; size > 0; bytes++, size--)
+    {
+        h = (h ^ *bytes) * PRIME;
+    }
+    return h;
+}
+
+
+bool
+MeshCache::write(const std::string& path, const Mesh& mesh, std::uint64_t sourceHash)
+{
+    if (mesh.vertices.size() > std::numeric_limits<std::uint32_t>::max() ||
+        mesh.getIndexCount() > std::numeric_limits<std::uint32_t>::max() ||
+        mesh.lods.size() > std::numeric_limits<std::uint32_t>::max() ||
+        mesh.submeshes.size() > std::numeric_limits<std::uint32_t>::max() ||
+        (!mesh.normals.empty() && mesh.normals.size() != mesh.vertices.size()))
+    {
+        LOG("Mesh too large for the mesh cache");
+        return false;
+    }
+
+    CacheHeader header = {};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.sourceHash = sourceHash;
+    header.vertexStride = static_cast<std::uint32_t>(sizeof(MeshVertex));
+    header.vertexCount = static_cast<std::uint32_t>(mesh.vertices.size());
+    header.indexCount = static_cast<std::uint32_t>(mesh.getIndexCount());
+    header.indexSize = mesh.getIndexSize();
+    header.vertexOffset = align(sizeof(CacheHeader));
+    header.indexOffset = align(header.vertexOffset + std::uint64_t(header.vertexCount) * header.vertexStride);
+    header.lodCount = static_cast<std::uint32_t>(mesh.lods.size());
+    header.lodOffset = align(header.indexOffset + std::uint64_t(header.indexCount) * header.indexSize);
+    header.submeshCount = static_cast<std::uint32_t>(mesh.submeshes.size());
+    header.submeshOffset = align(header.lodOffset + std::uint64_t(header.lodCount) * sizeof(MeshLod));
+    header.normalCount = static_cast<std::uint32_t>(mesh.normals.size());
+    header.normalOffset = align(header.submeshOffset + std::uint64_t(header.submeshCount) * sizeof(Submesh));
+    for (int c = 0; c < 3; c++)
+    {
+        header.boundsMin[c] = mesh.boundsMin[c];
+        header.boundsMax[c] = mesh.boundsMax[c];
+    }
+
+    std::string tempPath = path + ".tmp";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (file == nullptr)
+    {
+        LOG("Failed to create mesh cache %s", tempPath.c_str());
+        return false;
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              writePadding(file, sizeof(header), header.vertexOffset) &&
+              std::fwrite(mesh.vertices.data(), sizeof(MeshVertex), mesh.vertices.size(), file) == mesh.vertices.size() &&
+              writePadding(file, header.vertexOffset + std::uint64_t(header.vertexCount) * header.vertexStride, header.indexOffset);
+
+    if (ok && header.indexCount > 0)
+    {
+        ok = std::fwrite(mesh.getIndices(), header.indexSize, header.indexCount, file) == header.indexCount;
+    }
+    if (ok && header.lodCount > 0)
+    {
+        ok = writePadding(file, header.indexOffset + std::uint64_t(header.indexCount) * header.indexSize, header.lodOffset) &&
+             std::fwrite(mesh.lods.data(), sizeof(MeshLod), mesh.lods.size(), file) == mesh.lods.size();
+    }
+    // The padding runs from wherever the previous array ended
+    std::uint64_t end = header.lodCount > 0 ? header.lodOffset + std::uint64_t(header.lodCount) * sizeof(MeshLod)
+                                            : header.indexOffset + std::uint64_t(header.indexCount) * header.indexSize;
+    if (ok && header.submeshCount > 0)
+    {
+        ok = writePadding(file, end, header.submeshOffset) &&
+             std::fwrite(mesh.submeshes.data(), sizeof(Submesh), mesh.submeshes.size(), file) == mesh.submeshes.size();
+        end = header.submeshOffset + std::uint64_t(header.submeshCount) * sizeof(Submesh);
+    }
+    if (ok && header.normalCount > 0)
+    {
+        ok = writePadding(file, end, header.normalOffset) &&
+             std::fwrite(mesh.normals.data(), sizeof(SampleMath::Vec3), mesh.normals.size(), file) == mesh.normals.size();
+    }
+
+    ok = (std::fclose(file) == 0) && ok;
+    if (ok)
+    {
+        // rename does not replace an existing file on Windows
+        std::remove(path.c_str());
+        ok = std::rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+    if (!ok)
+    {
+        LOG("Failed to write mesh cache %s", path.c_str());
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+/*===============================================================================
+MappedMeshCache
+===============================================================================*/
+
+bool
+MappedMeshCache::open(const std::string& path, std::uint64_t sourceHash)
+{
+    close();
+
+    if (!map(path))
+    {
+        return false;
+    }
+
+    ByteReader in(reinterpret_cast<const char*>(mData), mSize);
+    CacheHeader header;
+    if (!readHeader(in, header))
+    {
+        LOG("Mesh cache %s is truncated", path.c_str());
+        close();
+        return false;
+    }
+
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+        header.vertexStride != sizeof(MeshVertex))
+    {
+        LOG("Mesh cache %s was written by a different version", path.c_str());
+        close();
+        return false;
+    }
+    if (header.sourceHash != sourceHash)
+    {
+        LOG("Mesh cache %s is out of date", path.c_str());
+        close();
+        return false;
+    }
+
+    // Each array must lie inside the file, after the arrays before it. Checked without
+    // computing offset + size, which a corrupt header could make wrap around.
+    bool validIndexSize = (header.indexSize == 0 && header.indexCount == 0) ||
+                          header.indexSize == 2 || header.indexSize == 4;
+    std::uint64_t vertexEnd = 0;
+    std::uint64_t indexEnd = 0;
+    std::uint64_t lodEnd = 0;
+    std::uint64_t submeshEnd = 0;
+    std::uint64_t normalEnd = 0;
+    if (!validIndexSize || (header.normalCount != 0 && header.normalCount != header.vertexCount) ||
+        header.vertexOffset % CACHE_ALIGNMENT != 0 || header.indexOffset % CACHE_ALIGNMENT != 0 ||
+        header.lodOffset % CACHE_ALIGNMENT != 0 || header.submeshOffset % CACHE_ALIGNMENT != 0 ||
+        header.normalOffset % CACHE_ALIGNMENT != 0 ||
+        !fitsInFile(sizeof(header), header.vertexOffset, header.vertexCount, header.vertexStride, mSize, vertexEnd) ||
+        (header.indexCount > 0 &&
+         !fitsInFile(vertexEnd, header.indexOffset, header.indexCount, header.indexSize, mSize, indexEnd)) ||
+        (header.lodCount > 0 &&
+         !fitsInFile(std::max(vertexEnd, indexEnd), header.lodOffset, header.lodCount, sizeof(MeshLod), mSize, lodEnd)) ||
+        (header.submeshCount > 0 &&
+         !fitsInFile(std::max({ vertexEnd, indexEnd, lodEnd }), header.submeshOffset, header.submeshCount,
+                     sizeof(Submesh), mSize, submeshEnd)) ||
+        (header.normalCount > 0 &&
+         !fitsInFile(std::max({ vertexEnd, indexEnd, lodEnd, submeshEnd }), header.normalOffset, header.normalCount,
+                     sizeof(SampleMath::Vec3), mSize, normalEnd)))
+    {
+        LOG("Mesh cache %s is corrupt", path.c_str());
+        close();
+        return false;
+    }
+
+    // The arrays are used in place. The views fail on a big endian host, the cache is then
+    // rebuilt like a corrupt one.
+    const std::uint16_t* indices16 = nullptr;
+    const std::uint32_t* indices32 = nullptr;
+    if (!(in.seek(static_cast<size_t>(header.vertexOffset)) && in.readView(header.vertexCount, mVertices)) ||
+        !viewArray(in, header.indexOffset, header.indexSize == 2 ? header.indexCount : 0, indices16) ||
+        !viewArray(in, header.indexOffset, header.indexSize == 4 ? header.indexCount : 0, indices32) ||
+        !viewArray(in, header.lodOffset, header.lodCount, mLods) ||
+        !viewArray(in, header.submeshOffset, header.submeshCount, mSubmeshes) ||
+        !viewArray(in, header.normalOffset, header.normalCount, mNormals))
+    {
+        LOG("Mesh cache %s cannot be used in place on this device", path.c_str());
+        close();
+        return false;
+    }
+    mVertexCount = header.vertexCount;
+    mIndices = indices16 != nullptr ? static_cast<const void*>(indices16) : static_cast<const void*>(indices32);
+    mIndexCount = header.indexCount;
+    mIndexSize = header.indexSize;
+    mLodCount = header.lodCount;
+    mSubmeshCount = header.submeshCount;
+
+    // Every level must be a range of the indices
+    for (std::uint32_t i = 0; i < mLodCount; i++)
+    {
+        if (mLods[i].indexOffset > mIndexCount || mLods[i].indexCount > mIndexCount - mLods[i].indexOffset)
+        {
+            LOG("Mesh cache %s is corrupt", path.c_str());
+            close();
+            return false;
+        }
+    }
+
+    // Every submesh must be a range of the indices of an existing level
+    for (std::uint32_t i = 0; i < mSubmeshCount; i++)
+    {
+        const Submesh& submesh = mSubmeshes[i];
+        if (submesh.indexOffset > mIndexCount || submesh.indexCount > mIndexCount - submesh.indexOffset ||
+            submesh.lod >= std::max(mLodCount, 1u))
+        {
+            LOG("Mesh cache %s is corrupt", path.c_str());
+            close();
+            return false;
+        }
+    }
+
+    mBoundsMin = SampleMath::Vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    mBoundsMax = SampleMath::Vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    return true;
+}
+
+
+void
+MappedMeshCache::close()
+{
+    unmap();
+    mVertices = nullptr;
+    mVertexCount = 0;
+    mIndices = nullptr;
+    mIndexCount = 0;
+    mIndexSize = 0;
+    mLods = nullptr;
+    mLodCount = 0;
+    mSubmeshes = nullptr;
+    mSubmeshCount = 0;
+    mNormals = nullptr;
+}
+
+
+/*===============================================================================
+MappedMeshCache private methods
+===============================================================================*/
+
+#if defined(_WIN32)
+
+bool
+MappedMeshCache::map(const std::string& path)
+{
+    int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    if (length <= 0)
+    {
+        return false;
+    }
+    std::wstring widePath(length, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], length);
+
+    // CreateFile2 and the FromApp mapping functions are the ones available to UWP apps
+    HANDLE file = CreateFile2(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        // No cache yet
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 ||
+        static_cast<unsigned long long>(fileSize.QuadPart) > std::numeric_limits<size_t>::max())
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingFromApp(file, nullptr, PAGE_READONLY, 0, nullptr);
+    // The mapping keeps the file open
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+        LOG("Failed to map mesh cache %s", path.c_str());
+        return false;
+    }
+
+    void* view = MapViewOfFileFromApp(mapping, FILE_MAP_READ, 0, 0);
+    if (view == nullptr)
+    {
+        LOG("Failed to map mesh cache %s", path.c_str());
+        CloseHandle(mapping);
+        return false;
+    }
+
+    mMapping = mapping;
+    mData = static_cast<const unsigned char*>(view);
+    mSize = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+
+void
+MappedMeshCache::unmap()
+{
+    if (mData != nullptr)
+    {
+        UnmapViewOfFile(mData);
+        CloseHandle(mMapping);
+        mData = nullptr;
+        mMapping = nullptr;
+        mSize = 0;
+    }
+}
+
+#else
+
+bool
+MappedMeshCache::map(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        // No cache yet
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file open
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        LOG("Failed to map mesh cache %s", path.c_str());
+        return false;
+    }
+
+    mData = static_cast<const unsigned char*>(view);
+    mSize = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+
+void
+MappedMeshCache::unmap()
+{
+    if (mData != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(mData), mSize);
+        mData = nullptr;
+        mSize = 0;
+    }
+}
+
+#endif
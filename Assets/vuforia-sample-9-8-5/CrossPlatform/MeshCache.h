@@ -0,0 +1,215 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_CACHE_H__
+#define __MESH_CACHE_H__
+
+#include "MathTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/*
+ * Binary cache of a renderable mesh, so a model is parsed from its OBJ file only once.
+ * The file is a header followed by the vertices, the indices, the levels of detail,
+ * the submeshes and the normals, each 16 byte aligned, so it can be memory mapped and the arrays handed straight to
+ * buffer creation.
+ * Meshes are built from OBJ models by MeshBuilder.
+ * The header records the hash of the source the mesh was built from, a cache whose hash
+ * does not match is rebuilt. Values are stored in host byte order, caches are meant to be
+ * read on the machine that wrote them.
+ */
+
+/// Vertex of a cached mesh, same layout as SampleCommon::TexturedShaderInputBuffer
+struct MeshVertex
+{
+    float pos[3];
+    /// DirectX convention, v points down
+    float texcoord[2];
+};
+
+static_assert(sizeof(MeshVertex) == 5 * sizeof(float), "MeshVertex is stored and uploaded as raw bytes");
+
+/// A level of detail of a mesh, a range of its indices that draws it with fewer triangles
+struct MeshLod
+{
+    std::uint32_t indexOffset;
+    std::uint32_t indexCount;
+    /// Distance the simplified surface may be from the full mesh, in model units
+    float error;
+};
+
+static_assert(sizeof(MeshLod) == 12, "MeshLod is stored as raw bytes");
+
+/// A range of the indices of one level of detail that uses one material, one draw call
+struct Submesh
+{
+    std::uint32_t indexOffset;
+    std::uint32_t indexCount;
+    /// Material of the faces in the OBJ model, -1 for faces without one
+    std::int32_t material;
+    /// Level of detail the range is part of, 0 if the mesh has none
+    std::uint32_t lod;
+    SampleMath::Vec3 boundsMin;
+    SampleMath::Vec3 boundsMax;
+};
+
+static_assert(sizeof(Submesh) == 40, "Submesh is stored as raw bytes");
+
+/// A mesh ready for upload: vertices, optional triangle list indices, levels of detail and bounds
+struct Mesh
+{
+    std::vector<MeshVertex> vertices;
+    /// Triangle list indices, 16 bit when every vertex can be addressed with them.
+    /// Both are empty for a non-indexed triangle list.
+    std::vector<std::uint16_t> indices16;
+    std::vector<std::uint32_t> indices32;
+    /// Levels of detail, finest first, built by MeshSimplifier. Empty if all the indices
+    /// are one level.
+    std::vector<MeshLod> lods;
+    /// Ranges of the indices by material, built by MeshPartitioner. Sorted by level of
+    /// detail, then by material. Empty if every level is drawn in one piece.
+    std::vector<Submesh> submeshes;
+    /// One per vertex, built by MeshNormals, empty if not built. The w of a tangent is the
+    /// sign of the bitangent. The mesh cache stores the normals, not the tangents.
+    std::vector<SampleMath::Vec3> normals;
+    std::vector<SampleMath::Vec4> tangents;
+    SampleMath::Vec3 boundsMin;
+    SampleMath::Vec3 boundsMax;
+
+    size_t getIndexCount() const { return indices16.empty() ? indices32.size() : indices16.size(); }
+    /// Size of one index in bytes, 2 or 4, or 0 for a non-indexed mesh
+    std::uint32_t getIndexSize() const { return !indices16.empty() ? 2 : (!indices32.empty() ? 4 : 0); }
+    const void* getIndices() const
+    {
+        return !indices16.empty() ? static_cast<const void*>(indices16.data())
+                                  : (!indices32.empty() ? static_cast<const void*>(indices32.data()) : nullptr);
+    }
+};
+
+/// A value shared by consecutive triangles of a mesh, such as their material or smoothing group
+/**
+ * A list of runs is in increasing firstTriangle order and starts at triangle 0, every
+ * triangle has the value of the last run starting at or before it. Models change material
+ * and smoothing group rarely, so a few runs stand for a value per triangle.
+ */
+template <typename T>
+struct TriangleRun
+{
+    std::uint32_t firstTriangle;
+    T value;
+};
+
+/// One past the last triangle of runs[i] in a mesh of triangleCount triangles
+template <typename T>
+size_t getRunEnd(const std::vector<TriangleRun<T>>& runs, size_t i, size_t triangleCount)
+{
+    return i + 1 < runs.size() ? runs[i + 1].firstTriangle : triangleCount;
+}
+
+/// True if runs is a list of runs for a mesh of triangleCount triangles
+template <typename T>
+bool isValidTriangleRuns(const std::vector<TriangleRun<T>>& runs, size_t triangleCount)
+{
+    if (runs.empty() || runs[0].firstTriangle != 0 || triangleCount == 0)
+    {
+        return false;
+    }
+    for (size_t i = 1; i < runs.size(); i++)
+    {
+        if (runs[i].firstTriangle <= runs[i - 1].firstTriangle || runs[i].firstTriangle >= triangleCount)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace MeshCache
+{
+    /// Hash used to identify the source of a cache. Not cryptographic, only detects changes.
+    std::uint64_t hash(const void* data, size_t size, std::uint64_t seed = 0);
+
+    /// Write mesh to the cache file at path, replacing it.
+    /// The file is written under a temporary name first, so a failed write never leaves a
+    /// truncated cache behind.
+    bool write(const std::string& path, const Mesh& mesh, std::uint64_t sourceHash);
+}
+
+/// A cache file mapped into memory
+/**
+ * The arrays point into the mapping: on a warm start the mesh is paged in from the file
+ * cache by the buffer upload and is never copied or parsed.
+ */
+class MappedMeshCache
+{
+public:
+    MappedMeshCache() = default;
+    MappedMeshCache(const MappedMeshCache&) = delete;
+    MappedMeshCache& operator=(const MappedMeshCache&) = delete;
+    ~MappedMeshCache() { close(); }
+
+    /// Map the cache at path. Fails if the file is missing or corrupt, was written by a
+    /// different version, or was built from a source with a different hash.
+    bool open(const std::string& path, std::uint64_t sourceHash);
+    void close();
+    bool isOpen() const { return mData != nullptr; }
+
+    const MeshVertex* getVertices() const { return mVertices; }
+    std::uint32_t getVertexCount() const { return mVertexCount; }
+
+    /// 16 or 32 bit indices, see getIndexSize. Null for a non-indexed mesh.
+    const void* getIndices() const { return mIndices; }
+    std::uint32_t getIndexCount() const { return mIndexCount; }
+    /// Size of one index in bytes, 2 or 4, or 0 for a non-indexed mesh
+    std::uint32_t getIndexSize() const { return mIndexSize; }
+
+    /// Levels of detail, finest first. Null if the mesh has none.
+    const MeshLod* getLods() const { return mLods; }
+    std::uint32_t getLodCount() const { return mLodCount; }
+
+    /// Ranges of the indices by material, see Mesh::submeshes. Null if the mesh has none.
+    const Submesh* getSubmeshes() const { return mSubmeshes; }
+    std::uint32_t getSubmeshCount() const { return mSubmeshCount; }
+
+    /// One normal per vertex, see Mesh::normals. Null if the mesh has none.
+    const SampleMath::Vec3* getNormals() const { return mNormals; }
+
+    const SampleMath::Vec3& getBoundsMin() const { return mBoundsMin; }
+    const SampleMath::Vec3& getBoundsMax() const { return mBoundsMax; }
+
+private: // methods
+
+    bool map(const std::string& path);
+    void unmap();
+
+private: // data members
+
+    const unsigned char* mData = nullptr;
+    size_t mSize = 0;
+#if defined(_WIN32)
+    void* mMapping = nullptr;
+#endif
+
+    const MeshVertex* mVertices = nullptr;
+    std::uint32_t mVertexCount = 0;
+    const void* mIndices = nullptr;
+    std::uint32_t mIndexCount = 0;
+    std::uint32_t mIndexSize = 0;
+    const MeshLod* mLods = nullptr;
+    std::uint32_t mLodCount = 0;
+    const Submesh* mSubmeshes = nullptr;
+    std::uint32_t mSubmeshCount = 0;
+    const SampleMath::Vec3* mNormals = nullptr;
+    SampleMath::Vec3 mBoundsMin;
+    SampleMath::Vec3 mBoundsMax;
+};
+
+#endif // __MESH_CACHE_H__
@@ -0,0 +1,424 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshNormals.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+
+namespace
+{
+    constexpr std::uint32_t NO_VERTEX = std::numeric_limits<std::uint32_t>::max();
+
+    /// Smoothing group of a vertex no triangle uses yet
+    constexpr std::uint32_t NO_GROUP = std::numeric_limits<std::uint32_t>::max();
+
+    /// Smoothing group of flat triangles, their vertices share nothing
+    constexpr std::uint32_t FLAT_GROUP = 0;
+
+    /// Texture coordinate areas below this are treated as zero
+    constexpr float MIN_TEXCOORD_AREA = 1e-12f;
+
+    /// Run task(0) ... task(count - 1), task(0) on the calling thread
+    template <typename Task>
+    void runTasks(unsigned int count, const Task& task)
+    {
+        std::vector<std::thread> workers;
+        for (unsigned int i = 1; i < count; i++)
+        {
+            workers.emplace_back(task, i);
+        }
+        task(0);
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    /// First element of part of count elements split into numParts
+    size_t partBegin(size_t count, unsigned int part, unsigned int numParts)
+    {
+        return count * part / numParts;
+    }
+
+    SampleMath::Vec3 position(const MeshVertex& vertex)
+    {
+        return SampleMath::Vec3(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+    }
+
+    /// Any unit vector perpendicular to the unit vector n
+    SampleMath::Vec3 perpendicular(const SampleMath::Vec3& n)
+    {
+        SampleMath::Vec3 axis = std::fabs(n[0]) < 0.9f ? SampleMath::Vec3(1.0f, 0.0f, 0.0f)
+                                                        : SampleMath::Vec3(0.0f, 1.0f, 0.0f);
+        return SampleMath::normalize(SampleMath::cross(n, axis));
+    }
+
+    /// v without its component along the unit vector n, normalized
+    SampleMath::Vec3 projectOnPlane(const SampleMath::Vec3& v, const SampleMath::Vec3& n)
+    {
+        return SampleMath::normalize(v - n * SampleMath::dot(n, v));
+    }
+
+    /// Marks a free slot of a hash table
+    constexpr std::uint32_t EMPTY_SLOT = std::numeric_limits<std::uint32_t>::max();
+
+    /// Vertices at one position in one smoothing group share a normal
+    struct SmoothingKey
+    {
+        std::uint32_t bits[3];
+        std::uint32_t group;
+
+        bool operator==(const SmoothingKey& other) const
+        {
+            return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2] &&
+                   group == other.group;
+        }
+    };
+
+    std::uint64_t hashKey(const SmoothingKey& key)
+    {
+        std::uint64_t h = (std::uint64_t(key.bits[0]) << 32 | key.bits[1]) * 0x9E3779B97F4A7C15ULL;
+        h = (h ^ (std::uint64_t(key.bits[2]) << 32 | key.group)) * 0xC2B2AE3D27D4EB4FULL;
+        return h ^ (h >> 31);
+    }
+
+    /// Give every vertex used by triangles of several smoothing groups a copy per group,
+    /// and every corner of a flat triangle a vertex of its own. vertexGroups receives the
+    /// group of every vertex. Returns the number of vertices added.
+    size_t splitSmoothingGroups(std::vector<MeshVertex>& vertices, std::vector<std::uint32_t>& indices,
+                                const std::vector<TriangleRun<std::uint32_t>>& groupRuns,
+                                std::vector<std::uint32_t>& vertexGroups)
+    {
+        const size_t vertexCount = vertices.size();
+        vertexGroups.assign(vertexCount, NO_GROUP);
+        // The copies of a vertex, a chain starting at the vertex
+        std::vector<std::uint32_t> nextCopy(vertexCount, NO_VERTEX);
+
+        size_t run = 0;
+        size_t runEnd = 3 * getRunEnd(groupRuns, run, indices.size() / 3);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            if (i == runEnd)
+            {
+                run++;
+                runEnd = 3 * getRunEnd(groupRuns, run, indices.size() / 3);
+            }
+            std::uint32_t group = groupRuns[run].value;
+            std::uint32_t v = indices[i];
+            if (vertexGroups[v] == NO_GROUP)
+            {
+                vertexGroups[v] = group;
+                continue;
+            }
+
+            std::uint32_t last = v;
+            std::uint32_t found = NO_VERTEX;
+            for (std::uint32_t copy = v; copy != NO_VERTEX; copy = nextCopy[copy])
+            {
+                if (group != FLAT_GROUP && vertexGroups[copy] == group)
+                {
+                    found = copy;
+                    break;
+                }
+                last = copy;
+            }
+            if (found == NO_VERTEX)
+            {
+                found = static_cast<std::uint32_t>(vertices.size());
+                MeshVertex vertex = vertices[v];
+                vertices.push_back(vertex);
+                vertexGroups.push_back(group);
+                nextCopy.push_back(NO_VERTEX);
+                nextCopy[last] = found;
+            }
+            indices[i] = found;
+        }
+        return vertices.size() - vertexCount;
+    }
+
+    /// Number the normals the vertices share: one per position and smoothing group, and
+    /// one per vertex of a flat triangle. Returns the number of normals.
+    size_t findSharedNormals(const std::vector<MeshVertex>& vertices, const std::vector<std::uint32_t>& vertexGroups,
+                             std::vector<std::uint32_t>& vertexNormal)
+    {
+        const size_t vertexCount = vertices.size();
+        vertexNormal.resize(vertexCount);
+        std::vector<SmoothingKey> keys(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            std::memcpy(keys[v].bits, vertices[v].pos, sizeof(keys[v].bits));
+            keys[v].group = vertexGroups.empty() ? 1 : vertexGroups[v];
+        }
+
+        // Open addressing on the first vertex of every key, at most half full
+        size_t capacity = 16;
+        while (capacity < 2 * vertexCount)
+        {
+            capacity *= 2;
+        }
+        const size_t mask = capacity - 1;
+        std::vector<std::uint32_t> table(capacity, EMPTY_SLOT);
+
+        std::uint32_t normalCount = 0;
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            if (keys[v].group == FLAT_GROUP)
+            {
+                vertexNormal[v] = normalCount++;
+                continue;
+            }
+
+            size_t s = hashKey(keys[v]) & mask;
+            while (true)
+            {
+                std::uint32_t first = table[s];
+                if (first == EMPTY_SLOT)
+                {
+                    table[s] = static_cast<std::uint32_t>(v);
+                    vertexNormal[v] = normalCount++;
+                    break;
+                }
+                if (keys[first] == keys[v])
+                {
+                    vertexNormal[v] = vertexNormal[first];
+                    break;
+                }
+                s = (s + 1) & mask;
+            }
+        }
+        return normalCount;
+    }
+
+    /// Sum of the tangents of the triangles around a vertex
+    struct TangentSum
+    {
+        SampleMath::Vec3 tangent;
+        /// Triangle angles at the vertex, negative for mirrored texture coordinates
+        float orientation = 0.0f;
+    };
+
+    /// Add the area weighted normals of the triangles first ... end - 1 to the normals of
+    /// their vertices
+    void scatterNormals(const std::vector<MeshVertex>& vertices, const std::vector<std::uint32_t>& indices,
+                        const std::vector<std::uint32_t>& vertexNormal, size_t first, size_t end,
+                        SampleMath::Vec3* normals)
+    {
+        for (size_t t = first; t < end; t++)
+        {
+            const std::uint32_t* tri = &indices[3 * t];
+            SampleMath::Vec3 p0 = position(vertices[tri[0]]);
+            SampleMath::Vec3 p1 = position(vertices[tri[1]]);
+            SampleMath::Vec3 p2 = position(vertices[tri[2]]);
+
+            // Twice the area, along the counter-clockwise front face normal
+            SampleMath::Vec3 n = SampleMath::cross(p1 - p0, p2 - p0);
+            for (int c = 0; c < 3; c++)
+            {
+                SampleMath::Vec3& sum = normals[vertexNormal[tri[c]]];
+                sum = sum + n;
+            }
+        }
+    }
+
+    /// Add the tangents of the triangles first ... end - 1 to the tangents of their
+    /// vertices. Returns the number of triangles without texture coordinate area.
+    size_t scatterTangents(const std::vector<MeshVertex>& vertices, const std::vector<std::uint32_t>& indices,
+                           const std::vector<SampleMath::Vec3>& normals, size_t first, size_t end,
+                           TangentSum* tangents)
+    {
+        size_t degenerateCount = 0;
+        for (size_t t = first; t < end; t++)
+        {
+            const std::uint32_t* tri = &indices[3 * t];
+            SampleMath::Vec3 p[3];
+            float s[3];
+            float u[3];
+            for (int c = 0; c < 3; c++)
+            {
+                const MeshVertex& vertex = vertices[tri[c]];
+                p[c] = position(vertex);
+                s[c] = vertex.texcoord[0];
+                u[c] = 1.0f - vertex.texcoord[1]; // back to the OpenGL convention of the model
+            }
+
+            // The texture u axis in model space, as in MikkTSpace
+            SampleMath::Vec3 d1 = p[1] - p[0];
+            SampleMath::Vec3 d2 = p[2] - p[0];
+            float s1 = s[1] - s[0];
+            float t1 = u[1] - u[0];
+            float s2 = s[2] - s[0];
+            float t2 = u[2] - u[0];
+            float signedArea = s1 * t2 - t1 * s2;
+            SampleMath::Vec3 axis = d1 * t2 - d2 * t1;
+            float axisLength = SampleMath::length(axis);
+            if (std::fabs(signedArea) < MIN_TEXCOORD_AREA || axisLength == 0.0f)
+            {
+                degenerateCount++;
+                continue;
+            }
+            float orientation = signedArea > 0.0f ? 1.0f : -1.0f;
+            axis = axis * (orientation / axisLength);
+
+            for (int c = 0; c < 3; c++)
+            {
+                const SampleMath::Vec3& n = normals[tri[c]];
+                SampleMath::Vec3 tangent = projectOnPlane(axis, n);
+                SampleMath::Vec3 e1 = projectOnPlane(p[(c + 1) % 3] - p[c], n);
+                SampleMath::Vec3 e2 = projectOnPlane(p[(c + 2) % 3] - p[c], n);
+                float angle = std::acos(std::min(1.0f, std::max(-1.0f, SampleMath::dot(e1, e2))));
+
+                TangentSum& sum = tangents[tri[c]];
+                sum.tangent = sum.tangent + tangent * angle;
+                sum.orientation += orientation * angle;
+            }
+        }
+        return degenerateCount;
+    }
+}
+
+
+bool
+MeshNormals::build(Mesh& mesh, const std::vector<TriangleRun<std::uint32_t>>* smoothingGroupRuns,
+                   MeshNormalsStats* stats, unsigned int numThreads)
+{
+    const size_t triangleCount = mesh.getIndexCount() / 3;
+    // Splitting adds at most a vertex per index
+    if (triangleCount == 0 || !mesh.lods.empty() ||
+        (smoothingGroupRuns != nullptr && !isValidTriangleRuns(*smoothingGroupRuns, triangleCount)) ||
+        mesh.vertices.size() + mesh.getIndexCount() >= NO_VERTEX)
+    {
+        return false;
+    }
+
+    std::vector<std::uint32_t> indices;
+    if (!mesh.indices16.empty())
+    {
+        indices.assign(mesh.indices16.begin(), mesh.indices16.end());
+    }
+    else
+    {
+        indices = mesh.indices32;
+    }
+
+    std::vector<std::uint32_t> vertexGroups;
+    size_t splitVertexCount = 0;
+    if (smoothingGroupRuns != nullptr)
+    {
+        splitVertexCount = splitSmoothingGroups(mesh.vertices, indices, *smoothingGroupRuns, vertexGroups);
+    }
+    const size_t vertexCount = mesh.vertices.size();
+
+    std::vector<std::uint32_t> vertexNormal;
+    const size_t normalCount = findSharedNormals(mesh.vertices, vertexGroups, vertexNormal);
+
+    if (numThreads == 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (triangleCount < PARALLEL_MIN_TRIANGLES)
+    {
+        numThreads = 1;
+    }
+
+    // Normals: every thread adds its triangles into its own sums, thread 0 into the result,
+    // then every thread adds the other sums of its part of the normals, in thread order
+    std::vector<std::vector<SampleMath::Vec3>> normalSums(numThreads);
+    runTasks(numThreads, [&](unsigned int t)
+    {
+        normalSums[t].resize(normalCount);
+        scatterNormals(mesh.vertices, indices, vertexNormal, partBegin(triangleCount, t, numThreads),
+                       partBegin(triangleCount, t + 1, numThreads), normalSums[t].data());
+    });
+
+    std::vector<SampleMath::Vec3>& sharedNormals = normalSums[0];
+    std::vector<SampleMath::Vec3> normals(vertexCount);
+    runTasks(numThreads, [&](unsigned int t)
+    {
+        for (size_t i = partBegin(normalCount, t, numThreads); i < partBegin(normalCount, t + 1, numThreads); i++)
+        {
+            for (unsigned int other = 1; other < numThreads; other++)
+            {
+                sharedNormals[i] = sharedNormals[i] + normalSums[other][i];
+            }
+        }
+    });
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        // Vertices of triangles without area get some normal
+        SampleMath::Vec3 n = SampleMath::normalize(sharedNormals[vertexNormal[v]]);
+        normals[v] = SampleMath::dot(n, n) > 0.0f ? n : SampleMath::Vec3(0.0f, 0.0f, 1.0f);
+    }
+    normalSums = std::vector<std::vector<SampleMath::Vec3>>();
+
+    // Tangents, the same way, per vertex
+    std::vector<std::vector<TangentSum>> tangentSums(numThreads);
+    std::vector<size_t> degenerateCounts(numThreads, 0);
+    runTasks(numThreads, [&](unsigned int t)
+    {
+        tangentSums[t].resize(vertexCount);
+        degenerateCounts[t] = scatterTangents(mesh.vertices, indices, normals, partBegin(triangleCount, t, numThreads),
+                                              partBegin(triangleCount, t + 1, numThreads), tangentSums[t].data());
+    });
+
+    std::vector<SampleMath::Vec4> tangents(vertexCount);
+    runTasks(numThreads, [&](unsigned int t)
+    {
+        for (size_t v = partBegin(vertexCount, t, numThreads); v < partBegin(vertexCount, t + 1, numThreads); v++)
+        {
+            TangentSum sum = tangentSums[0][v];
+            for (unsigned int other = 1; other < numThreads; other++)
+            {
+                sum.tangent = sum.tangent + tangentSums[other][v].tangent;
+                sum.orientation += tangentSums[other][v].orientation;
+            }
+
+            // Vertices without texture coordinates get some tangent
+            SampleMath::Vec3 tangent = projectOnPlane(sum.tangent, normals[v]);
+            if (SampleMath::dot(tangent, tangent) == 0.0f)
+            {
+                tangent = perpendicular(normals[v]);
+            }
+            tangents[v] = SampleMath::Vec4(tangent[0], tangent[1], tangent[2], sum.orientation < 0.0f ? -1.0f : 1.0f);
+        }
+    });
+
+    // The indices only change if vertices were split
+    if (splitVertexCount > 0)
+    {
+        if (!mesh.indices16.empty() && vertexCount <= 0x10000)
+        {
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                mesh.indices16[i] = static_cast<std::uint16_t>(indices[i]);
+            }
+        }
+        else
+        {
+            mesh.indices16.clear();
+            mesh.indices32.swap(indices);
+        }
+    }
+    mesh.normals.swap(normals);
+    mesh.tangents.swap(tangents);
+
+    if (stats != nullptr)
+    {
+        stats->splitVertexCount = splitVertexCount;
+        stats->degenerateTexcoordCount = 0;
+        for (size_t count : degenerateCounts)
+        {
+            stats->degenerateTexcoordCount += count;
+        }
+        stats->threadCount = numThreads;
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_NORMALS_H__
+#define __MESH_NORMALS_H__
+
+#include "MeshCache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// Result of MeshNormals::build
+struct MeshNormalsStats
+{
+    /// Vertices added so that every vertex is in one smoothing group
+    size_t splitVertexCount = 0;
+    /// Triangles whose texture coordinates have no area, they add nothing to the tangents
+    size_t degenerateTexcoordCount = 0;
+    /// Number of threads the triangles were spread over
+    unsigned int threadCount = 0;
+};
+
+/// Builds vertex normals and tangents for meshes whose model has none
+/**
+ * Normals are the sum of the normals of the triangles around a vertex, weighted by
+ * triangle area. Vertices at the same position in the same smoothing group share their
+ * normal, so texture seams do not show in the lighting. Triangles in smoothing group 0
+ * are flat: a vertex used by triangles of several groups is split into one vertex per
+ * group first, and a flat triangle gets vertices of its own.
+ * Tangents follow MikkTSpace, so normal maps baked with it light correctly: the tangent
+ * of every triangle is taken along its texture u axis, in the OpenGL texture convention
+ * of the OBJ file, projected onto the vertex normal and weighted by the angle of the
+ * triangle at the vertex. The w of a tangent is the sign of the bitangent, a shader gets
+ * the bitangent as w * cross(normal, tangent). Unlike MikkTSpace, vertices shared by
+ * mirrored and unmirrored texture coordinates are not split, they take the sign of the
+ * larger angle.
+ * Both sums are scattered from the triangles on several threads, each into its own
+ * buffer, and the buffers are added up in thread order: the result only depends on the
+ * mesh and the thread count.
+ */
+namespace MeshNormals
+{
+    /// Meshes with fewer triangles are always done on the calling thread
+    constexpr size_t PARALLEL_MIN_TRIANGLES = 64 * 1024;
+
+    /// Replace mesh.normals and mesh.tangents with ones built from the triangles of mesh.
+    /// smoothingGroupRuns, if not null, has the OBJ smoothing group runs of the triangles,
+    /// as built by MeshBuilder. Without it the whole mesh is smooth.
+    /// Splitting vertices keeps the triangles in order, so the material runs and the
+    /// submeshes stay valid, and the indices become 32 bit if they have to.
+    /// Run this before MeshOptimizer::optimize, which keeps the normals and tangents with
+    /// their vertices. numThreads 0 uses std::thread::hardware_concurrency().
+    /// Returns false, and leaves mesh alone, if the mesh is not indexed, already has levels
+    /// of detail, or smoothingGroupRuns are not valid runs for the triangles.
+    bool build(Mesh& mesh, const std::vector<TriangleRun<std::uint32_t>>* smoothingGroupRuns = nullptr,
+               MeshNormalsStats* stats = nullptr, unsigned int numThreads = 0);
+}
+
+#endif // __MESH_NORMALS_H__
@@ -0,0 +1,504 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+
+namespace
+{
+    constexpr std::uint32_t NO_VERTEX = std::numeric_limits<std::uint32_t>::max();
+
+    /// Number of cache misses of indices with a FIFO cache of cacheSize vertices
+    size_t countCacheMisses(const std::vector<std::uint32_t>& indices, size_t vertexCount, unsigned int cacheSize)
+    {
+        // A vertex is in the cache while fewer than cacheSize misses happened after its own
+        std::vector<size_t> missTime(vertexCount, std::numeric_limits<size_t>::max());
+        size_t misses = 0;
+        for (std::uint32_t v : indices)
+        {
+            if (missTime[v] == std::numeric_limits<size_t>::max() || misses - missTime[v] >= cacheSize)
+            {
+                missTime[v] = misses;
+                misses++;
+            }
+        }
+        return misses;
+    }
+
+    /// Triangles using each vertex: the triangles of vertex v are
+    /// triangles[offsets[v]] ... triangles[offsets[v + 1] - 1]
+    struct VertexTriangles
+    {
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint32_t> triangles;
+
+        VertexTriangles(const std::vector<std::uint32_t>& indices, size_t vertexCount)
+            : offsets(vertexCount + 1, 0), triangles(indices.size())
+        {
+            for (std::uint32_t v : indices)
+            {
+                offsets[v + 1]++;
+            }
+            for (size_t v = 0; v < vertexCount; v++)
+            {
+                offsets[v + 1] += offsets[v];
+            }
+            std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                triangles[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+            }
+        }
+    };
+
+    SampleMath::Vec3 position(const std::vector<MeshVertex>& vertices, std::uint32_t v)
+    {
+        return SampleMath::Vec3(vertices[v].pos[0], vertices[v].pos[1], vertices[v].pos[2]);
+    }
+
+    /// Numbers the vertices of a range of indices from 0 in order of first use, so the per
+    /// vertex state of the passes is as large as the range and not the mesh
+    struct RangeVertices
+    {
+        /// Range number of every mesh vertex, NO_VERTEX if the range does not use it
+        std::vector<std::uint32_t> rangeVertex;
+        /// Mesh number of every range vertex
+        std::vector<std::uint32_t> meshVertex;
+
+        explicit RangeVertices(size_t vertexCount) : rangeVertex(vertexCount, NO_VERTEX) {}
+
+        /// Copy count indices from first into range, renumbered
+        void load(const std::uint32_t* first, size_t count, std::vector<std::uint32_t>& range)
+        {
+            range.resize(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                std::uint32_t v = first[i];
+                if (rangeVertex[v] == NO_VERTEX)
+                {
+                    rangeVertex[v] = static_cast<std::uint32_t>(meshVertex.size());
+                    meshVertex.push_back(v);
+                }
+                range[i] = rangeVertex[v];
+            }
+        }
+
+        /// Copy range back to first with the mesh numbering, and forget its vertices
+        void store(const std::vector<std::uint32_t>& range, std::uint32_t* first)
+        {
+            for (size_t i = 0; i < range.size(); i++)
+            {
+                first[i] = meshVertex[range[i]];
+            }
+            for (std::uint32_t v : meshVertex)
+            {
+                rangeVertex[v] = NO_VERTEX;
+            }
+            meshVertex.clear();
+        }
+    };
+
+    /// Put the per vertex data of a mesh in the new order of its vertices, see optimizeVertexFetch
+    template <typename T>
+    void reorderVertexData(std::vector<T>& data, const std::vector<std::uint32_t>& vertexOrder)
+    {
+        if (data.empty())
+        {
+            return;
+        }
+        std::vector<T> reordered(vertexOrder.size());
+        for (size_t i = 0; i < vertexOrder.size(); i++)
+        {
+            reordered[i] = data[vertexOrder[i]];
+        }
+        data.swap(reordered);
+    }
+
+    template <typename Index>
+    void copyIndices(const std::vector<std::uint32_t>& from, std::vector<Index>& to)
+    {
+        to.assign(from.size(), 0);
+        for (size_t i = 0; i < from.size(); i++)
+        {
+            to[i] = static_cast<Index>(from[i]);
+        }
+    }
+}
+
+
+void
+MeshOptimizer::optimize(Mesh& mesh, MeshOptimizerStats* stats, unsigned int cacheSize, float overdrawThreshold)
+{
+    size_t indexCount = mesh.getIndexCount();
+    if (indexCount == 0 || cacheSize == 0)
+    {
+        return;
+    }
+
+    std::vector<std::uint32_t> indices;
+    if (!mesh.indices16.empty())
+    {
+        indices.assign(mesh.indices16.begin(), mesh.indices16.end());
+    }
+    else
+    {
+        indices = mesh.indices32;
+    }
+
+    const size_t vertexCount = mesh.vertices.size();
+    float acmrBefore = getAcmr(indices, vertexCount, cacheSize);
+    float atvrBefore = getAtvr(indices, vertexCount, cacheSize);
+
+    // The triangles of a submesh are reordered among themselves, so its range stays valid.
+    // The ranges of a mesh without submeshes are the whole mesh.
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (const Submesh& submesh : mesh.submeshes)
+    {
+        ranges.emplace_back(submesh.indexOffset, submesh.indexCount);
+    }
+    if (ranges.empty())
+    {
+        ranges.emplace_back(0, indexCount);
+    }
+
+    RangeVertices rangeVertices(vertexCount);
+    std::vector<MeshVertex> vertices;
+    std::vector<std::uint32_t> range;
+    std::vector<size_t> clusterStarts;
+    size_t clusterCount = 0;
+    bool overdrawSorted = false;
+    for (const auto& r : ranges)
+    {
+        rangeVertices.load(indices.data() + r.first, r.second, range);
+        vertices.clear();
+        for (std::uint32_t v : rangeVertices.meshVertex)
+        {
+            vertices.push_back(mesh.vertices[v]);
+        }
+
+        optimizeVertexCache(range, vertices.size(), cacheSize, &clusterStarts);
+        float acmrCache = getAcmr(range, vertices.size(), cacheSize);
+
+        std::vector<std::uint32_t> sorted = range;
+        optimizeOverdraw(sorted, clusterStarts, vertices);
+        if (getAcmr(sorted, vertices.size(), cacheSize) <= acmrCache * overdrawThreshold)
+        {
+            range.swap(sorted);
+            overdrawSorted = true;
+        }
+        clusterCount += clusterStarts.size();
+
+        rangeVertices.store(range, indices.data() + r.first);
+    }
+
+    // The normals and tangents go with their vertices
+    std::vector<std::uint32_t> vertexOrder;
+    optimizeVertexFetch(indices, mesh.vertices, &vertexOrder);
+    reorderVertexData(mesh.normals, vertexOrder);
+    reorderVertexData(mesh.tangents, vertexOrder);
+
+    if (stats != nullptr)
+    {
+        stats->acmrBefore = acmrBefore;
+        stats->atvrBefore = atvrBefore;
+        stats->acmrAfter = getAcmr(indices, mesh.vertices.size(), cacheSize);
+        stats->atvrAfter = getAtvr(indices, mesh.vertices.size(), cacheSize);
+        stats->clusterCount = clusterCount;
+        stats->overdrawSorted = overdrawSorted;
+    }
+
+    // The vertex count can only have gone down, the index size stays valid
+    if (!mesh.indices16.empty())
+    {
+        copyIndices(indices, mesh.indices16);
+    }
+    else
+    {
+        mesh.indices32.swap(indices);
+    }
+}
+
+
+void
+MeshOptimizer::optimizeVertexCache(std::vector<std::uint32_t>& indices, size_t vertexCount, unsigned int cacheSize,
+                                   std::vector<size_t>* clusterStarts)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (clusterStarts != nullptr)
+    {
+        clusterStarts->clear();
+    }
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    VertexTriangles adjacency(indices, vertexCount);
+
+    // Triangles not emitted yet, per vertex
+    std::vector<std::uint32_t> liveTriangles(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+
+    // Time the vertex last entered the cache, time advances by one per cache miss
+    std::vector<size_t> cacheTime(vertexCount, 0);
+    size_t time = cacheSize + 1;
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<std::uint32_t> deadEnds;
+    std::vector<std::uint32_t> candidates;
+    std::vector<std::uint32_t> output;
+    output.reserve(indices.size());
+    size_t cursor = 0;
+
+    // Next vertex with live triangles, after a dead end: the most recently used one, or
+    // the next one in input order
+    auto skipDeadEnd = [&]() -> std::uint32_t
+    {
+        while (!deadEnds.empty())
+        {
+            std::uint32_t v = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[v] > 0)
+            {
+                return v;
+            }
+        }
+        for (; cursor < vertexCount; cursor++)
+        {
+            if (liveTriangles[cursor] > 0)
+            {
+                return static_cast<std::uint32_t>(cursor);
+            }
+        }
+        return NO_VERTEX;
+    };
+
+    std::uint32_t fan = skipDeadEnd();
+    if (clusterStarts != nullptr)
+    {
+        clusterStarts->push_back(0);
+    }
+
+    while (fan != NO_VERTEX)
+    {
+        // Emit all live triangles around the fanning vertex
+        candidates.clear();
+        for (std::uint32_t a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; a++)
+        {
+            std::uint32_t t = adjacency.triangles[a];
+            if (emitted[t])
+            {
+                continue;
+            }
+            emitted[t] = true;
+            for (int c = 0; c < 3; c++)
+            {
+                std::uint32_t v = indices[3 * size_t(t) + c];
+                output.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                {
+                    cacheTime[v] = time;
+                    time++;
+                }
+            }
+        }
+
+        // Continue with the candidate that stays in the cache longest and still has
+        // all its triangles ahead of it in the cache
+        std::uint32_t next = NO_VERTEX;
+        size_t bestPriority = 0;
+        for (std::uint32_t v : candidates)
+        {
+            if (liveTriangles[v] == 0)
+            {
+                continue;
+            }
+            size_t priority = 0;
+            if (time - cacheTime[v] + 2 * size_t(liveTriangles[v]) <= cacheSize)
+            {
+                priority = time - cacheTime[v];
+            }
+            if (next == NO_VERTEX || priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+
+        if (next == NO_VERTEX)
+        {
+            next = skipDeadEnd();
+            if (next != NO_VERTEX && clusterStarts != nullptr && output.size() / 3 < triangleCount)
+            {
+                clusterStarts->push_back(output.size() / 3);
+            }
+        }
+        fan = next;
+    }
+
+    indices.swap(output);
+}
+
+
+void
+MeshOptimizer::optimizeVertexCache(std::vector<std::uint32_t>& indices, size_t vertexCount, unsigned int cacheSize,
+                                   const Submesh* submeshes, size_t submeshCount)
+{
+    RangeVertices rangeVertices(vertexCount);
+    std::vector<std::uint32_t> range;
+    for (size_t i = 0; i < submeshCount; i++)
+    {
+        rangeVertices.load(indices.data() + submeshes[i].indexOffset, submeshes[i].indexCount, range);
+        optimizeVertexCache(range, rangeVertices.meshVertex.size(), cacheSize);
+        rangeVertices.store(range, indices.data() + submeshes[i].indexOffset);
+    }
+}
+
+
+void
+MeshOptimizer::optimizeOverdraw(std::vector<std::uint32_t>& indices, const std::vector<size_t>& clusterStarts,
+                                const std::vector<MeshVertex>& vertices)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (clusterStarts.size() < 2)
+    {
+        return;
+    }
+
+    struct Cluster
+    {
+        size_t begin;
+        size_t end;
+        float sortKey;
+    };
+
+    // Area weighted centroid and normal of every cluster, and of the whole mesh
+    std::vector<Cluster> clusters(clusterStarts.size());
+    std::vector<SampleMath::Vec3> centroids(clusters.size());
+    std::vector<SampleMath::Vec3> normals(clusters.size());
+    SampleMath::Vec3 meshCentroid;
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        clusters[c].begin = clusterStarts[c];
+        clusters[c].end = (c + 1 < clusters.size()) ? clusterStarts[c + 1] : triangleCount;
+
+        SampleMath::Vec3 centroid;
+        SampleMath::Vec3 normal;
+        float area = 0.0f;
+        for (size_t t = clusters[c].begin; t < clusters[c].end; t++)
+        {
+            SampleMath::Vec3 p0 = position(vertices, indices[3 * t + 0]);
+            SampleMath::Vec3 p1 = position(vertices, indices[3 * t + 1]);
+            SampleMath::Vec3 p2 = position(vertices, indices[3 * t + 2]);
+
+            // Twice the area, along the counter-clockwise front face normal
+            SampleMath::Vec3 n = SampleMath::cross(p1 - p0, p2 - p0);
+            float a = std::sqrt(SampleMath::dot(n, n));
+            centroid = centroid + (p0 + p1 + p2) * (a / 3.0f);
+            normal = normal + n;
+            area += a;
+        }
+
+        meshCentroid = meshCentroid + centroid;
+        meshArea += area;
+        centroids[c] = area > 0.0f ? centroid * (1.0f / area) : centroid;
+        normals[c] = normal;
+    }
+    if (meshArea > 0.0f)
+    {
+        meshCentroid = meshCentroid * (1.0f / meshArea);
+    }
+
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        float length = std::sqrt(SampleMath::dot(normals[c], normals[c]));
+        clusters[c].sortKey = length > 0.0f ? SampleMath::dot(centroids[c] - meshCentroid, normals[c]) / length : 0.0f;
+    }
+
+    // Outward facing clusters far from the center first
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b)
+    {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<std::uint32_t> sorted;
+    sorted.reserve(indices.size());
+    for (const Cluster& cluster : clusters)
+    {
+        sorted.insert(sorted.end(), indices.begin() + 3 * cluster.begin, indices.begin() + 3 * cluster.end);
+    }
+    indices.swap(sorted);
+}
+
+
+void
+MeshOptimizer::optimizeVertexFetch(std::vector<std::uint32_t>& indices, std::vector<MeshVertex>& vertices,
+                                   std::vector<std::uint32_t>* vertexOrder)
+{
+    std::vector<std::uint32_t> remap(vertices.size(), NO_VERTEX);
+    std::vector<MeshVertex> reordered;
+    reordered.reserve(vertices.size());
+    if (vertexOrder != nullptr)
+    {
+        vertexOrder->clear();
+        vertexOrder->reserve(vertices.size());
+    }
+
+    for (std::uint32_t& v : indices)
+    {
+        if (remap[v] == NO_VERTEX)
+        {
+            remap[v] = static_cast<std::uint32_t>(reordered.size());
+            reordered.push_back(vertices[v]);
+            if (vertexOrder != nullptr)
+            {
+                vertexOrder->push_back(v);
+            }
+        }
+        v = remap[v];
+    }
+
+    vertices.swap(reordered);
+}
+
+
+float
+MeshOptimizer::getAcmr(const std::vector<std::uint32_t>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+    size_t triangleCount = indices.size() / 3;
+    return triangleCount > 0 ? float(countCacheMisses(indices, vertexCount, cacheSize)) / float(triangleCount) : 0.0f;
+}
+
+
+float
+MeshOptimizer::getAtvr(const std::vector<std::uint32_t>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+    std::vector<bool> used(vertexCount, false);
+    size_t usedCount = 0;
+    for (std::uint32_t v : indices)
+    {
+        if (!used[v])
+        {
+            used[v] = true;
+            usedCount++;
+        }
+    }
+    return usedCount > 0 ? float(countCacheMisses(indices, vertexCount, cacheSize)) / float(usedCount) : 0.0f;
+}
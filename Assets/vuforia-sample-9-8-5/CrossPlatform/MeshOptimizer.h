@@ -0,0 +1,88 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_OPTIMIZER_H__
+#define __MESH_OPTIMIZER_H__
+
+#include "MeshCache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// Result of MeshOptimizer::optimize, the metrics are for a FIFO cache of cacheSize vertices
+struct MeshOptimizerStats
+{
+    /// Average cache miss ratio: transformed vertices per triangle, 0.5 at best, 3 at worst
+    float acmrBefore = 0.0f;
+    float acmrAfter = 0.0f;
+    /// Average transform to vertex ratio: transformed vertices per vertex, 1 at best
+    float atvrBefore = 0.0f;
+    float atvrAfter = 0.0f;
+    /// Clusters found by the vertex cache pass and sorted for overdraw
+    size_t clusterCount = 0;
+    /// False if sorting the clusters cost too many cache misses and was undone, in every
+    /// submesh of a mesh with submeshes
+    bool overdrawSorted = false;
+};
+
+/// Reorders a triangle list for the GPU
+/**
+ * The passes, in order:
+ * - Vertex cache: Tipsify ("Fast Triangle Reordering for Vertex Locality and Reduced
+ *   Overdraw", Sander, Nehab and Barczak, 2007) fans around the vertices most recently
+ *   put in the cache. It runs in linear time and ends a cluster wherever it runs into a
+ *   dead end.
+ * - Overdraw: clusters facing away from the mesh center are drawn first, they are the
+ *   likeliest to occlude the rest. The order inside each cluster is kept.
+ * - Vertex fetch: vertices are renumbered in the order the indices first use them, so
+ *   the vertex buffer is read front to back.
+ * The result draws the same triangles, with the same winding.
+ * The cache and overdraw passes run on each submesh on its own, the triangles of a
+ * submesh stay within its range of the indices.
+ */
+namespace MeshOptimizer
+{
+    /// Cache size the passes optimize for and the metrics simulate
+    constexpr unsigned int DEFAULT_CACHE_SIZE = 16;
+
+    /// Cluster sorting is undone if it raises the ACMR by more than this factor
+    constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+    /// Optimize an indexed mesh in place, keeping its submeshes. Run this before
+    /// MeshSimplifier::buildLods. Non-indexed meshes are left alone.
+    void optimize(Mesh& mesh, MeshOptimizerStats* stats = nullptr,
+                  unsigned int cacheSize = DEFAULT_CACHE_SIZE,
+                  float overdrawThreshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+    /// Reorder the triangles of indices for a vertex cache of cacheSize vertices.
+    /// If clusterStarts is not null it receives the first triangle of every cluster.
+    void optimizeVertexCache(std::vector<std::uint32_t>& indices, size_t vertexCount, unsigned int cacheSize,
+                             std::vector<size_t>* clusterStarts = nullptr);
+
+    /// Reorder the triangles of every submesh range of indices on their own, see above
+    void optimizeVertexCache(std::vector<std::uint32_t>& indices, size_t vertexCount, unsigned int cacheSize,
+                             const Submesh* submeshes, size_t submeshCount);
+
+    /// Reorder the clusters of indices, given by their first triangle, to reduce overdraw
+    void optimizeOverdraw(std::vector<std::uint32_t>& indices, const std::vector<size_t>& clusterStarts,
+                          const std::vector<MeshVertex>& vertices);
+
+    /// Renumber the vertices in order of first use. Vertices no index refers to are dropped.
+    /// If vertexOrder is not null it receives the previous number of every vertex.
+    void optimizeVertexFetch(std::vector<std::uint32_t>& indices, std::vector<MeshVertex>& vertices,
+                             std::vector<std::uint32_t>* vertexOrder = nullptr);
+
+    /// Transformed vertices per triangle for a FIFO cache of cacheSize vertices
+    float getAcmr(const std::vector<std::uint32_t>& indices, size_t vertexCount, unsigned int cacheSize);
+
+    /// Transformed vertices per vertex for a FIFO cache of cacheSize vertices
+    float getAtvr(const std::vector<std::uint32_t>& indices, size_t vertexCount, unsigned int cacheSize);
+}
+
+#endif // __MESH_OPTIMIZER_H__
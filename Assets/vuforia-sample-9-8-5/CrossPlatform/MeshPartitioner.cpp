@@ -0,0 +1,139 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshPartitioner.h"
+
+#include <algorithm>
+#include <limits>
+
+
+namespace
+{
+    void resetBounds(Submesh& submesh)
+    {
+        const float maxFloat = std::numeric_limits<float>::max();
+        submesh.boundsMin = SampleMath::Vec3(maxFloat, maxFloat, maxFloat);
+        submesh.boundsMax = SampleMath::Vec3(-maxFloat, -maxFloat, -maxFloat);
+    }
+
+    void growBounds(Submesh& submesh, const MeshVertex& vertex)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            submesh.boundsMin[c] = std::min(submesh.boundsMin[c], vertex.pos[c]);
+            submesh.boundsMax[c] = std::max(submesh.boundsMax[c], vertex.pos[c]);
+        }
+    }
+
+    /// Move every triangle of indices to the next free triangle of its material's range.
+    /// ranges has one entry per material + 1, its indexOffset is the first triangle of the
+    /// range on entry.
+    template <typename Index>
+    void scatterTriangles(std::vector<Index>& indices, const std::vector<TriangleRun<std::int32_t>>& materialRuns,
+                          const std::vector<MeshVertex>& vertices, std::vector<Submesh>& ranges)
+    {
+        std::vector<std::uint32_t> next(ranges.size());
+        for (size_t i = 0; i < ranges.size(); i++)
+        {
+            next[i] = ranges[i].indexOffset;
+        }
+
+        // The triangles of a run stay together
+        const size_t triangleCount = indices.size() / 3;
+        std::vector<Index> sorted(indices.size());
+        for (size_t r = 0; r < materialRuns.size(); r++)
+        {
+            const size_t material = size_t(materialRuns[r].value + 1);
+            const size_t first = materialRuns[r].firstTriangle;
+            const size_t count = getRunEnd(materialRuns, r, triangleCount) - first;
+            Submesh& range = ranges[material];
+            const size_t to = 3 * size_t(next[material]);
+            next[material] += static_cast<std::uint32_t>(count);
+            for (size_t i = 0; i < 3 * count; i++)
+            {
+                Index v = indices[3 * first + i];
+                sorted[to + i] = v;
+                growBounds(range, vertices[v]);
+            }
+        }
+        indices.swap(sorted);
+    }
+}
+
+
+bool
+MeshPartitioner::partition(Mesh& mesh, const std::vector<TriangleRun<std::int32_t>>& materialRuns)
+{
+    const size_t triangleCount = mesh.getIndexCount() / 3;
+    if (triangleCount == 0 || !mesh.lods.empty() || !isValidTriangleRuns(materialRuns, triangleCount) ||
+        mesh.getIndexCount() > std::numeric_limits<std::uint32_t>::max())
+    {
+        return false;
+    }
+
+    std::int32_t maxMaterial = -1;
+    for (const TriangleRun<std::int32_t>& run : materialRuns)
+    {
+        if (run.value < -1 || run.value >= MAX_MATERIALS)
+        {
+            return false;
+        }
+        maxMaterial = std::max(maxMaterial, run.value);
+    }
+
+    // Count the triangles of every material, -1 included, and give each its range
+    std::vector<Submesh> ranges(size_t(maxMaterial) + 2);
+    for (size_t r = 0; r < materialRuns.size(); r++)
+    {
+        const size_t count = getRunEnd(materialRuns, r, triangleCount) - materialRuns[r].firstTriangle;
+        ranges[size_t(materialRuns[r].value + 1)].indexCount += static_cast<std::uint32_t>(count);
+    }
+    std::uint32_t first = 0;
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        Submesh& range = ranges[i];
+        range.indexOffset = first;
+        range.material = static_cast<std::int32_t>(i) - 1;
+        range.lod = 0;
+        resetBounds(range);
+        first += range.indexCount;
+    }
+
+    if (!mesh.indices16.empty())
+    {
+        scatterTriangles(mesh.indices16, materialRuns, mesh.vertices, ranges);
+    }
+    else
+    {
+        scatterTriangles(mesh.indices32, materialRuns, mesh.vertices, ranges);
+    }
+
+    // The ranges were counted in triangles
+    mesh.submeshes.clear();
+    for (Submesh& range : ranges)
+    {
+        if (range.indexCount > 0)
+        {
+            range.indexOffset *= 3;
+            range.indexCount *= 3;
+            mesh.submeshes.push_back(range);
+        }
+    }
+    return true;
+}
+
+
+void
+MeshPartitioner::computeBounds(const std::vector<MeshVertex>& vertices, const std::uint32_t* indices,
+                               size_t indexCount, Submesh& submesh)
+{
+    resetBounds(submesh);
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        growBounds(submesh, vertices[indices[i]]);
+    }
+}
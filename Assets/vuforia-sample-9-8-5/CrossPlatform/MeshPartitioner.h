@@ -0,0 +1,48 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_PARTITIONER_H__
+#define __MESH_PARTITIONER_H__
+
+#include "MeshCache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// Groups the triangles of a mesh by material, so each material is drawn with one call
+/**
+ * The triangles of all the shapes of a model are sorted by material with a counting
+ * sort: the triangles of each material are counted, the counts give every material its
+ * range of the index array, and one linear pass moves each triangle into its range and
+ * grows the bounds of the range. The sort is stable, the triangles of a material keep
+ * their order, and so the locality MeshBuilder gave them.
+ * MeshOptimizer and MeshSimplifier keep the ranges: they reorder and simplify the
+ * triangles of each submesh on their own.
+ */
+namespace MeshPartitioner
+{
+    /// Largest material count accepted, the sort has a counter for every material up to
+    /// the largest one used
+    constexpr std::int32_t MAX_MATERIALS = 1 << 16;
+
+    /// Sort the triangles of mesh by material and replace mesh.submeshes with a range for
+    /// every material used, faces without a material first. materialRuns has the material
+    /// runs of the triangles, -1 for none, as built by MeshBuilder.
+    /// Run this before MeshOptimizer::optimize and MeshSimplifier::buildLods.
+    /// Returns false, and leaves mesh alone, if the mesh is not indexed or already has
+    /// levels of detail, or if materialRuns are not valid runs of valid materials for the
+    /// triangles.
+    bool partition(Mesh& mesh, const std::vector<TriangleRun<std::int32_t>>& materialRuns);
+
+    /// Set the bounds of submesh to the vertices used by indexCount indices
+    void computeBounds(const std::vector<MeshVertex>& vertices, const std::uint32_t* indices, size_t indexCount,
+                       Submesh& submesh);
+}
+
+#endif // __MESH_PARTITIONER_H__
@@ -0,0 +1,352 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshQuantizer.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// vcvtnq_s32_f32, rounding to nearest like the scalar code, needs ARMv8
+#if defined(SIMD_USE_NEON) && (defined(_M_ARM64) || defined(__aarch64__))
+#define MESH_QUANTIZER_USE_NEON 1
+#endif
+
+
+namespace
+{
+    constexpr float SNORM16_MAX = 32767.0f;
+    constexpr float UNORM16_MAX = 65535.0f;
+    constexpr float SNORM8_MAX = 127.0f;
+
+    /// Factors that map the vertex attributes to the quantized range
+    struct EncodeParams
+    {
+        float positionOffset[3];
+        float positionFactor[3];
+        float texcoordOffset[2];
+        float texcoordFactor[2];
+    };
+
+    float getFactor(float range, float max)
+    {
+        return range > 0.0f ? max / range : 0.0f;
+    }
+
+    /// Round to nearest, ties to even like the SIMD conversions
+    std::int32_t roundToInt(float value)
+    {
+        return static_cast<std::int32_t>(std::nearbyint(value));
+    }
+
+    void encodeScalar(const MeshVertex& vertex, const EncodeParams& encode, std::int16_t normal,
+                      QuantizedVertex& quantized)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            float q = (vertex.pos[c] - encode.positionOffset[c]) * encode.positionFactor[c];
+            q = std::min(std::max(q, -SNORM16_MAX), SNORM16_MAX);
+            quantized.pos[c] = static_cast<std::int16_t>(roundToInt(q));
+        }
+        quantized.normal = normal;
+        for (int c = 0; c < 2; c++)
+        {
+            float q = (vertex.texcoord[c] - encode.texcoordOffset[c]) * encode.texcoordFactor[c];
+            q = std::min(std::max(q, 0.0f), UNORM16_MAX);
+            quantized.texcoord[c] = static_cast<std::uint16_t>(roundToInt(q));
+        }
+    }
+
+    /// Encode vertices[0] ... vertices[count - 1], normals is null or has count encoded normals.
+    /// Every vertex is handled as (x, y, z, u) and (u, v) vectors, the results are packed
+    /// into one 16 byte vector of which the first 12 bytes are stored.
+    void encodeVertices(const MeshVertex* vertices, size_t count, const std::int16_t* normals,
+                        const EncodeParams& encode, QuantizedVertex* quantized)
+    {
+        size_t i = 0;
+
+#if defined(SIMD_USE_SSE)
+        // The fourth lane of the position is multiplied by 0 and gives 0
+        const __m128 positionOffset = _mm_setr_ps(encode.positionOffset[0], encode.positionOffset[1], encode.positionOffset[2], 0.0f);
+        const __m128 positionFactor = _mm_setr_ps(encode.positionFactor[0], encode.positionFactor[1], encode.positionFactor[2], 0.0f);
+        const __m128 texcoordOffset = _mm_setr_ps(encode.texcoordOffset[0], encode.texcoordOffset[1], 0.0f, 0.0f);
+        const __m128 texcoordFactor = _mm_setr_ps(encode.texcoordFactor[0], encode.texcoordFactor[1], 0.0f, 0.0f);
+        const __m128 snormMax = _mm_set1_ps(SNORM16_MAX);
+        const __m128 snormMin = _mm_set1_ps(-SNORM16_MAX);
+        const __m128 unormMax = _mm_set1_ps(UNORM16_MAX);
+        // SSE2 only packs with signed saturation, texture coordinates are packed biased by -32768
+        const __m128i unormBias = _mm_set1_epi32(32768);
+        const __m128i unormFlip = _mm_setr_epi16(0, 0, 0, 0, -32768, -32768, 0, 0);
+
+        for (; i < count; i++)
+        {
+            // pos and texcoord are adjacent, the 16 bytes from pos are x, y, z, u
+            const __m128 pos = _mm_loadu_ps(vertices[i].pos);
+            // movq, which unlike _mm_load_sd through a double* may read from 4 byte aligned memory
+            const __m128 texcoord = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(vertices[i].texcoord)));
+
+            __m128 qp = _mm_mul_ps(_mm_sub_ps(pos, positionOffset), positionFactor);
+            qp = _mm_min_ps(_mm_max_ps(qp, snormMin), snormMax);
+            __m128 qt = _mm_mul_ps(_mm_sub_ps(texcoord, texcoordOffset), texcoordFactor);
+            qt = _mm_min_ps(_mm_max_ps(qt, _mm_setzero_ps()), unormMax);
+
+            const __m128i ip = _mm_cvtps_epi32(qp);
+            const __m128i it = _mm_sub_epi32(_mm_cvtps_epi32(qt), unormBias);
+            __m128i packed = _mm_xor_si128(_mm_packs_epi32(ip, it), unormFlip);
+            if (normals != nullptr)
+            {
+                packed = _mm_insert_epi16(packed, normals[i], 3);
+            }
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(quantized[i].pos), packed);
+            std::int32_t texcoords = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+            std::memcpy(quantized[i].texcoord, &texcoords, sizeof(texcoords));
+        }
+#elif defined(MESH_QUANTIZER_USE_NEON)
+        const float positionOffsetData[4] = { encode.positionOffset[0], encode.positionOffset[1], encode.positionOffset[2], 0.0f };
+        const float positionFactorData[4] = { encode.positionFactor[0], encode.positionFactor[1], encode.positionFactor[2], 0.0f };
+        const float32x4_t positionOffset = vld1q_f32(positionOffsetData);
+        const float32x4_t positionFactor = vld1q_f32(positionFactorData);
+        const float32x2_t texcoordOffset = vld1_f32(encode.texcoordOffset);
+        const float32x2_t texcoordFactor = vld1_f32(encode.texcoordFactor);
+        const float32x4_t snormMax = vdupq_n_f32(SNORM16_MAX);
+        const float32x4_t snormMin = vdupq_n_f32(-SNORM16_MAX);
+        const float32x2_t unormMax = vdup_n_f32(UNORM16_MAX);
+
+        for (; i < count; i++)
+        {
+            // pos and texcoord are adjacent, the 16 bytes from pos are x, y, z, u
+            const float32x4_t pos = vld1q_f32(vertices[i].pos);
+            const float32x2_t texcoord = vld1_f32(vertices[i].texcoord);
+
+            float32x4_t qp = vmulq_f32(vsubq_f32(pos, positionOffset), positionFactor);
+            qp = vminq_f32(vmaxq_f32(qp, snormMin), snormMax);
+            float32x2_t qt = vmul_f32(vsub_f32(texcoord, texcoordOffset), texcoordFactor);
+            qt = vmin_f32(vmax_f32(qt, vdup_n_f32(0.0f)), unormMax);
+
+            int16x4_t ip = vqmovn_s32(vcvtnq_s32_f32(qp));
+            if (normals != nullptr)
+            {
+                ip = vset_lane_s16(normals[i], ip, 3);
+            }
+            const uint16x4_t it = vqmovun_s32(vcombine_s32(vcvtn_s32_f32(qt), vdup_n_s32(0)));
+
+            vst1_s16(quantized[i].pos, ip);
+            std::uint32_t texcoords = vget_lane_u32(vreinterpret_u32_u16(it), 0);
+            std::memcpy(quantized[i].texcoord, &texcoords, sizeof(texcoords));
+        }
+#endif
+
+        for (; i < count; i++)
+        {
+            encodeScalar(vertices[i], encode, normals != nullptr ? normals[i] : 0, quantized[i]);
+        }
+    }
+
+    float signNotZero(float value)
+    {
+        return value >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    /// Fold the lower hemisphere of the octahedron over the upper one, and back
+    void foldOctahedron(float& u, float& v)
+    {
+        float foldedU = (1.0f - std::fabs(v)) * signNotZero(u);
+        float foldedV = (1.0f - std::fabs(u)) * signNotZero(v);
+        u = foldedU;
+        v = foldedV;
+    }
+
+    std::int16_t packNormal(std::int32_t x, std::int32_t y)
+    {
+        return static_cast<std::int16_t>(static_cast<std::uint16_t>((x & 0xFF) | ((y & 0xFF) << 8)));
+    }
+
+    float getAngle(const SampleMath::Vec3& a, const SampleMath::Vec3& b)
+    {
+        float c = SampleMath::dot(a, b) / std::max(SampleMath::length(a) * SampleMath::length(b), FLT_MIN);
+        return std::acos(std::min(std::max(c, -1.0f), 1.0f)) * (180.0f / 3.14159265f);
+    }
+}
+
+
+void
+MeshQuantizer::quantize(const MeshVertex* vertices, size_t numVertices, const SampleMath::Vec3* normals,
+                        const SampleMath::Vec3& boundsMin, const SampleMath::Vec3& boundsMax,
+                        std::vector<QuantizedVertex>& quantized, QuantizationParams& params)
+{
+    float texcoordMin[2] = { 0.0f, 0.0f };
+    float texcoordMax[2] = { 0.0f, 0.0f };
+    if (numVertices > 0)
+    {
+        texcoordMin[0] = texcoordMax[0] = vertices[0].texcoord[0];
+        texcoordMin[1] = texcoordMax[1] = vertices[0].texcoord[1];
+    }
+    for (size_t i = 1; i < numVertices; i++)
+    {
+        for (int c = 0; c < 2; c++)
+        {
+            texcoordMin[c] = std::min(texcoordMin[c], vertices[i].texcoord[c]);
+            texcoordMax[c] = std::max(texcoordMax[c], vertices[i].texcoord[c]);
+        }
+    }
+
+    EncodeParams encode;
+    params.positionOffset = (boundsMin + boundsMax) * 0.5f;
+    params.positionScale = (boundsMax - boundsMin) * 0.5f;
+    for (int c = 0; c < 3; c++)
+    {
+        encode.positionOffset[c] = params.positionOffset[c];
+        encode.positionFactor[c] = getFactor(params.positionScale[c], SNORM16_MAX);
+    }
+    for (int c = 0; c < 2; c++)
+    {
+        params.texcoordOffset[c] = texcoordMin[c];
+        params.texcoordScale[c] = texcoordMax[c] - texcoordMin[c];
+        encode.texcoordOffset[c] = params.texcoordOffset[c];
+        encode.texcoordFactor[c] = getFactor(params.texcoordScale[c], UNORM16_MAX);
+    }
+    params.hasNormals = (normals != nullptr);
+
+    std::vector<std::int16_t> encodedNormals;
+    if (normals != nullptr)
+    {
+        encodedNormals.resize(numVertices);
+        for (size_t i = 0; i < numVertices; i++)
+        {
+            encodedNormals[i] = encodeNormal(normals[i]);
+        }
+    }
+
+    quantized.resize(numVertices);
+    encodeVertices(vertices, numVertices, normals != nullptr ? encodedNormals.data() : nullptr,
+                   encode, quantized.data());
+}
+
+
+MeshVertex
+MeshQuantizer::dequantize(const QuantizedVertex& vertex, const QuantizationParams& params)
+{
+    // Snorm -32768 and -32767 both read as -1
+    MeshVertex result;
+    for (int c = 0; c < 3; c++)
+    {
+        float value = std::max(float(vertex.pos[c]) / SNORM16_MAX, -1.0f);
+        result.pos[c] = params.positionOffset[c] + params.positionScale[c] * value;
+    }
+    for (int c = 0; c < 2; c++)
+    {
+        float value = float(vertex.texcoord[c]) / UNORM16_MAX;
+        result.texcoord[c] = params.texcoordOffset[c] + params.texcoordScale[c] * value;
+    }
+    return result;
+}
+
+
+std::int16_t
+MeshQuantizer::encodeNormal(const SampleMath::Vec3& normal)
+{
+    // Project onto the octahedron |x| + |y| + |z| = 1
+    float l1 = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+    if (!(l1 > 0.0f))
+    {
+        return 0;
+    }
+    float u = normal[0] / l1;
+    float v = normal[1] / l1;
+    if (normal[2] < 0.0f)
+    {
+        foldOctahedron(u, v);
+    }
+    u = std::min(std::max(u, -1.0f), 1.0f) * SNORM8_MAX;
+    v = std::min(std::max(v, -1.0f), 1.0f) * SNORM8_MAX;
+
+    // Rounding to nearest is not always closest on the sphere, try the four neighbors
+    std::int16_t best = 0;
+    float bestAngle = std::numeric_limits<float>::max();
+    for (int i = 0; i < 4; i++)
+    {
+        std::int32_t x = static_cast<std::int32_t>((i & 1) ? std::ceil(u) : std::floor(u));
+        std::int32_t y = static_cast<std::int32_t>((i & 2) ? std::ceil(v) : std::floor(v));
+        std::int16_t candidate = packNormal(x, y);
+        float angle = getAngle(normal, decodeNormal(candidate));
+        if (angle < bestAngle)
+        {
+            bestAngle = angle;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+
+SampleMath::Vec3
+MeshQuantizer::decodeNormal(std::int16_t normal)
+{
+    std::int8_t x = static_cast<std::int8_t>(normal & 0xFF);
+    std::int8_t y = static_cast<std::int8_t>((normal >> 8) & 0xFF);
+    float u = std::max(float(x) / SNORM8_MAX, -1.0f);
+    float v = std::max(float(y) / SNORM8_MAX, -1.0f);
+    float z = 1.0f - std::fabs(u) - std::fabs(v);
+    if (z < 0.0f)
+    {
+        foldOctahedron(u, v);
+    }
+
+    SampleMath::Vec3 result(u, v, z);
+    return result * (1.0f / SampleMath::length(result));
+}
+
+
+QuantizationError
+MeshQuantizer::getErrorBound(const QuantizationParams& params)
+{
+    // Half a step for rounding, plus the float rounding of encode and decode
+    QuantizationError bound;
+    for (int c = 0; c < 3; c++)
+    {
+        float step = params.positionScale[c] / SNORM16_MAX;
+        float rounding = 4.0f * FLT_EPSILON * (std::fabs(params.positionOffset[c]) + params.positionScale[c]);
+        bound.position = std::max(bound.position, (0.5f + 1.0f / 64.0f) * step + rounding);
+    }
+    for (int c = 0; c < 2; c++)
+    {
+        float step = params.texcoordScale[c] / UNORM16_MAX;
+        float rounding = 4.0f * FLT_EPSILON * (std::fabs(params.texcoordOffset[c]) + params.texcoordScale[c]);
+        bound.texcoord = std::max(bound.texcoord, (0.5f + 1.0f / 64.0f) * step + rounding);
+    }
+    return bound;
+}
+
+
+QuantizationError
+MeshQuantizer::measureError(const MeshVertex* vertices, size_t numVertices, const SampleMath::Vec3* normals,
+                            const std::vector<QuantizedVertex>& quantized, const QuantizationParams& params)
+{
+    QuantizationError error;
+    size_t count = std::min(numVertices, quantized.size());
+    for (size_t i = 0; i < count; i++)
+    {
+        MeshVertex decoded = dequantize(quantized[i], params);
+        for (int c = 0; c < 3; c++)
+        {
+            error.position = std::max(error.position, std::fabs(decoded.pos[c] - vertices[i].pos[c]));
+        }
+        for (int c = 0; c < 2; c++)
+        {
+            error.texcoord = std::max(error.texcoord, std::fabs(decoded.texcoord[c] - vertices[i].texcoord[c]));
+        }
+        if (normals != nullptr && params.hasNormals)
+        {
+            error.normal = std::max(error.normal, getAngle(normals[i], decodeNormal(quantized[i].normal)));
+        }
+    }
+    return error;
+}
@@ -0,0 +1,95 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_QUANTIZER_H__
+#define __MESH_QUANTIZER_H__
+
+#include "MeshCache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// Quantized MeshVertex, 12 bytes instead of 20
+/**
+ * pos and normal are read as one four component 16 bit snorm attribute, texcoord as a
+ * two component 16 bit unorm attribute. There is no three component 16 bit format, the
+ * fourth component holds the octahedral encoded normal, or 0 if the mesh has none.
+ */
+struct QuantizedVertex
+{
+    /// Position in the bounding box of the mesh, -32767 ... 32767
+    std::int16_t pos[3];
+    /// Octahedral normal, two snorm8 values: x in the low byte, y in the high byte
+    std::int16_t normal;
+    /// Texture coordinate in the texture coordinate range of the mesh, 0 ... 65535
+    std::uint16_t texcoord[2];
+};
+
+static_assert(sizeof(QuantizedVertex) == 12, "QuantizedVertex is a vertex buffer layout");
+
+/// Maps quantized vertices back to the mesh:
+/// pos = positionOffset + positionScale * snorm(q), texcoord = texcoordOffset + texcoordScale * unorm(q)
+struct QuantizationParams
+{
+    /// Center of the bounding box
+    SampleMath::Vec3 positionOffset;
+    /// Half the size of the bounding box
+    SampleMath::Vec3 positionScale;
+    float texcoordOffset[2] = { 0.0f, 0.0f };
+    float texcoordScale[2] = { 0.0f, 0.0f };
+    bool hasNormals = false;
+};
+
+/// Largest difference between the vertices of a mesh and their quantized version
+struct QuantizationError
+{
+    /// Per coordinate, in model units
+    float position = 0.0f;
+    /// Per coordinate
+    float texcoord = 0.0f;
+    /// Angle between the normals, in degrees
+    float normal = 0.0f;
+};
+
+/// Quantizes mesh vertices for the GPU
+/**
+ * Positions are stored relative to the bounding box of the mesh and texture coordinates
+ * relative to their range, so the full 16 bits are spent on the space the mesh uses.
+ * Rounding to the nearest value bounds the error to half a step: half the box size / 65534
+ * for positions and the texture coordinate range / 131070 for texture coordinates.
+ * Normals are octahedral encoded in two bytes.
+ * The encoding uses SSE2 or ARM64 NEON where available, and rounds the same way as the
+ * scalar code.
+ */
+namespace MeshQuantizer
+{
+    /// Quantize numVertices vertices inside the bounds boundsMin ... boundsMax.
+    /// normals is null, or has numVertices unit length normals.
+    void quantize(const MeshVertex* vertices, size_t numVertices, const SampleMath::Vec3* normals,
+                  const SampleMath::Vec3& boundsMin, const SampleMath::Vec3& boundsMax,
+                  std::vector<QuantizedVertex>& quantized, QuantizationParams& params);
+
+    /// Decode a quantized vertex the way the GPU reads it
+    MeshVertex dequantize(const QuantizedVertex& vertex, const QuantizationParams& params);
+
+    /// Octahedral encode a unit length normal
+    std::int16_t encodeNormal(const SampleMath::Vec3& normal);
+
+    /// Decode an octahedral encoded normal, the result has unit length
+    SampleMath::Vec3 decodeNormal(std::int16_t normal);
+
+    /// Largest error the quantization of params can cause in positions and texture coordinates
+    QuantizationError getErrorBound(const QuantizationParams& params);
+
+    /// Measure the largest error of quantized against the vertices and normals it was made from
+    QuantizationError measureError(const MeshVertex* vertices, size_t numVertices, const SampleMath::Vec3* normals,
+                                   const std::vector<QuantizedVertex>& quantized, const QuantizationParams& params);
+}
+
+#endif // __MESH_QUANTIZER_H__
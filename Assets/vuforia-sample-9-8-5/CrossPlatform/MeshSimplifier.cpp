@@ -0,0 +1,929 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "MeshPartitioner.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+
+namespace
+{
+    constexpr std::uint32_t NO_VERTEX = std::numeric_limits<std::uint32_t>::max();
+    /// Open edge link of a vertex with more than one open edge
+    constexpr std::uint32_t MANY_VERTICES = NO_VERTEX - 1;
+
+    /// Weight of the planes that keep borders and seams in place, relative to the surface
+    constexpr double BORDER_WEIGHT = 10.0;
+
+    /// A collapse is skipped if it turns a triangle normal by more than about 75 degrees
+    constexpr float MIN_NORMAL_COSINE = 0.25f;
+
+    enum class VertexKind : std::uint8_t
+    {
+        /// Inside the mesh, the only vertex at its position
+        Manifold,
+        /// On one border of the mesh, collapses along it
+        Border,
+        /// One of two vertices at a texture seam, collapses along the seam with the other
+        Seam,
+        /// Never moves
+        Locked,
+    };
+
+    /// Quadric error of the distance to a set of weighted planes, normalized by their weight
+    struct Quadric
+    {
+        double a00 = 0.0, a11 = 0.0, a22 = 0.0, a01 = 0.0, a02 = 0.0, a12 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+        double c = 0.0;
+        double weight = 0.0;
+
+        /// Add the plane n.p + d = 0, n of unit length
+        void addPlane(const SampleMath::Vec3& n, float d, double w)
+        {
+            a00 += w * n[0] * n[0];
+            a11 += w * n[1] * n[1];
+            a22 += w * n[2] * n[2];
+            a01 += w * n[0] * n[1];
+            a02 += w * n[0] * n[2];
+            a12 += w * n[1] * n[2];
+            b0 += w * n[0] * d;
+            b1 += w * n[1] * d;
+            b2 += w * n[2] * d;
+            c += w * double(d) * d;
+            weight += w;
+        }
+
+        void add(const Quadric& q)
+        {
+            a00 += q.a00; a11 += q.a11; a22 += q.a22;
+            a01 += q.a01; a02 += q.a02; a12 += q.a12;
+            b0 += q.b0; b1 += q.b1; b2 += q.b2;
+            c += q.c;
+            weight += q.weight;
+        }
+
+        /// Weighted mean of the squared distances of p to the planes
+        double getError(const SampleMath::Vec3& p) const
+        {
+            double x = p[0], y = p[1], z = p[2];
+            double r = a00 * x * x + a11 * y * y + a22 * z * z +
+                       2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                       2.0 * (b0 * x + b1 * y + b2 * z) + c;
+            return weight > 0.0 ? std::max(r, 0.0) / weight : 0.0;
+        }
+    };
+
+    /// Triangles using each vertex: the triangles of vertex v are
+    /// triangles[offsets[v]] ... triangles[offsets[v + 1] - 1]
+    struct VertexTriangles
+    {
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint32_t> triangles;
+
+        /// vertexOf maps the indices to the vertices the triangles are listed for
+        void build(const std::vector<std::uint32_t>& indices, const std::vector<std::uint32_t>& vertexOf)
+        {
+            offsets.assign(vertexOf.size() + 1, 0);
+            triangles.resize(indices.size());
+            for (std::uint32_t i : indices)
+            {
+                offsets[vertexOf[i] + 1]++;
+            }
+            for (size_t v = 0; v < vertexOf.size(); v++)
+            {
+                offsets[v + 1] += offsets[v];
+            }
+            std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                triangles[fill[vertexOf[indices[i]]]++] = static_cast<std::uint32_t>(i / 3);
+            }
+        }
+    };
+
+    struct PositionKey
+    {
+        std::uint32_t bits[3];
+
+        bool operator==(const PositionKey& other) const
+        {
+            return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+        }
+    };
+
+    struct PositionKeyHash
+    {
+        size_t operator()(const PositionKey& key) const
+        {
+            std::uint64_t h = (std::uint64_t(key.bits[0]) << 32 | key.bits[1]) * 0x9E3779B97F4A7C15ULL;
+            h = (h ^ key.bits[2]) * 0xC2B2AE3D27D4EB4FULL;
+            return static_cast<size_t>(h ^ (h >> 31));
+        }
+    };
+
+    bool isSingle(std::uint32_t link)
+    {
+        return link != NO_VERTEX && link != MANY_VERTICES;
+    }
+
+    /// Squared distance from p to the triangle abc ("Real-Time Collision Detection",
+    /// Ericson, 2005, 5.1.5)
+    float getTriangleDistance2(const SampleMath::Vec3& p, const SampleMath::Vec3& a, const SampleMath::Vec3& b,
+                               const SampleMath::Vec3& c)
+    {
+        SampleMath::Vec3 ab = b - a;
+        SampleMath::Vec3 ac = c - a;
+        SampleMath::Vec3 closest;
+
+        float d1 = SampleMath::dot(ab, p - a);
+        float d2 = SampleMath::dot(ac, p - a);
+        float d3 = SampleMath::dot(ab, p - b);
+        float d4 = SampleMath::dot(ac, p - b);
+        float d5 = SampleMath::dot(ab, p - c);
+        float d6 = SampleMath::dot(ac, p - c);
+        float va = d3 * d6 - d5 * d4;
+        float vb = d5 * d2 - d1 * d6;
+        float vc = d1 * d4 - d3 * d2;
+        if (d1 <= 0.0f && d2 <= 0.0f)
+        {
+            closest = a;
+        }
+        else if (d3 >= 0.0f && d4 <= d3)
+        {
+            closest = b;
+        }
+        else if (d6 >= 0.0f && d5 <= d6)
+        {
+            closest = c;
+        }
+        else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        {
+            closest = a + ab * (d1 / (d1 - d3));
+        }
+        else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        {
+            closest = a + ac * (d2 / (d2 - d6));
+        }
+        else if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+        {
+            closest = b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+        else if (va + vb + vc > 0.0f)
+        {
+            closest = a + ab * (vb / (va + vb + vc)) + ac * (vc / (va + vb + vc));
+        }
+        else
+        {
+            // Degenerate, the edges above already cover it up to rounding
+            closest = a;
+        }
+        SampleMath::Vec3 d = p - closest;
+        return SampleMath::dot(d, d);
+    }
+
+    /// Edge collapses of an indexed triangle list, run in passes of independent collapses
+    class Simplifier
+    {
+    public:
+        /// triangleTags is empty, or has a value for every triangle that follows it through
+        /// the collapses
+        Simplifier(const std::vector<MeshVertex>& vertices, const std::vector<std::uint32_t>& indices,
+                   const std::vector<std::uint32_t>& triangleTags = {});
+
+        /// Collapse edges until at most targetIndexCount indices are left, or no collapse
+        /// within maxError is left. Returns the error so far.
+        float run(size_t targetIndexCount, float maxError);
+
+        /// How far the triangles left are from the input: the largest distance from a vertex
+        /// of the input to the triangles at the position it collapsed into, in model units.
+        /// Those triangles cover what the collapses removed around the vertex, so this bounds
+        /// the distance from the input vertices to the simplified surface from above.
+        float measureDeviation() const;
+
+        const std::vector<std::uint32_t>& getIndices() const { return mIndices; }
+        /// Tags of the triangles left, in the order of getIndices
+        const std::vector<std::uint32_t>& getTriangleTags() const { return mTags; }
+
+    private:
+        struct Collapse
+        {
+            std::uint32_t from;
+            std::uint32_t to;
+            double cost;
+        };
+
+        SampleMath::Vec3 position(std::uint32_t v) const
+        {
+            return SampleMath::Vec3(mVertices[v].pos[0], mVertices[v].pos[1], mVertices[v].pos[2]);
+        }
+
+        void weldPositions();
+        void classifyVertices();
+        void computeQuadrics();
+        bool canCollapse(std::uint32_t from, std::uint32_t to) const;
+        /// False if moving the position welded from onto to flips a triangle. Counts the
+        /// triangles the collapse removes.
+        bool checkTriangles(std::uint32_t from, std::uint32_t to, size_t& removed) const;
+        void relinkOpenEdges(std::uint32_t from, std::uint32_t to);
+        size_t runPass(size_t targetIndexCount, double maxCost);
+
+        const std::vector<MeshVertex>& mVertices;
+        std::vector<std::uint32_t> mIndices;
+        std::vector<std::uint32_t> mTags;
+        /// Vertices used by the input
+        std::vector<bool> mInputVertices;
+
+        /// First vertex at the position of each vertex
+        std::vector<std::uint32_t> mRemap;
+        /// Next vertex at the same position, a circular list
+        std::vector<std::uint32_t> mWedge;
+        std::vector<VertexKind> mKind;
+        /// The other end of the open edge starting or ending at a vertex, in vertex indices
+        std::vector<std::uint32_t> mOpenOut;
+        std::vector<std::uint32_t> mOpenIn;
+        /// Open edges of the input, by the index of their first vertex
+        std::vector<std::uint32_t> mOpenEdges;
+        /// Per position
+        std::vector<Quadric> mQuadrics;
+
+        /// Per pass state
+        VertexTriangles mAdjacency;
+        std::vector<bool> mLocked;
+        std::vector<std::uint32_t> mCollapseTo;
+
+        double mError = 0.0;
+    };
+
+
+    Simplifier::Simplifier(const std::vector<MeshVertex>& vertices, const std::vector<std::uint32_t>& indices,
+                           const std::vector<std::uint32_t>& triangleTags)
+        : mVertices(vertices), mIndices(indices), mTags(triangleTags)
+    {
+        mInputVertices.assign(mVertices.size(), false);
+        for (std::uint32_t v : mIndices)
+        {
+            mInputVertices[v] = true;
+        }
+
+        weldPositions();
+        classifyVertices();
+        computeQuadrics();
+
+        mCollapseTo.resize(mVertices.size());
+        for (size_t v = 0; v < mVertices.size(); v++)
+        {
+            mCollapseTo[v] = static_cast<std::uint32_t>(v);
+        }
+    }
+
+
+    void Simplifier::weldPositions()
+    {
+        const size_t vertexCount = mVertices.size();
+        mRemap.resize(vertexCount);
+        mWedge.resize(vertexCount);
+
+        std::unordered_map<PositionKey, std::uint32_t, PositionKeyHash> firstAtPosition;
+        firstAtPosition.reserve(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            PositionKey key;
+            std::memcpy(key.bits, mVertices[v].pos, sizeof(key.bits));
+            auto inserted = firstAtPosition.emplace(key, static_cast<std::uint32_t>(v));
+            std::uint32_t first = inserted.first->second;
+
+            mRemap[v] = first;
+            mWedge[v] = static_cast<std::uint32_t>(v);
+            if (first != v)
+            {
+                mWedge[v] = mWedge[first];
+                mWedge[first] = static_cast<std::uint32_t>(v);
+            }
+        }
+    }
+
+
+    void Simplifier::classifyVertices()
+    {
+        const size_t vertexCount = mVertices.size();
+        std::vector<std::uint32_t> identity(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            identity[v] = static_cast<std::uint32_t>(v);
+        }
+        VertexTriangles adjacency;
+        adjacency.build(mIndices, identity);
+
+        // An edge is open if no triangle has it the other way around
+        auto hasEdge = [&](std::uint32_t a, std::uint32_t b)
+        {
+            for (std::uint32_t k = adjacency.offsets[a]; k < adjacency.offsets[a + 1]; k++)
+            {
+                const std::uint32_t* t = &mIndices[3 * size_t(adjacency.triangles[k])];
+                for (int c = 0; c < 3; c++)
+                {
+                    if (t[c] == a && t[(c + 1) % 3] == b)
+                    {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+
+        mOpenOut.assign(vertexCount, NO_VERTEX);
+        mOpenIn.assign(vertexCount, NO_VERTEX);
+        for (size_t i = 0; i < mIndices.size(); i += 3)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                std::uint32_t a = mIndices[i + c];
+                std::uint32_t b = mIndices[i + (c + 1) % 3];
+                if (!hasEdge(b, a))
+                {
+                    mOpenEdges.push_back(static_cast<std::uint32_t>(i + c));
+                    mOpenOut[a] = (mOpenOut[a] == NO_VERTEX) ? b : MANY_VERTICES;
+                    mOpenIn[b] = (mOpenIn[b] == NO_VERTEX) ? a : MANY_VERTICES;
+                }
+            }
+        }
+
+        mKind.assign(vertexCount, VertexKind::Locked);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            std::uint32_t w = mWedge[v];
+            if (w == v)
+            {
+                if (mOpenOut[v] == NO_VERTEX && mOpenIn[v] == NO_VERTEX)
+                {
+                    mKind[v] = VertexKind::Manifold;
+                }
+                else if (isSingle(mOpenOut[v]) && isSingle(mOpenIn[v]))
+                {
+                    mKind[v] = VertexKind::Border;
+                }
+            }
+            else if (mWedge[w] == v)
+            {
+                // The open edges of both vertices are the two sides of the same seam
+                if (isSingle(mOpenOut[v]) && isSingle(mOpenIn[v]) && isSingle(mOpenOut[w]) && isSingle(mOpenIn[w]) &&
+                    mRemap[mOpenOut[v]] == mRemap[mOpenIn[w]] && mRemap[mOpenIn[v]] == mRemap[mOpenOut[w]])
+                {
+                    mKind[v] = VertexKind::Seam;
+                }
+            }
+        }
+    }
+
+
+    void Simplifier::computeQuadrics()
+    {
+        mQuadrics.assign(mVertices.size(), Quadric());
+
+        for (size_t i = 0; i < mIndices.size(); i += 3)
+        {
+            const std::uint32_t* t = &mIndices[i];
+            SampleMath::Vec3 p0 = position(t[0]);
+            SampleMath::Vec3 p1 = position(t[1]);
+            SampleMath::Vec3 p2 = position(t[2]);
+
+            SampleMath::Vec3 normal = SampleMath::cross(p1 - p0, p2 - p0);
+            float length = SampleMath::length(normal);
+            if (length <= 0.0f)
+            {
+                continue;
+            }
+            normal = normal * (1.0f / length);
+
+            // Weighted by area
+            Quadric plane;
+            plane.addPlane(normal, -SampleMath::dot(normal, p0), 0.5 * length);
+            for (int c = 0; c < 3; c++)
+            {
+                mQuadrics[mRemap[t[c]]].add(plane);
+            }
+        }
+
+        // Planes through the open edges, at right angles to their triangle
+        for (std::uint32_t e : mOpenEdges)
+        {
+            size_t first = e - e % 3;
+            std::uint32_t a = mIndices[e];
+            std::uint32_t b = mIndices[first + (e - first + 1) % 3];
+            std::uint32_t c = mIndices[first + (e - first + 2) % 3];
+
+            SampleMath::Vec3 edge = position(b) - position(a);
+            SampleMath::Vec3 normal = SampleMath::cross(edge, position(c) - position(a));
+            SampleMath::Vec3 edgeNormal = SampleMath::cross(edge, normal);
+            float length = SampleMath::length(edgeNormal);
+            if (length <= 0.0f)
+            {
+                continue;
+            }
+            edgeNormal = edgeNormal * (1.0f / length);
+
+            Quadric edgePlane;
+            edgePlane.addPlane(edgeNormal, -SampleMath::dot(edgeNormal, position(a)),
+                               BORDER_WEIGHT * SampleMath::dot(edge, edge));
+            mQuadrics[mRemap[a]].add(edgePlane);
+            mQuadrics[mRemap[b]].add(edgePlane);
+        }
+    }
+
+
+    bool Simplifier::canCollapse(std::uint32_t from, std::uint32_t to) const
+    {
+        if (mRemap[from] == mRemap[to])
+        {
+            return false;
+        }
+
+        switch (mKind[from])
+        {
+        case VertexKind::Manifold:
+            return true;
+
+        case VertexKind::Border:
+            return mKind[to] == VertexKind::Border && (mOpenOut[from] == to || mOpenIn[from] == to);
+
+        case VertexKind::Seam:
+        {
+            if (mKind[to] != VertexKind::Seam || (mOpenOut[from] != to && mOpenIn[from] != to))
+            {
+                return false;
+            }
+            // The other side of the seam must run between the other two vertices
+            std::uint32_t otherFrom = mWedge[from];
+            std::uint32_t otherTo = mWedge[to];
+            return mOpenOut[otherFrom] == otherTo || mOpenIn[otherFrom] == otherTo;
+        }
+
+        default:
+            return false;
+        }
+    }
+
+
+    bool Simplifier::checkTriangles(std::uint32_t from, std::uint32_t to, size_t& removed) const
+    {
+        std::uint32_t r0 = mRemap[from];
+        std::uint32_t r1 = mRemap[to];
+        SampleMath::Vec3 target = position(to);
+
+        removed = 0;
+        for (std::uint32_t k = mAdjacency.offsets[r0]; k < mAdjacency.offsets[r0 + 1]; k++)
+        {
+            const std::uint32_t* t = &mIndices[3 * size_t(mAdjacency.triangles[k])];
+            std::uint32_t w[3] = { mRemap[t[0]], mRemap[t[1]], mRemap[t[2]] };
+            if (w[0] == r1 || w[1] == r1 || w[2] == r1)
+            {
+                removed++;
+                continue;
+            }
+
+            SampleMath::Vec3 p[3] = { position(t[0]), position(t[1]), position(t[2]) };
+            SampleMath::Vec3 before = SampleMath::cross(p[1] - p[0], p[2] - p[0]);
+            for (int c = 0; c < 3; c++)
+            {
+                if (w[c] == r0)
+                {
+                    p[c] = target;
+                }
+            }
+            SampleMath::Vec3 after = SampleMath::cross(p[1] - p[0], p[2] - p[0]);
+
+            float limit = MIN_NORMAL_COSINE * SampleMath::length(before) * SampleMath::length(after);
+            if (SampleMath::dot(before, after) < limit)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    void Simplifier::relinkOpenEdges(std::uint32_t from, std::uint32_t to)
+    {
+        const size_t vertexCount = mVertices.size();
+        if (mOpenOut[from] == to)
+        {
+            // prev -> from -> to becomes prev -> to
+            std::uint32_t prev = mOpenIn[from];
+            if (prev < vertexCount && mOpenOut[prev] == from)
+            {
+                mOpenOut[prev] = to;
+            }
+            mOpenIn[to] = prev;
+        }
+        else if (mOpenIn[from] == to)
+        {
+            // to -> from -> next becomes to -> next
+            std::uint32_t next = mOpenOut[from];
+            if (next < vertexCount && mOpenIn[next] == from)
+            {
+                mOpenIn[next] = to;
+            }
+            mOpenOut[to] = next;
+        }
+    }
+
+
+    size_t Simplifier::runPass(size_t targetIndexCount, double maxCost)
+    {
+        mAdjacency.build(mIndices, mRemap);
+
+        // The cheaper direction of every edge that can collapse
+        std::vector<Collapse> collapses;
+        collapses.reserve(mIndices.size());
+        for (size_t i = 0; i < mIndices.size(); i += 3)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                std::uint32_t a = mIndices[i + c];
+                std::uint32_t b = mIndices[i + (c + 1) % 3];
+                bool ab = canCollapse(a, b);
+                bool ba = canCollapse(b, a);
+                double costAB = ab ? mQuadrics[mRemap[a]].getError(position(b)) : 0.0;
+                double costBA = ba ? mQuadrics[mRemap[b]].getError(position(a)) : 0.0;
+                if (ab && (!ba || costAB <= costBA))
+                {
+                    collapses.push_back({ a, b, costAB });
+                }
+                else if (ba)
+                {
+                    collapses.push_back({ b, a, costBA });
+                }
+            }
+        }
+        std::stable_sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y)
+        {
+            return x.cost < y.cost;
+        });
+
+        // Collapse the cheapest edges whose neighborhoods do not overlap
+        mLocked.assign(mVertices.size(), false);
+        const size_t triangleBudget = (mIndices.size() - targetIndexCount) / 3;
+        size_t removedTriangles = 0;
+        size_t collapseCount = 0;
+        for (const Collapse& collapse : collapses)
+        {
+            if (removedTriangles >= triangleBudget || collapse.cost > maxCost)
+            {
+                break;
+            }
+
+            std::uint32_t r0 = mRemap[collapse.from];
+            std::uint32_t r1 = mRemap[collapse.to];
+            size_t removed = 0;
+            if (mLocked[r0] || mLocked[r1] || !checkTriangles(collapse.from, collapse.to, removed))
+            {
+                continue;
+            }
+
+            if (mKind[collapse.from] == VertexKind::Seam)
+            {
+                std::uint32_t otherFrom = mWedge[collapse.from];
+                std::uint32_t otherTo = mWedge[collapse.to];
+                mCollapseTo[otherFrom] = otherTo;
+                relinkOpenEdges(otherFrom, otherTo);
+            }
+            mCollapseTo[collapse.from] = collapse.to;
+            relinkOpenEdges(collapse.from, collapse.to);
+            mQuadrics[r1].add(mQuadrics[r0]);
+
+            // The triangles around r0 change, later collapses in this pass must not use them
+            for (std::uint32_t k = mAdjacency.offsets[r0]; k < mAdjacency.offsets[r0 + 1]; k++)
+            {
+                const std::uint32_t* t = &mIndices[3 * size_t(mAdjacency.triangles[k])];
+                for (int c = 0; c < 3; c++)
+                {
+                    mLocked[mRemap[t[c]]] = true;
+                }
+            }
+            mLocked[r1] = true;
+
+            mError = std::max(mError, collapse.cost);
+            removedTriangles += removed;
+            collapseCount++;
+        }
+
+        if (collapseCount == 0)
+        {
+            return 0;
+        }
+
+        // Apply the collapses and drop the triangles that lost an edge. The triangles left
+        // keep their order.
+        size_t write = 0;
+        for (size_t i = 0; i < mIndices.size(); i += 3)
+        {
+            std::uint32_t a = mCollapseTo[mIndices[i + 0]];
+            std::uint32_t b = mCollapseTo[mIndices[i + 1]];
+            std::uint32_t c = mCollapseTo[mIndices[i + 2]];
+            if (mRemap[a] == mRemap[b] || mRemap[b] == mRemap[c] || mRemap[c] == mRemap[a])
+            {
+                continue;
+            }
+            if (!mTags.empty())
+            {
+                mTags[write / 3] = mTags[i / 3];
+            }
+            mIndices[write++] = a;
+            mIndices[write++] = b;
+            mIndices[write++] = c;
+        }
+        mIndices.resize(write);
+        if (!mTags.empty())
+        {
+            mTags.resize(write / 3);
+        }
+        return collapseCount;
+    }
+
+
+    float Simplifier::run(size_t targetIndexCount, float maxError)
+    {
+        double maxCost = double(maxError) * maxError;
+        while (mIndices.size() > targetIndexCount)
+        {
+            if (runPass(targetIndexCount, maxCost) == 0)
+            {
+                break;
+            }
+        }
+        return static_cast<float>(std::sqrt(mError));
+    }
+
+
+    float Simplifier::measureDeviation() const
+    {
+        VertexTriangles adjacency;
+        adjacency.build(mIndices, mRemap);
+
+        float maxDistance2 = 0.0f;
+        for (size_t v = 0; v < mVertices.size(); v++)
+        {
+            if (!mInputVertices[v])
+            {
+                continue;
+            }
+            // Every collapse removes its from vertex, so the chain ends at a vertex still used
+            std::uint32_t to = static_cast<std::uint32_t>(v);
+            while (mCollapseTo[to] != to)
+            {
+                to = mCollapseTo[to];
+            }
+
+            std::uint32_t r = mRemap[to];
+            SampleMath::Vec3 p = position(static_cast<std::uint32_t>(v));
+            float distance2 = FLT_MAX;
+            for (std::uint32_t k = adjacency.offsets[r]; k < adjacency.offsets[r + 1]; k++)
+            {
+                const std::uint32_t* t = &mIndices[3 * size_t(adjacency.triangles[k])];
+                distance2 = std::min(distance2, getTriangleDistance2(p, position(t[0]), position(t[1]), position(t[2])));
+            }
+            // A position left without triangles has nothing to measure against
+            if (distance2 < FLT_MAX)
+            {
+                maxDistance2 = std::max(maxDistance2, distance2);
+            }
+        }
+        return std::sqrt(maxDistance2);
+    }
+
+
+    /// The submeshes of a simplified level: a range for every run of triangles with the same
+    /// tag, the tags are indices of the submeshes of the first level
+    std::vector<Submesh> splitLevel(const std::vector<Submesh>& firstLevel, const std::vector<std::uint32_t>& tags,
+                                    const std::vector<MeshVertex>& vertices, const std::vector<std::uint32_t>& indices)
+    {
+        std::vector<Submesh> ranges;
+        for (size_t begin = 0, end = 0; begin < tags.size(); begin = end)
+        {
+            while (end < tags.size() && tags[end] == tags[begin])
+            {
+                end++;
+            }
+            Submesh range = firstLevel[tags[begin]];
+            range.indexOffset = static_cast<std::uint32_t>(3 * begin);
+            range.indexCount = static_cast<std::uint32_t>(3 * (end - begin));
+            MeshPartitioner::computeBounds(vertices, &indices[range.indexOffset], range.indexCount, range);
+            ranges.push_back(range);
+        }
+        return ranges;
+    }
+
+    template <typename Index>
+    void storeLevels(const std::vector<std::vector<std::uint32_t>>& levels, std::vector<Index>& indices)
+    {
+        indices.clear();
+        for (const auto& level : levels)
+        {
+            for (std::uint32_t v : level)
+            {
+                indices.push_back(static_cast<Index>(v));
+            }
+        }
+    }
+}
+
+
+float
+MeshSimplifier::simplify(const std::vector<MeshVertex>& vertices, std::vector<std::uint32_t>& indices,
+                         size_t targetIndexCount, float maxError)
+{
+    Simplifier simplifier(vertices, indices);
+    float error = simplifier.run(targetIndexCount, maxError);
+    indices = simplifier.getIndices();
+    return error;
+}
+
+
+void
+MeshSimplifier::buildLods(Mesh& mesh, size_t lodCount, float reduction)
+{
+    // The first level is the current indices, or the first level of a previous chain
+    std::vector<std::uint32_t> full;
+    size_t fullBegin = mesh.lods.empty() ? 0 : mesh.lods[0].indexOffset;
+    size_t fullCount = mesh.lods.empty() ? mesh.getIndexCount() : mesh.lods[0].indexCount;
+    if (!mesh.indices16.empty())
+    {
+        full.assign(mesh.indices16.begin() + fullBegin, mesh.indices16.begin() + fullBegin + fullCount);
+    }
+    else
+    {
+        full.assign(mesh.indices32.begin() + fullBegin, mesh.indices32.begin() + fullBegin + fullCount);
+    }
+    // The submeshes of the first level are kept if their ranges cover it in order
+    std::vector<Submesh> submeshes;
+    size_t covered = 0;
+    for (const Submesh& submesh : mesh.submeshes)
+    {
+        if (submesh.lod == 0)
+        {
+            if (submesh.indexOffset != fullBegin + covered)
+            {
+                covered = 0;
+                break;
+            }
+            submeshes.push_back(submesh);
+            submeshes.back().indexOffset -= static_cast<std::uint32_t>(fullBegin);
+            covered += submesh.indexCount;
+        }
+    }
+    if (covered != fullCount)
+    {
+        submeshes.clear();
+    }
+    mesh.lods.clear();
+    mesh.submeshes.clear();
+    if (full.empty())
+    {
+        return;
+    }
+
+    // Simplification keeps the triangles in order, so every level stays sorted by submesh.
+    // The tags tell which submesh each remaining triangle came from.
+    std::vector<std::uint32_t> tags;
+    tags.reserve(full.size() / 3);
+    for (size_t i = 0; i < submeshes.size(); i++)
+    {
+        tags.insert(tags.end(), submeshes[i].indexCount / 3, static_cast<std::uint32_t>(i));
+    }
+
+    std::vector<std::vector<std::uint32_t>> levels;
+    std::vector<std::vector<Submesh>> levelSubmeshes;
+    std::vector<float> errors;
+    levels.push_back(full);
+    levelSubmeshes.push_back(submeshes);
+    errors.push_back(0.0f);
+
+    // Every level continues from the previous one. Its error is measured against the full
+    // mesh, the simplifier's running maximum of the collapse costs often stays the same
+    // from one level to the next.
+    Simplifier simplifier(mesh.vertices, full, tags);
+    while (levels.size() < lodCount)
+    {
+        size_t previousCount = levels.back().size();
+        size_t targetCount = static_cast<size_t>(float(previousCount / 3) * reduction) * 3;
+        if (targetCount < 3 * MIN_LOD_TRIANGLES)
+        {
+            break;
+        }
+
+        simplifier.run(targetCount, FLT_MAX);
+        const std::vector<std::uint32_t>& simplified = simplifier.getIndices();
+
+        // Stop if less than half the requested triangles could be removed
+        if (previousCount - simplified.size() < (previousCount - targetCount) / 2)
+        {
+            break;
+        }
+
+        // selectLod takes the coarsest level within the tolerance, so a simplified level
+        // that is no further off than a coarser one would never be drawn: it is dropped
+        float error = simplifier.measureDeviation();
+        while (levels.size() > 1 && error <= errors.back())
+        {
+            levels.pop_back();
+            levelSubmeshes.pop_back();
+            errors.pop_back();
+        }
+
+        levels.push_back(simplified);
+        if (submeshes.empty())
+        {
+            levelSubmeshes.emplace_back();
+            MeshOptimizer::optimizeVertexCache(levels.back(), mesh.vertices.size(),
+                                               MeshOptimizer::DEFAULT_CACHE_SIZE);
+        }
+        else
+        {
+            levelSubmeshes.push_back(splitLevel(submeshes, simplifier.getTriangleTags(), mesh.vertices, simplified));
+            MeshOptimizer::optimizeVertexCache(levels.back(), mesh.vertices.size(), MeshOptimizer::DEFAULT_CACHE_SIZE,
+                                               levelSubmeshes.back().data(), levelSubmeshes.back().size());
+        }
+        errors.push_back(error);
+    }
+
+    std::uint32_t offset = 0;
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        std::uint32_t count = static_cast<std::uint32_t>(levels[i].size());
+        mesh.lods.push_back({ offset, count, errors[i] });
+        for (Submesh submesh : levelSubmeshes[i])
+        {
+            submesh.indexOffset += offset;
+            submesh.lod = static_cast<std::uint32_t>(i);
+            mesh.submeshes.push_back(submesh);
+        }
+        offset += count;
+    }
+
+    if (!mesh.indices16.empty())
+    {
+        storeLevels(levels, mesh.indices16);
+    }
+    else
+    {
+        storeLevels(levels, mesh.indices32);
+    }
+}
+
+
+float
+MeshSimplifier::getPixelsPerUnit(const Vuforia::Matrix44F& projection, const Vuforia::Matrix44F& modelView,
+                                 const SampleMath::Vec3& point, float viewportHeight)
+{
+    // Column-major matrices
+    const float* mv = modelView.data;
+    const float* p = projection.data;
+    float eye[3];
+    for (int r = 0; r < 3; r++)
+    {
+        eye[r] = mv[r] * point[0] + mv[4 + r] * point[1] + mv[8 + r] * point[2] + mv[12 + r];
+    }
+    float w = p[3] * eye[0] + p[7] * eye[1] + p[11] * eye[2] + p[15];
+    if (w <= FLT_EPSILON)
+    {
+        // At or behind the camera
+        return FLT_MAX;
+    }
+
+    // The model-view matrix may scale the model
+    float scale = 0.0f;
+    for (int c = 0; c < 3; c++)
+    {
+        scale = std::max(scale, std::sqrt(mv[4 * c] * mv[4 * c] + mv[4 * c + 1] * mv[4 * c + 1] + mv[4 * c + 2] * mv[4 * c + 2]));
+    }
+
+    return scale * std::fabs(p[5]) * 0.5f * viewportHeight / w;
+}
+
+
+size_t
+MeshSimplifier::selectLod(const MeshLod* lods, size_t lodCount, float pixelsPerUnit, float maxErrorPixels)
+{
+    size_t selected = 0;
+    for (size_t i = 1; i < lodCount; i++)
+    {
+        if (lods[i].error * pixelsPerUnit > maxErrorPixels)
+        {
+            break;
+        }
+        selected = i;
+    }
+    return selected;
+}
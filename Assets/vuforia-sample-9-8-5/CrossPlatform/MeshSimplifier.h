@@ -0,0 +1,69 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_SIMPLIFIER_H__
+#define __MESH_SIMPLIFIER_H__
+
+#include "MeshCache.h"
+
+#include <Vuforia/Matrices.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// Simplifies meshes and builds their levels of detail
+/**
+ * Simplification collapses edges by moving one end onto the other, the cheapest first
+ * by the quadric error metric ("Surface Simplification Using Quadric Error Metrics",
+ * Garland and Heckbert, 1997). Vertices are never moved or created, so the levels of
+ * detail share the vertex buffer of the full mesh and keep its texture coordinates.
+ * - Vertices on a border of the mesh only collapse along the border.
+ * - Vertices on a texture seam, two vertices at one position, only collapse along the
+ *   seam, both sides together, so the seam does not open.
+ * - Other vertices sharing a position, or with several borders, are never moved.
+ * - Collapses that would flip a triangle are skipped.
+ * Collapsing never reorders the triangles that are left, so the levels of a mesh sorted
+ * by MeshPartitioner stay sorted by material.
+ */
+namespace MeshSimplifier
+{
+    /// Levels of detail built by default, the full mesh included
+    constexpr size_t DEFAULT_LOD_COUNT = 4;
+
+    /// Each level has about this fraction of the triangles of the previous one
+    constexpr float DEFAULT_LOD_REDUCTION = 0.5f;
+
+    /// Levels are not simplified below this many triangles
+    constexpr size_t MIN_LOD_TRIANGLES = 64;
+
+    /// Simplify the triangle list indices of vertices to at most targetIndexCount indices,
+    /// or as far as possible without exceeding maxError.
+    /// Returns the error of the result, in model units.
+    float simplify(const std::vector<MeshVertex>& vertices, std::vector<std::uint32_t>& indices,
+                   size_t targetIndexCount, float maxError);
+
+    /// Replace the indices of mesh with a chain of levels of detail. The first level is the
+    /// current indices, run MeshOptimizer::optimize before this. Each further level is
+    /// reordered for the vertex cache. A level that removes few triangles ends the chain.
+    /// The error of a level is its distance from the first one, see selectLod. The errors
+    /// increase along the chain, a level no further off than a coarser one is dropped.
+    /// Every level is split into the submeshes of the first one, a submesh whose triangles
+    /// all collapsed is left out of a level.
+    void buildLods(Mesh& mesh, size_t lodCount = DEFAULT_LOD_COUNT, float reduction = DEFAULT_LOD_REDUCTION);
+
+    /// Size in pixels of one model unit at point, as drawn with the modelView and
+    /// projection matrices into a viewport viewportHeight pixels high
+    float getPixelsPerUnit(const Vuforia::Matrix44F& projection, const Vuforia::Matrix44F& modelView,
+                           const SampleMath::Vec3& point, float viewportHeight);
+
+    /// Index of the coarsest level whose error is at most maxErrorPixels on screen
+    size_t selectLod(const MeshLod* lods, size_t lodCount, float pixelsPerUnit, float maxErrorPixels = 1.0f);
+}
+
+#endif // __MESH_SIMPLIFIER_H__
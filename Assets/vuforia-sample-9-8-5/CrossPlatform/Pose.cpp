@@ -0,0 +1,376 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "Pose.h"
+#include "Simd.h"
+
+#include <cmath>
+
+
+namespace
+{
+    /// Below this cos(angle) slerp is used, above it the rotations are close enough for nlerp
+    constexpr float SLERP_DOT_THRESHOLD = 0.9995f;
+
+    /// Build a unit quaternion from a rotation matrix given as a function of (row, column).
+    /// Picks the largest of w, x, y, z to divide by so the result stays accurate for any angle.
+    template <typename Element>
+    SampleMath::Quaternion quaternionFromRotation(Element r)
+    {
+        SampleMath::Quaternion q;
+        float trace = r(0, 0) + r(1, 1) + r(2, 2);
+
+        if (trace > 0.0f)
+        {
+            float s = std::sqrt(trace + 1.0f) * 2.0f;
+            q.w = 0.25f * s;
+            q.x = (r(2, 1) - r(1, 2)) / s;
+            q.y = (r(0, 2) - r(2, 0)) / s;
+            q.z = (r(1, 0) - r(0, 1)) / s;
+        }
+        else if (r(0, 0) > r(1, 1) && r(0, 0) > r(2, 2))
+        {
+            float s = std::sqrt(1.0f + r(0, 0) - r(1, 1) - r(2, 2)) * 2.0f;
+            q.w = (r(2, 1) - r(1, 2)) / s;
+            q.x = 0.25f * s;
+            q.y = (r(0, 1) + r(1, 0)) / s;
+            q.z = (r(0, 2) + r(2, 0)) / s;
+        }
+        else if (r(1, 1) > r(2, 2))
+        {
+            float s = std::sqrt(1.0f + r(1, 1) - r(0, 0) - r(2, 2)) * 2.0f;
+            q.w = (r(0, 2) - r(2, 0)) / s;
+            q.x = (r(0, 1) + r(1, 0)) / s;
+            q.y = 0.25f * s;
+            q.z = (r(1, 2) + r(2, 1)) / s;
+        }
+        else
+        {
+            float s = std::sqrt(1.0f + r(2, 2) - r(0, 0) - r(1, 1)) * 2.0f;
+            q.w = (r(1, 0) - r(0, 1)) / s;
+            q.x = (r(0, 2) + r(2, 0)) / s;
+            q.y = (r(1, 2) + r(2, 1)) / s;
+            q.z = 0.25f * s;
+        }
+
+        return SampleMath::normalize(q);
+    }
+
+    /// Four floats processed together, maps to one SSE or NEON register when available
+    struct Float4
+    {
+#if defined(SIMD_USE_SSE)
+        __m128 v;
+        Float4() = default;
+        Float4(__m128 value) : v(value) {}
+        explicit Float4(float a) : v(_mm_set1_ps(a)) {}
+        Float4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+        void store(float* out) const { _mm_storeu_ps(out, v); }
+        friend Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+        friend Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+        friend Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+#elif defined(SIMD_USE_NEON)
+        float32x4_t v;
+        Float4() = default;
+        Float4(float32x4_t value) : v(value) {}
+        explicit Float4(float a) : v(vdupq_n_f32(a)) {}
+        Float4(float a, float b, float c, float d)
+        {
+            const float values[4] = { a, b, c, d };
+            v = vld1q_f32(values);
+        }
+        void store(float* out) const { vst1q_f32(out, v); }
+        friend Float4 operator+(Float4 a, Float4 b) { return vaddq_f32(a.v, b.v); }
+        friend Float4 operator-(Float4 a, Float4 b) { return vsubq_f32(a.v, b.v); }
+        friend Float4 operator*(Float4 a, Float4 b) { return vmulq_f32(a.v, b.v); }
+#else
+        float v[4];
+        Float4() = default;
+        explicit Float4(float a) : v{ a, a, a, a } {}
+        Float4(float a, float b, float c, float d) : v{ a, b, c, d } {}
+        void store(float* out) const { for (int i = 0; i < 4; i++) out[i] = v[i]; }
+        friend Float4 operator+(Float4 a, Float4 b) { return Float4(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]); }
+        friend Float4 operator-(Float4 a, Float4 b) { return Float4(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]); }
+        friend Float4 operator*(Float4 a, Float4 b) { return Float4(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]); }
+#endif
+    };
+
+    /// Write the GL-style 4x4 matrix for a rotation (given as 9 elements r(row, column)) and translation
+    void writeMatrix44(const float r[3][3], const float t[3], Vuforia::Matrix44F& m)
+    {
+        m.data[0] = r[0][0];  m.data[4] = r[0][1];  m.data[8] = r[0][2];   m.data[12] = t[0];
+        m.data[1] = r[1][0];  m.data[5] = r[1][1];  m.data[9] = r[1][2];   m.data[13] = t[1];
+        m.data[2] = r[2][0];  m.data[6] = r[2][1];  m.data[10] = r[2][2];  m.data[14] = t[2];
+        m.data[3] = 0.0f;     m.data[7] = 0.0f;     m.data[11] = 0.0f;     m.data[15] = 1.0f;
+    }
+
+    /// Rotation matrix elements of a unit quaternion, shared by the single and batch conversions
+    /// so that both give identical results.
+    template <typename T>
+    void rotationFromQuaternion(T x, T y, T z, T w, T r[3][3])
+    {
+        const T one = T(1.0f);
+        const T two = T(2.0f);
+        const T xx = x * x, yy = y * y, zz = z * z;
+        const T xy = x * y, xz = x * z, yz = y * z;
+        const T wx = w * x, wy = w * y, wz = w * z;
+
+        r[0][0] = one - two * (yy + zz);  r[0][1] = two * (xy - wz);        r[0][2] = two * (xz + wy);
+        r[1][0] = two * (xy + wz);        r[1][1] = one - two * (xx + zz);  r[1][2] = two * (yz - wx);
+        r[2][0] = two * (xz - wy);        r[2][1] = two * (yz + wx);        r[2][2] = one - two * (xx + yy);
+    }
+}
+
+
+namespace SampleMath
+{
+    Quaternion
+    Quaternion::fromAxisAngle(const Vec3& axis, float angle)
+    {
+        float s = std::sin(angle * 0.5f);
+        return Quaternion(axis.data[0] * s, axis.data[1] * s, axis.data[2] * s, std::cos(angle * 0.5f));
+    }
+
+
+    Quaternion
+    Quaternion::fromRotationVector(const Vec3& v)
+    {
+        float angle = length(v);
+        if (angle == 0.0f)
+            return Quaternion();
+
+        return fromAxisAngle(v * (1.0f / angle), angle);
+    }
+
+
+    Vec3
+    Quaternion::toRotationVector() const
+    {
+        // q and -q are the same rotation, use the one with w >= 0 for an angle in [0, pi]
+        float sign = w < 0.0f ? -1.0f : 1.0f;
+        Vec3 axis(x * sign, y * sign, z * sign);
+        float sinHalfAngle = length(axis);
+        if (sinHalfAngle == 0.0f)
+            return Vec3();
+
+        float angle = 2.0f * std::atan2(sinHalfAngle, w * sign);
+        return axis * (angle / sinHalfAngle);
+    }
+
+
+    Vec3
+    Quaternion::rotate(const Vec3& v) const
+    {
+        // v' = v + w * t + q x t with t = 2 * (q x v)
+        const Vec3 q(x, y, z);
+        const Vec3 t = cross(q, v) * 2.0f;
+        return v + t * w + cross(q, t);
+    }
+
+
+    float
+    angleBetween(const Quaternion& a, const Quaternion& b)
+    {
+        float d = std::fabs(dot(a, b));
+        return 2.0f * std::acos(d < 1.0f ? d : 1.0f);
+    }
+
+
+    Quaternion
+    normalize(const Quaternion& q)
+    {
+        float len = std::sqrt(dot(q, q));
+        if (len == 0.0f)
+            return Quaternion();
+
+        float inv = 1.0f / len;
+        return Quaternion(q.x * inv, q.y * inv, q.z * inv, q.w * inv);
+    }
+
+
+    Quaternion
+    nlerp(const Quaternion& a, const Quaternion& b, float t)
+    {
+        // q and -q are the same rotation, flip b to take the shortest arc
+        float sign = dot(a, b) < 0.0f ? -1.0f : 1.0f;
+        float ta = 1.0f - t;
+        float tb = t * sign;
+
+        return normalize(Quaternion(a.x * ta + b.x * tb,
+                                    a.y * ta + b.y * tb,
+                                    a.z * ta + b.z * tb,
+                                    a.w * ta + b.w * tb));
+    }
+
+
+    Quaternion
+    slerp(const Quaternion& a, const Quaternion& b, float t)
+    {
+        float cosTheta = dot(a, b);
+        float sign = 1.0f;
+        if (cosTheta < 0.0f)
+        {
+            cosTheta = -cosTheta;
+            sign = -1.0f;
+        }
+
+        if (cosTheta > SLERP_DOT_THRESHOLD)
+        {
+            return nlerp(a, b, t);
+        }
+
+        float theta = std::acos(cosTheta);
+        float invSinTheta = 1.0f / std::sin(theta);
+        float ta = std::sin((1.0f - t) * theta) * invSinTheta;
+        float tb = std::sin(t * theta) * invSinTheta * sign;
+
+        return Quaternion(a.x * ta + b.x * tb,
+                          a.y * ta + b.y * tb,
+                          a.z * ta + b.z * tb,
+                          a.w * ta + b.w * tb);
+    }
+
+
+    Pose
+    Pose::fromMatrix34(const Vuforia::Matrix34F& m)
+    {
+        Pose pose;
+        pose.rotation = quaternionFromRotation([&m](int row, int col) { return m.data[row * 4 + col]; });
+        pose.translation = Vec3(m.data[3], m.data[7], m.data[11]);
+        return pose;
+    }
+
+
+    Pose
+    Pose::fromMatrix44(const Vuforia::Matrix44F& m)
+    {
+        Pose pose;
+        pose.rotation = quaternionFromRotation([&m](int row, int col) { return m.data[col * 4 + row]; });
+        pose.translation = Vec3(m.data[12], m.data[13], m.data[14]);
+        return pose;
+    }
+
+
+    Vuforia::Matrix34F
+    Pose::toMatrix34() const
+    {
+        float r[3][3];
+        rotationFromQuaternion(rotation.x, rotation.y, rotation.z, rotation.w, r);
+
+        Vuforia::Matrix34F m;
+        for (int row = 0; row < 3; row++)
+        {
+            m.data[row * 4] = r[row][0];
+            m.data[row * 4 + 1] = r[row][1];
+            m.data[row * 4 + 2] = r[row][2];
+            m.data[row * 4 + 3] = translation.data[row];
+        }
+        return m;
+    }
+
+
+    Vuforia::Matrix44F
+    Pose::toMatrix44() const
+    {
+        float r[3][3];
+        rotationFromQuaternion(rotation.x, rotation.y, rotation.z, rotation.w, r);
+
+        Vuforia::Matrix44F m;
+        writeMatrix44(r, translation.data, m);
+        return m;
+    }
+
+
+    Pose
+    Pose::inverse() const
+    {
+        Pose pose;
+        pose.rotation = rotation.conjugate();
+        pose.translation = -pose.rotation.rotate(translation);
+        return pose;
+    }
+
+
+    void
+    Pose::toMatrices44(const Pose* poses, Vuforia::Matrix44F* matrices, size_t n)
+    {
+        size_t i = 0;
+
+        // Four poses at a time: gather the quaternions into one register per component,
+        // compute the nine rotation elements for all four and scatter them back out
+        for (; i + 4 <= n; i += 4)
+        {
+            const Pose* p = poses + i;
+            Float4 x(p[0].rotation.x, p[1].rotation.x, p[2].rotation.x, p[3].rotation.x);
+            Float4 y(p[0].rotation.y, p[1].rotation.y, p[2].rotation.y, p[3].rotation.y);
+            Float4 z(p[0].rotation.z, p[1].rotation.z, p[2].rotation.z, p[3].rotation.z);
+            Float4 w(p[0].rotation.w, p[1].rotation.w, p[2].rotation.w, p[3].rotation.w);
+
+            Float4 rl[3][3];
+            rotationFromQuaternion(x, y, z, w, rl);
+
+            float r[3][3][4];
+            for (int row = 0; row < 3; row++)
+                for (int col = 0; col < 3; col++)
+                    rl[row][col].store(r[row][col]);
+
+            for (int k = 0; k < 4; k++)
+            {
+                float rk[3][3];
+                for (int row = 0; row < 3; row++)
+                    for (int col = 0; col < 3; col++)
+                        rk[row][col] = r[row][col][k];
+                writeMatrix44(rk, p[k].translation.data, matrices[i + k]);
+            }
+        }
+
+        for (; i < n; i++)
+        {
+            matrices[i] = poses[i].toMatrix44();
+        }
+    }
+
+
+    void
+    Pose::fromMatrices34(const Vuforia::Matrix34F* matrices, Pose* poses, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            poses[i] = fromMatrix34(matrices[i]);
+        }
+    }
+
+
+    Pose
+    operator*(const Pose& a, const Pose& b)
+    {
+        Pose pose;
+        pose.rotation = a.rotation * b.rotation;
+        pose.translation = a.rotation.rotate(b.translation) + a.translation;
+        return pose;
+    }
+
+
+    Pose
+    nlerp(const Pose& a, const Pose& b, float t)
+    {
+        Pose pose;
+        pose.rotation = nlerp(a.rotation, b.rotation, t);
+        pose.translation = a.translation * (1.0f - t) + b.translation * t;
+        return pose;
+    }
+
+
+    Pose
+    slerp(const Pose& a, const Pose& b, float t)
+    {
+        Pose pose;
+        pose.rotation = slerp(a.rotation, b.rotation, t);
+        pose.translation = a.translation * (1.0f - t) + b.translation * t;
+        return pose;
+    }
+}
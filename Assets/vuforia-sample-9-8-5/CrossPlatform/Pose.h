@@ -0,0 +1,125 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __POSE_H__
+#define __POSE_H__
+
+#include "MathTypes.h"
+
+#include <Vuforia/Matrices.h>
+
+#include <cstddef>
+
+
+namespace SampleMath
+{
+    /// Rotation stored as a unit quaternion (x, y, z vector part, w scalar part)
+    struct Quaternion
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+        float w = 1.0f;
+
+        constexpr Quaternion() = default;
+        constexpr Quaternion(float qx, float qy, float qz, float qw) : x(qx), y(qy), z(qz), w(qw) {}
+
+        /// Rotation of angle radians around a unit axis
+        static Quaternion fromAxisAngle(const Vec3& axis, float angle);
+
+        /// Rotation given as axis * angle (radians)
+        static Quaternion fromRotationVector(const Vec3& v);
+
+        /// Return the rotation as axis * angle (radians), taking the shortest arc
+        Vec3 toRotationVector() const;
+
+        /// Inverse rotation (conjugate of a unit quaternion)
+        constexpr Quaternion conjugate() const { return Quaternion(-x, -y, -z, w); }
+
+        /// Rotate a vector
+        Vec3 rotate(const Vec3& v) const;
+    };
+
+    /// Hamilton product, the result applies b first then a
+    constexpr Quaternion operator*(const Quaternion& a, const Quaternion& b)
+    {
+        return Quaternion(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                          a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                          a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                          a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+    }
+
+    constexpr float dot(const Quaternion& a, const Quaternion& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    }
+
+    /// Angle in radians of the rotation between a and b, in [0, pi]
+    float angleBetween(const Quaternion& a, const Quaternion& b);
+
+    /// Return q scaled to unit length
+    Quaternion normalize(const Quaternion& q);
+
+    /// Normalized linear interpolation along the shortest arc, t in [0, 1]
+    Quaternion nlerp(const Quaternion& a, const Quaternion& b, float t);
+
+    /// Spherical linear interpolation along the shortest arc, t in [0, 1]
+    /// Falls back to nlerp when the rotations are almost identical.
+    Quaternion slerp(const Quaternion& a, const Quaternion& b, float t);
+
+
+    /// Rigid transform (rotation followed by translation) stored in 28 bytes.
+    /**
+     * A Pose maps a point p to rotation.rotate(p) + translation, the same as the
+     * matrices Vuforia returns for trackable poses.
+     * Use it instead of a Matrix44F when many poses have to be stored or interpolated.
+     */
+    struct Pose
+    {
+        Quaternion rotation;
+        Vec3 translation;
+
+        /// Convert a Vuforia pose (3x4 row-major, as returned by TrackableResult::getPose())
+        /// The rotation part must be orthonormal.
+        static Pose fromMatrix34(const Vuforia::Matrix34F& m);
+
+        /// Convert a GL-style 4x4 pose (as returned by Tool::convertPose2GLMatrix())
+        /// The rotation part must be orthonormal.
+        static Pose fromMatrix44(const Vuforia::Matrix44F& m);
+
+        /// Convert to a Vuforia 3x4 row-major pose
+        Vuforia::Matrix34F toMatrix34() const;
+
+        /// Convert to a GL-style 4x4 pose, same layout as Tool::convertPose2GLMatrix()
+        Vuforia::Matrix44F toMatrix44() const;
+
+        /// Inverse transform
+        Pose inverse() const;
+
+        /// Transform a point (result = R * p + t)
+        Vec3 transformPoint(const Vec3& p) const { return rotation.rotate(p) + translation; }
+
+        /// Convert n poses to GL-style 4x4 matrices, uses SSE or NEON when available
+        static void toMatrices44(const Pose* poses, Vuforia::Matrix44F* matrices, size_t n);
+
+        /// Convert n Vuforia 3x4 poses
+        static void fromMatrices34(const Vuforia::Matrix34F* matrices, Pose* poses, size_t n);
+    };
+
+    static_assert(sizeof(Pose) == 7 * sizeof(float), "Pose must stay tightly packed");
+
+    /// Compose two poses, the result applies b first then a (same as the matrix product a * b)
+    Pose operator*(const Pose& a, const Pose& b);
+
+    /// Interpolate rotation with nlerp and translation linearly, t in [0, 1]
+    Pose nlerp(const Pose& a, const Pose& b, float t);
+
+    /// Interpolate rotation with slerp and translation linearly, t in [0, 1]
+    Pose slerp(const Pose& a, const Pose& b, float t);
+}
+
+#endif // __POSE_H__
@@ -0,0 +1,126 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "PosePredictor.h"
+
+#include <algorithm>
+
+
+using SampleMath::Pose;
+using SampleMath::Quaternion;
+using SampleMath::Vec3;
+
+namespace
+{
+    /// Linear and angular (axis * radians) velocity between two samples, valid at their midpoint
+    void velocityBetween(const Pose& from, const Pose& to, float dt, Vec3& linear, Vec3& angular)
+    {
+        linear = (to.translation - from.translation) * (1.0f / dt);
+        // Rotation taking from to to, expressed in the world frame: to = delta * from
+        angular = (to.rotation * from.rotation.conjugate()).toRotationVector() * (1.0f / dt);
+    }
+}
+
+
+void
+PosePredictor::addSample(double timestamp, const SampleMath::Pose& pose)
+{
+    if (mCount > 0)
+    {
+        double latest = getLatestTimestamp();
+        if (timestamp <= latest)
+        {
+            return;
+        }
+        if (timestamp - latest > MAX_SAMPLE_GAP)
+        {
+            reset();
+        }
+    }
+
+    Sample sample = { timestamp, pose };
+
+    // With Model::NONE this measures the error of rendering without prediction
+    if (mCount > 1)
+    {
+        updateErrorStats(sample);
+    }
+
+    mHead = (mHead + 1) % HISTORY_SIZE;
+    mSamples[mHead] = sample;
+    mCount = std::min(mCount + 1, HISTORY_SIZE);
+}
+
+
+bool
+PosePredictor::predict(double targetTime, SampleMath::Pose& pose) const
+{
+    if (mCount == 0)
+    {
+        return false;
+    }
+
+    const Sample& s0 = getSample(0);
+    pose = s0.pose;
+
+    float dt = static_cast<float>(std::min(std::max(targetTime - s0.timestamp, 0.0), mMaxPredictionTime));
+    if (mModel == Model::NONE || mCount < 2 || dt == 0.0f)
+    {
+        return true;
+    }
+
+    const Sample& s1 = getSample(1);
+    float dt01 = static_cast<float>(s0.timestamp - s1.timestamp);
+
+    Vec3 linear, angular;
+    velocityBetween(s1.pose, s0.pose, dt01, linear, angular);
+
+    Vec3 translationStep = linear * dt;
+    Vec3 rotationStep = angular * dt;
+
+    if (mModel == Model::CONSTANT_ACCELERATION && mCount >= 3)
+    {
+        const Sample& s2 = getSample(2);
+        float dt12 = static_cast<float>(s1.timestamp - s2.timestamp);
+
+        Vec3 linearPrev, angularPrev;
+        velocityBetween(s2.pose, s1.pose, dt12, linearPrev, angularPrev);
+
+        // The velocities are valid at the interval midpoints, which are (dt01 + dt12) / 2 apart
+        float invSpan = 2.0f / (dt01 + dt12);
+        Vec3 linearAcc = (linear - linearPrev) * invSpan;
+        Vec3 angularAcc = (angular - angularPrev) * invSpan;
+
+        // Advance the velocities from the midpoint to the latest sample, then integrate
+        float half = 0.5f * dt01;
+        translationStep = (linear + linearAcc * half) * dt + linearAcc * (0.5f * dt * dt);
+        rotationStep = (angular + angularAcc * half) * dt + angularAcc * (0.5f * dt * dt);
+    }
+
+    pose.translation = s0.pose.translation + translationStep;
+    pose.rotation = SampleMath::normalize(Quaternion::fromRotationVector(rotationStep) * s0.pose.rotation);
+    return true;
+}
+
+
+void
+PosePredictor::updateErrorStats(const Sample& sample)
+{
+    Pose predicted;
+    predict(sample.timestamp, predicted);
+
+    double translationError = SampleMath::length(predicted.translation - sample.pose.translation);
+    double rotationError = SampleMath::angleBetween(predicted.rotation, sample.pose.rotation);
+
+    // Running means so the statistics can be read at any time
+    mErrorStats.count++;
+    double weight = 1.0 / static_cast<double>(mErrorStats.count);
+    mErrorStats.meanTranslationError += (translationError - mErrorStats.meanTranslationError) * weight;
+    mErrorStats.meanRotationError += (rotationError - mErrorStats.meanRotationError) * weight;
+    mErrorStats.maxTranslationError = std::max(mErrorStats.maxTranslationError, translationError);
+    mErrorStats.maxRotationError = std::max(mErrorStats.maxRotationError, rotationError);
+}
@@ -0,0 +1,106 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __POSE_PREDICTOR_H__
+#define __POSE_PREDICTOR_H__
+
+#include "Pose.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+/// Extrapolates a tracked pose from its recent history to a future time.
+/**
+ * Feed each new tracker pose with addSample, then call predict with the time the frame
+ * is expected to reach the display. Translation and angular velocity are estimated from
+ * the last samples in a small ring buffer. Every new sample is also compared against the
+ * pose the model would have predicted for its timestamp, which gives the error statistics.
+ * Timestamps are in seconds, in any clock as long as it is the same for all calls.
+ */
+class PosePredictor
+{
+public:
+
+    /// Motion model used to extrapolate
+    enum class Model
+    {
+        NONE,                   ///< Return the latest sample unchanged
+        CONSTANT_VELOCITY,      ///< Linear and angular velocity from the last two samples
+        CONSTANT_ACCELERATION,  ///< Velocity and acceleration from the last three samples
+    };
+
+    /// Prediction accuracy measured against the next real sample
+    struct ErrorStats
+    {
+        std::uint64_t count = 0;
+        double meanTranslationError = 0.0;  ///< meters
+        double maxTranslationError = 0.0;   ///< meters
+        double meanRotationError = 0.0;     ///< radians
+        double maxRotationError = 0.0;      ///< radians
+    };
+
+    /// Number of samples kept
+    static constexpr size_t HISTORY_SIZE = 8;
+
+    /// Samples further apart than this (seconds) are treated as a tracking restart and clear the history
+    static constexpr double MAX_SAMPLE_GAP = 0.25;
+
+    void setModel(Model model) { mModel = model; }
+    Model getModel() const { return mModel; }
+
+    /// Limit on how far past the latest sample predict will extrapolate, in seconds
+    void setMaxPredictionTime(double seconds) { mMaxPredictionTime = seconds; }
+    double getMaxPredictionTime() const { return mMaxPredictionTime; }
+
+    /// Add a tracked pose. Samples that are not newer than the latest one are ignored,
+    /// so it is safe to add the same tracker result on every rendered frame.
+    void addSample(double timestamp, const SampleMath::Pose& pose);
+
+    /// Predict the pose at targetTime. Returns false if there are no samples.
+    bool predict(double targetTime, SampleMath::Pose& pose) const;
+
+    /// Timestamp of the latest sample, only valid if hasSamples() is true
+    double getLatestTimestamp() const { return mSamples[mHead].timestamp; }
+    bool hasSamples() const { return mCount > 0; }
+
+    /// Clear the sample history, keeps the error statistics
+    void reset() { mCount = 0; }
+
+    const ErrorStats& getErrorStats() const { return mErrorStats; }
+    void resetErrorStats() { mErrorStats = ErrorStats(); }
+
+private: // types
+
+    struct Sample
+    {
+        double timestamp;
+        SampleMath::Pose pose;
+    };
+
+private: // methods
+
+    /// Sample i steps back from the latest one (0 is the latest)
+    const Sample& getSample(size_t i) const { return mSamples[(mHead + HISTORY_SIZE - i) % HISTORY_SIZE]; }
+
+    /// Record the error between the pose predicted for sample's timestamp and the sample
+    void updateErrorStats(const Sample& sample);
+
+private: // data members
+
+    Model mModel = Model::NONE;
+    double mMaxPredictionTime = 0.1;
+
+    std::array<Sample, HISTORY_SIZE> mSamples;
+    size_t mHead = 0;
+    size_t mCount = 0;
+
+    ErrorStats mErrorStats;
+};
+
+#endif // __POSE_PREDICTOR_H__
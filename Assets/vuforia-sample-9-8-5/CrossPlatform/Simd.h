@@ -0,0 +1,37 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __SIMD_H__
+#define __SIMD_H__
+
+// Compile-time selection of the SIMD instruction set used by the math kernels.
+//
+// SIMD_USE_SSE is defined when building for x86/x64 with SSE2 available
+// (always the case for x64, and for Win32 unless /arch:IA32 is used).
+// SIMD_USE_NEON is defined when building for ARM64, or ARMv7 with NEON.
+// Define SIMD_DISABLE to force the scalar code paths on every platform.
+
+#if !defined(SIMD_DISABLE)
+
+#if defined(_M_X64) || defined(__x86_64__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SIMD_USE_SSE 1
+#include <emmintrin.h>
+
+#elif defined(_M_ARM64) || defined(__aarch64__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SIMD_USE_NEON 1
+#if defined(_MSC_VER) && defined(_M_ARM64)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+
+#endif
+
+#endif // !SIMD_DISABLE
+
+#endif // __SIMD_H__
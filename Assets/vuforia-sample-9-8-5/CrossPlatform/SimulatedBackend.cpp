@@ -0,0 +1,305 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "SimulatedBackend.h"
+
+#include "AppController.h"
+#include "MathTypes.h"
+
+#include <cmath>
+
+
+using SampleMath::Vec3;
+
+namespace
+{
+    constexpr float PI = 3.14159265358979f;
+
+    /// Size of the simulated Guide View image
+    constexpr int GUIDE_VIEW_WIDTH = 640;
+    constexpr int GUIDE_VIEW_HEIGHT = 480;
+
+    /// Build a 3x4 pose from its rotation columns and translation
+    Vuforia::Matrix34F makePose(const Vec3& xAxis, const Vec3& yAxis, const Vec3& zAxis, const Vec3& translation)
+    {
+        Vuforia::Matrix34F pose;
+        for (int row = 0; row < 3; row++)
+        {
+            pose.data[row * 4 + 0] = xAxis.data[row];
+            pose.data[row * 4 + 1] = yAxis.data[row];
+            pose.data[row * 4 + 2] = zAxis.data[row];
+            pose.data[row * 4 + 3] = translation.data[row];
+        }
+        return pose;
+    }
+
+    Vec3 column(const Vuforia::Matrix34F& pose, int col)
+    {
+        return Vec3(pose.data[col], pose.data[4 + col], pose.data[8 + col]);
+    }
+
+    /// GL projection for a camera looking along +z with y down, as Vuforia returns it
+    Vuforia::Matrix44F makeProjection(float focalX, float focalY, float width, float height)
+    {
+        Vuforia::Matrix44F m;
+        for (float& value : m.data)
+        {
+            value = 0.0f;
+        }
+
+        const float nearPlane = TrackingBackend::NEAR_PLANE;
+        const float farPlane = TrackingBackend::FAR_PLANE;
+        m.data[0] = 2.0f * focalX / width;
+        m.data[5] = -2.0f * focalY / height;
+        m.data[10] = (farPlane + nearPlane) / (farPlane - nearPlane);
+        m.data[11] = 1.0f;
+        m.data[14] = -2.0f * farPlane * nearPlane / (farPlane - nearPlane);
+        return m;
+    }
+}
+
+
+/*===============================================================================
+SimulatedBackend public methods
+===============================================================================*/
+
+bool
+SimulatedBackend::init(void*, int, const ErrorCallback& showError)
+{
+    mShowErrorCallback = showError;
+    mInitialized = true;
+    return true;
+}
+
+
+bool
+SimulatedBackend::loadData(int target)
+{
+    if (!mInitialized)
+    {
+        mShowErrorCallback("Attempt to load data before initialization");
+        return false;
+    }
+
+    mRandom.seed(mConfig.seed);
+    mTargets.resize(mConfig.targetCount);
+
+    for (auto& t : mTargets)
+    {
+        Vec3 position(random() * mConfig.areaSize, random() * mConfig.areaSize * 0.25f, random() * mConfig.areaSize);
+
+        // Random rotation around the vertical axis
+        float yaw = random() * PI;
+        Vec3 xAxis(std::cos(yaw), 0.0f, -std::sin(yaw));
+        Vec3 yAxis(0.0f, 1.0f, 0.0f);
+        Vec3 zAxis(std::sin(yaw), 0.0f, std::cos(yaw));
+        t.pose = makePose(xAxis, yAxis, zAxis, position);
+
+        if (target == AppController::IMAGE_TARGET_ID)
+        {
+            t.type = TrackingResultType::IMAGE_TARGET;
+            t.size = Vuforia::Vec3F(0.2f + 0.05f * random(), 0.15f + 0.05f * random(), 0.0f);
+        }
+        else
+        {
+            t.type = TrackingResultType::MODEL_TARGET;
+            t.size = Vuforia::Vec3F(0.3f + 0.1f * random(), 0.2f + 0.1f * random(), 0.3f + 0.1f * random());
+        }
+    }
+
+    return true;
+}
+
+
+void
+SimulatedBackend::deinit()
+{
+    mTargets.clear();
+    mInitialized = false;
+    mStarted = false;
+}
+
+
+bool
+SimulatedBackend::start()
+{
+    if (!mInitialized)
+    {
+        mShowErrorCallback("Failed to start the simulation");
+        return false;
+    }
+
+    mStarted = true;
+    mPaused = false;
+    mFrameIndex = 0;
+    mTime = 0.0;
+    return true;
+}
+
+
+void
+SimulatedBackend::stop()
+{
+    mStarted = false;
+}
+
+
+bool
+SimulatedBackend::configureRendering(int width, int height, int)
+{
+    if (!mStarted)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mViewMutex);
+    mDisplayAspectRatio = (float)width / height;
+    mViewport = Vuforia::Vec4I(0, 0, width, height);
+    return true;
+}
+
+
+std::shared_ptr<const TrackingBackend::RenderState>
+SimulatedBackend::update(TrackingFrame& frame, std::vector<const Vuforia::Image*>& guideViewImages)
+{
+    // The clock only runs while the simulated camera does
+    if (mStarted && !mPaused)
+    {
+        mFrameIndex++;
+        mTime = mFrameIndex / mConfig.frameRate;
+    }
+
+    float width = float(mConfig.cameraWidth);
+    float height = float(mConfig.cameraHeight);
+    float tanHalfHeight = std::tan(mConfig.verticalFieldOfView * 0.5f);
+    float tanHalfWidth = tanHalfHeight * width / height;
+    float focalY = 0.5f * height / tanHalfHeight;
+
+    frame.frameIndex = mFrameIndex;
+    frame.captureTime = mTime;
+    frame.hasCameraCalibration = true;
+    frame.cameraSize = Vuforia::Vec2F(width, height);
+    frame.cameraFocalLength = Vuforia::Vec2F(focalY, focalY);
+    frame.cameraPrincipalPoint = Vuforia::Vec2F(0.5f * width, 0.5f * height);
+    frame.cameraFieldOfViewRads = Vuforia::Vec2F(2.0f * std::atan(tanHalfWidth), mConfig.verticalFieldOfView);
+    frame.projectionMatrix = makeProjection(focalY, focalY, width, height);
+    {
+        std::lock_guard<std::mutex> lock(mViewMutex);
+        frame.viewport = mViewport;
+        frame.displayAspectRatio = mDisplayAspectRatio;
+    }
+
+    Vuforia::Matrix34F devicePose = getDevicePose(mTime);
+    frame.hasDeviceResult = true;
+    frame.deviceResult = TrackingResult();
+    frame.deviceResult.type = TrackingResultType::DEVICE;
+    frame.deviceResult.status = TrackingResult::TRACKED;
+    frame.deviceResult.statusInfo = TrackingResult::NORMAL;
+    frame.deviceResult.timestamp = mTime;
+    frame.deviceResult.pose = devicePose;
+    frame.deviceResult.size = Vuforia::Vec3F(0.0f, 0.0f, 0.0f);
+    frame.deviceResult.obbCenter = Vuforia::Vec3F(0.0f, 0.0f, 0.0f);
+    frame.deviceResult.obbHalfExtents = Vuforia::Vec3F(0.0f, 0.0f, 0.0f);
+
+    Vec3 right = column(devicePose, 0);
+    Vec3 down = column(devicePose, 1);
+    Vec3 forward = column(devicePose, 2);
+    Vec3 devicePosition = column(devicePose, 3);
+
+    frame.results.clear();
+    for (size_t i = 0; i < mTargets.size(); i++)
+    {
+        const Target& target = mTargets[i];
+
+        // Target position in camera space, x right, y down, z forward
+        Vec3 offset = column(target.pose, 3) - devicePosition;
+        float z = SampleMath::dot(offset, forward);
+        bool visible = z > NEAR_PLANE && z < mConfig.maxDetectionDistance &&
+                       std::fabs(SampleMath::dot(offset, right)) < z * tanHalfWidth &&
+                       std::fabs(SampleMath::dot(offset, down)) < z * tanHalfHeight;
+
+        if (!visible && target.type != TrackingResultType::MODEL_TARGET)
+        {
+            continue;
+        }
+
+        frame.results.emplace_back();
+        TrackingResult& result = frame.results.back();
+        result.type = target.type;
+        result.trackableId = static_cast<std::int32_t>(i);
+        result.timestamp = mTime;
+        result.pose = target.pose;
+        result.size = target.size;
+        result.obbCenter = Vuforia::Vec3F(0.0f, 0.5f * target.size.data[1], 0.0f);
+        result.obbHalfExtents = SampleMath::Vec3(target.size) * 0.5f;
+
+        if (visible)
+        {
+            result.status = TrackingResult::TRACKED;
+            result.statusInfo = TrackingResult::NORMAL;
+            if (mConfig.positionNoise > 0.0f)
+            {
+                result.pose.data[3] += mConfig.positionNoise * random();
+                result.pose.data[7] += mConfig.positionNoise * random();
+                result.pose.data[11] += mConfig.positionNoise * random();
+            }
+        }
+        else
+        {
+            result.status = TrackingResult::NO_POSE;
+            result.statusInfo = TrackingResult::NO_DETECTION_RECOMMENDING_GUIDANCE;
+        }
+
+        if (target.type == TrackingResultType::MODEL_TARGET)
+        {
+            result.guideViewWidth = GUIDE_VIEW_WIDTH;
+            result.guideViewHeight = GUIDE_VIEW_HEIGHT;
+        }
+    }
+
+    guideViewImages.assign(frame.results.size(), nullptr);
+    return nullptr;
+}
+
+
+bool
+SimulatedBackend::beginRender(const RenderState&, double*, Vuforia::RenderData*,
+                              Vuforia::TextureUnit*, Vuforia::TextureData*)
+{
+    // update never returns a render state, so there is never a frame to render
+    return false;
+}
+
+
+/*===============================================================================
+SimulatedBackend private methods
+===============================================================================*/
+
+float
+SimulatedBackend::random()
+{
+    // Built from the raw generator output, std distributions differ between standard libraries
+    return static_cast<float>(mRandom() >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+
+Vuforia::Matrix34F
+SimulatedBackend::getDevicePose(double t) const
+{
+    float angle = static_cast<float>(2.0 * PI * t / mConfig.orbitPeriod);
+
+    // Orbit with a slow vertical bob, looking at the origin
+    Vec3 position(mConfig.orbitRadius * std::cos(angle),
+                  0.1f * mConfig.orbitRadius * std::sin(2.0f * angle),
+                  mConfig.orbitRadius * std::sin(angle));
+
+    Vec3 forward = SampleMath::normalize(-position);
+    Vec3 right = SampleMath::normalize(SampleMath::cross(forward, Vec3(0.0f, 1.0f, 0.0f)));
+    Vec3 down = SampleMath::cross(forward, right);
+
+    return makePose(right, down, forward, position);
+}
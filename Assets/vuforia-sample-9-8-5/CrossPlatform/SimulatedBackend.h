@@ -0,0 +1,125 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __SIMULATED_BACKEND_H__
+#define __SIMULATED_BACKEND_H__
+
+#include "TrackingBackend.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <vector>
+
+
+/// TrackingBackend that generates tracking data instead of running the Vuforia engine.
+/**
+ * The device orbits the origin looking at it, and targets are scattered around the origin.
+ * Each update advances a simulated clock by one camera frame, moves the device and reports
+ * every target inside the camera frustum as tracked. Model Targets outside it are reported
+ * with NO_POSE and a Guide View recommendation, like Vuforia does before detection.
+ * The frames only depend on the Config, so runs are repeatable. There is no video background:
+ * update returns no render state and getRenderingPrimitives returns nullptr.
+ */
+class SimulatedBackend : public TrackingBackend
+{
+public:
+
+    struct Config
+    {
+        /// Number of simulated targets, all of the type passed to loadData
+        size_t targetCount = 1;
+        /// Seed for target placement and pose noise
+        std::uint32_t seed = 1;
+        /// Simulated camera frame rate, each update advances the clock by 1 / frameRate
+        double frameRate = 30.0;
+        /// Targets are placed in a box of +-areaSize meters around the origin
+        float areaSize = 1.0f;
+        /// Distance of the device from the origin, in meters
+        float orbitRadius = 2.0f;
+        /// Time for one orbit, in seconds
+        double orbitPeriod = 20.0;
+        /// Vertical field of view of the camera, in radians
+        float verticalFieldOfView = 0.8f;
+        int cameraWidth = 1280;
+        int cameraHeight = 720;
+        /// Targets further away than this are not detected, in meters
+        float maxDetectionDistance = 4.0f;
+        /// Amplitude of the random offset added to tracked target positions, in meters
+        float positionNoise = 0.0f;
+    };
+
+    SimulatedBackend() = default;
+    explicit SimulatedBackend(const Config& config) : mConfig(config) {}
+
+    bool init(void* appData, int initFlags, const ErrorCallback& showError) override;
+    bool loadData(int target) override;
+    void deinit() override;
+
+    bool start() override;
+    void stop() override;
+    void pause() override { mPaused = true; }
+    void resume() override { mPaused = false; }
+    bool isStarted() const override { return mStarted; }
+
+    bool configureRendering(int width, int height, int orientation) override;
+    void updateRenderingPrimitives() override {}
+    const Vuforia::RenderingPrimitives* getRenderingPrimitives() const override { return nullptr; }
+
+    std::shared_ptr<const RenderState> update(TrackingFrame& frame,
+                                              std::vector<const Vuforia::Image*>& guideViewImages) override;
+
+    bool beginRender(const RenderState& renderState, double* viewport, Vuforia::RenderData* renderData,
+                     Vuforia::TextureUnit* videoBackgroundTextureUnit,
+                     Vuforia::TextureData* videoBackgroundTextureData) override;
+    void endRender(Vuforia::RenderData*) override {}
+
+    /// Simulated clock, advanced by update
+    double getCurrentTimeStamp() const override { return mTime.load(std::memory_order_relaxed); }
+
+    const Config& getConfig() const { return mConfig; }
+
+private: // types
+
+    struct Target
+    {
+        TrackingResultType type;
+        Vuforia::Matrix34F pose;
+        Vuforia::Vec3F size;
+    };
+
+private: // methods
+
+    /// Uniform random number in [-1, 1), the same on every platform for a given seed
+    float random();
+
+    /// Device pose at time t
+    Vuforia::Matrix34F getDevicePose(double t) const;
+
+private: // data members
+
+    Config mConfig;
+    ErrorCallback mShowErrorCallback;
+
+    std::vector<Target> mTargets;
+    std::mt19937 mRandom;
+
+    bool mInitialized = false;
+    bool mStarted = false;
+    bool mPaused = false;
+
+    std::int32_t mFrameIndex = 0;
+    std::atomic<double> mTime{ 0.0 };
+    /// Guards the view, which update reads while the render thread configures rendering
+    std::mutex mViewMutex;
+    float mDisplayAspectRatio = 1.0f;
+    Vuforia::Vec4I mViewport;
+};
+
+#endif // __SIMULATED_BACKEND_H__
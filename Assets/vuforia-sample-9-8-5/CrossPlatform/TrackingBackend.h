@@ -0,0 +1,113 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __TRACKING_BACKEND_H__
+#define __TRACKING_BACKEND_H__
+
+#include "TrackingFrame.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Only passed through by pointer, the Vuforia rendering headers are included by the
+// backends that use them, so SimulatedBackend and AppController build without them
+namespace Vuforia
+{
+    class Image;
+    class RenderData;
+    class RenderingPrimitives;
+    class TextureData;
+    class TextureUnit;
+}
+
+
+/// Source of tracking data and video background for AppController.
+/**
+ * VuforiaBackend drives the Vuforia engine and camera. SimulatedBackend generates the same
+ * data from synthetic trajectories, so AppController can run without the Vuforia engine or a
+ * device. update and getCurrentTimeStamp are called from the thread that publishes the
+ * frames, which may be the AppController tracking thread, while the render thread calls
+ * configureRendering, getRenderingPrimitives, beginRender and endRender: backends guard the
+ * state these share. The other methods are called from the thread that drives the
+ * AppController lifecycle while no frame is being published.
+ */
+class TrackingBackend
+{
+public:
+
+    using ErrorCallback = std::function<void(const char* errorString)>;
+
+    /// Near and far planes of the projection matrix backends put in the TrackingFrame
+    static constexpr float NEAR_PLANE = 0.01f;
+    static constexpr float FAR_PLANE = 5.f;
+
+    /// Backend data the renderer needs to draw the frame a TrackingFrame was captured from
+    struct RenderState
+    {
+        virtual ~RenderState() = default;
+    };
+
+    virtual ~TrackingBackend() = default;
+
+    /// Initialize the engine and create the trackers.
+    /// Errors are reported through showError, which is kept for the later calls.
+    virtual bool init(void* appData, int initFlags, const ErrorCallback& showError) = 0;
+
+    /// Load and activate the data for target, AppController::IMAGE_TARGET_ID or MODEL_TARGET_ID
+    virtual bool loadData(int target) = 0;
+
+    /// Unload the data, destroy the trackers and deinitialize the engine
+    virtual void deinit() = 0;
+
+    /// Start the camera and the trackers
+    virtual bool start() = 0;
+
+    /// Stop the camera and the trackers
+    virtual void stop() = 0;
+
+    /// Pause and resume while the app is in the background
+    virtual void pause() = 0;
+    virtual void resume() = 0;
+
+    /// True between start and stop, including while paused
+    virtual bool isStarted() const = 0;
+
+    virtual void cameraPerformAutoFocus() {}
+    virtual void cameraRestoreAutoFocus() {}
+
+    /// Configure rendering for a view of width x height pixels, see AppController::configureRendering
+    virtual bool configureRendering(int width, int height, int orientation) = 0;
+
+    /// Refresh the rendering primitives after a change of the view
+    virtual void updateRenderingPrimitives() = 0;
+
+    /// Current rendering primitives, nullptr if the backend has no video background to render.
+    /// Valid until the next configureRendering or updateRenderingPrimitives.
+    virtual const Vuforia::RenderingPrimitives* getRenderingPrimitives() const = 0;
+
+    /// Update the tracking state and copy it to frame.
+    /// guideViewImages is resized to frame.results and receives the Guide View image of each
+    /// Model Target result, or nullptr. Returns what beginRender needs to draw this frame,
+    /// nullptr if there is nothing to render.
+    virtual std::shared_ptr<const RenderState> update(TrackingFrame& frame,
+                                                      std::vector<const Vuforia::Image*>& guideViewImages) = 0;
+
+    /// Start rendering the frame renderState was returned for, see AppController::prepareToRender.
+    /// Returns true if the video background texture was updated.
+    virtual bool beginRender(const RenderState& renderState, double* viewport, Vuforia::RenderData* renderData,
+                             Vuforia::TextureUnit* videoBackgroundTextureUnit,
+                             Vuforia::TextureData* videoBackgroundTextureData) = 0;
+
+    /// Finish rendering a frame started with beginRender
+    virtual void endRender(Vuforia::RenderData* renderData) = 0;
+
+    /// Current time in the clock used by the TrackingFrame timestamps, in seconds
+    virtual double getCurrentTimeStamp() const = 0;
+};
+
+#endif // __TRACKING_BACKEND_H__
@@ -0,0 +1,105 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __TRACKING_FRAME_H__
+#define __TRACKING_FRAME_H__
+
+#include <Vuforia/Matrices.h>
+#include <Vuforia/Vectors.h>
+
+#include <cstdint>
+#include <vector>
+
+
+/// Kind of trackable a TrackingResult was produced for
+enum class TrackingResultType : std::int32_t
+{
+    DEVICE,
+    IMAGE_TARGET,
+    MODEL_TARGET,
+    OTHER,
+};
+
+
+/// Copy of a Vuforia::TrackableResult and the trackable properties AppController uses
+struct TrackingResult
+{
+    /// Values of status, the same as Vuforia::TrackableResult::STATUS
+    enum Status : std::int32_t
+    {
+        NO_POSE,
+        LIMITED,
+        DETECTED,
+        TRACKED,
+        EXTENDED_TRACKED,
+    };
+
+    /// Values of statusInfo used by AppController, the same as Vuforia::TrackableResult::STATUS_INFO
+    enum StatusInfo : std::int32_t
+    {
+        NORMAL = 0,
+        NO_DETECTION_RECOMMENDING_GUIDANCE = 7,
+    };
+
+    TrackingResultType type = TrackingResultType::OTHER;
+    /// Trackable::getId()
+    std::int32_t trackableId = -1;
+    /// A Status
+    std::int32_t status = NO_POSE;
+    /// Vuforia::TrackableResult::STATUS_INFO, see StatusInfo
+    std::int32_t statusInfo = NORMAL;
+    /// Vuforia clock, in seconds
+    double timestamp = 0.0;
+    /// 3x4 row-major pose, as returned by TrackableResult::getPose()
+    Vuforia::Matrix34F pose;
+    /// Target size, zero for the device
+    Vuforia::Vec3F size;
+    /// Model Target bounding box, zero for other types
+    Vuforia::Vec3F obbCenter;
+    Vuforia::Vec3F obbHalfExtents;
+    float obbRotationZ = 0.0f;
+    /// Size of the first Guide View image of a Model Target, zero if it has none
+    std::int32_t guideViewWidth = 0;
+    std::int32_t guideViewHeight = 0;
+};
+
+
+/// Everything AppController reads from Vuforia to produce the rendering matrices of one frame.
+/**
+ * A TrackingFrame holds no pointers into the engine, so it can be written to a TrackingLog and
+ * replayed without a camera or the Vuforia engine. It is filled by a TrackingBackend.
+ */
+struct TrackingFrame
+{
+    /// Vuforia::Frame::getIndex()
+    std::int32_t frameIndex = 0;
+    /// Vuforia clock when the state was updated, in seconds
+    double captureTime = 0.0;
+
+    /// Camera calibration, only meaningful if hasCameraCalibration is true
+    bool hasCameraCalibration = false;
+    Vuforia::Vec2F cameraSize;
+    Vuforia::Vec2F cameraFocalLength;
+    Vuforia::Vec2F cameraPrincipalPoint;
+    Vuforia::Vec2F cameraFieldOfViewRads;
+
+    /// Rendering primitives for VIEW_SINGULAR: viewport and GL projection matrix
+    Vuforia::Vec4I viewport;
+    Vuforia::Matrix44F projectionMatrix;
+    /// Display aspect ratio the Guide View is laid out for
+    float displayAspectRatio = 1.0f;
+
+    /// Device pose, only meaningful if hasDeviceResult is true
+    bool hasDeviceResult = false;
+    TrackingResult deviceResult;
+
+    /// Results for the other trackables. Backends clear and refill this every frame,
+    /// which keeps its capacity and avoids allocations once the number of results is stable.
+    std::vector<TrackingResult> results;
+};
+
+#endif // __TRACKING_FRAME_H__
@@ -0,0 +1,286 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "TrackingLog.h"
+
+#include "Log.h"
+#include "MemoryStream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+
+namespace
+{
+    /// Identifies the file type, "VTRK"
+    constexpr std::uint32_t LOG_MAGIC = 0x4B525456;
+    /// Increment when the layout of TrackingFrame or TrackingResult changes
+    constexpr std::uint32_t LOG_VERSION = 3;
+
+    /// The header is the magic, the version, the target and RESULT_RECORD_SIZE, which
+    /// catches logs from builds with a different layout
+    constexpr size_t HEADER_SIZE = 4 * sizeof(std::uint32_t);
+
+    /*
+     * Frames are stored field by field, without the padding of TrackingFrame and
+     * TrackingResult, so every byte of a record is written.
+     */
+
+    /// Size of a TrackingResult in the log
+    constexpr size_t RESULT_RECORD_SIZE =
+        4 * sizeof(std::int32_t) + sizeof(double) + (12 + 3 * 3 + 1) * sizeof(float) + 2 * sizeof(std::int32_t);
+
+    /// Size of the fixed part of a frame record, followed by resultCount results
+    constexpr size_t FRAME_RECORD_SIZE =
+        sizeof(std::int32_t) + sizeof(double) + sizeof(std::int32_t) + (4 * 2 + 16 + 1) * sizeof(float) +
+        4 * sizeof(std::int32_t) + sizeof(std::int32_t) + RESULT_RECORD_SIZE + sizeof(std::uint32_t);
+
+    /// Store count values little endian at out, the order ByteReader reads, and move out
+    /// past them
+    template <typename T>
+    void put(char*& out, const T* values, size_t count = 1)
+    {
+        if (isLittleEndianHost())
+        {
+            std::memcpy(out, values, count * sizeof(T));
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                const char* bytes = reinterpret_cast<const char*>(&values[i]);
+                std::reverse_copy(bytes, bytes + sizeof(T), out + i * sizeof(T));
+            }
+        }
+        out += count * sizeof(T);
+    }
+
+    void putResult(char*& out, const TrackingResult& result)
+    {
+        put(out, &result.type);
+        put(out, &result.trackableId);
+        put(out, &result.status);
+        put(out, &result.statusInfo);
+        put(out, &result.timestamp);
+        put(out, result.pose.data, 12);
+        put(out, result.size.data, 3);
+        put(out, result.obbCenter.data, 3);
+        put(out, result.obbHalfExtents.data, 3);
+        put(out, &result.obbRotationZ);
+        put(out, &result.guideViewWidth);
+        put(out, &result.guideViewHeight);
+    }
+
+    bool getResult(ByteReader& in, TrackingResult& result)
+    {
+        return in.read(result.type) && in.read(result.trackableId) && in.read(result.status) &&
+               in.read(result.statusInfo) && in.read(result.timestamp) && in.readArray(result.pose.data, 12) &&
+               in.readArray(result.size.data, 3) && in.readArray(result.obbCenter.data, 3) &&
+               in.readArray(result.obbHalfExtents.data, 3) && in.read(result.obbRotationZ) &&
+               in.read(result.guideViewWidth) && in.read(result.guideViewHeight);
+    }
+
+    /// Upper bound on the results of one frame, a larger count means the log is corrupt
+    constexpr std::uint32_t MAX_RESULTS_PER_FRAME = 1u << 20;
+}
+
+
+/*===============================================================================
+TrackingLogWriter
+===============================================================================*/
+
+bool
+TrackingLogWriter::open(const std::string& path, int target)
+{
+    close();
+
+    mFile = std::fopen(path.c_str(), "wb");
+    if (mFile == nullptr)
+    {
+        LOG("Failed to create tracking log %s", path.c_str());
+        return false;
+    }
+
+    const std::uint32_t resultSize = static_cast<std::uint32_t>(RESULT_RECORD_SIZE);
+    const std::int32_t target32 = target;
+    char header[HEADER_SIZE];
+    char* out = header;
+    put(out, &LOG_MAGIC);
+    put(out, &LOG_VERSION);
+    put(out, &target32);
+    put(out, &resultSize);
+    if (std::fwrite(header, sizeof(header), 1, mFile) != 1)
+    {
+        LOG("Failed to write tracking log header");
+        close();
+        return false;
+    }
+
+    mFrameCount = 0;
+    return true;
+}
+
+
+void
+TrackingLogWriter::close()
+{
+    if (mFile != nullptr)
+    {
+        std::fclose(mFile);
+        mFile = nullptr;
+    }
+}
+
+
+bool
+TrackingLogWriter::write(const TrackingFrame& frame)
+{
+    if (mFile == nullptr)
+    {
+        return false;
+    }
+
+    const std::uint32_t resultCount =
+        static_cast<std::uint32_t>(std::min<size_t>(frame.results.size(), MAX_RESULTS_PER_FRAME));
+    const std::int32_t hasCameraCalibration = frame.hasCameraCalibration ? 1 : 0;
+    const std::int32_t hasDeviceResult = frame.hasDeviceResult ? 1 : 0;
+
+    mRecord.resize(FRAME_RECORD_SIZE + resultCount * RESULT_RECORD_SIZE);
+    char* out = mRecord.data();
+    put(out, &frame.frameIndex);
+    put(out, &frame.captureTime);
+    put(out, &hasCameraCalibration);
+    put(out, frame.cameraSize.data, 2);
+    put(out, frame.cameraFocalLength.data, 2);
+    put(out, frame.cameraPrincipalPoint.data, 2);
+    put(out, frame.cameraFieldOfViewRads.data, 2);
+    put(out, frame.viewport.data, 4);
+    put(out, frame.projectionMatrix.data, 16);
+    put(out, &frame.displayAspectRatio);
+    put(out, &hasDeviceResult);
+    putResult(out, frame.deviceResult);
+    put(out, &resultCount);
+    for (std::uint32_t i = 0; i < resultCount; i++)
+    {
+        putResult(out, frame.results[i]);
+    }
+
+    if (std::fwrite(mRecord.data(), 1, mRecord.size(), mFile) != mRecord.size())
+    {
+        LOG("Failed to write tracking log frame, recording stopped");
+        close();
+        return false;
+    }
+
+    ++mFrameCount;
+    return true;
+}
+
+
+/*===============================================================================
+TrackingLogReader
+===============================================================================*/
+
+bool
+TrackingLogReader::open(const std::string& path)
+{
+    close();
+
+    mFile = std::fopen(path.c_str(), "rb");
+    if (mFile == nullptr)
+    {
+        LOG("Failed to open tracking log %s", path.c_str());
+        return false;
+    }
+
+    char header[HEADER_SIZE];
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::int32_t target = 0;
+    std::uint32_t resultSize = 0;
+    ByteReader in(header, sizeof(header));
+    if (std::fread(header, sizeof(header), 1, mFile) != 1 ||
+        !(in.read(magic) && in.read(version) && in.read(target) && in.read(resultSize)) ||
+        magic != LOG_MAGIC || version != LOG_VERSION || resultSize != RESULT_RECORD_SIZE)
+    {
+        LOG("%s is not a tracking log of this version", path.c_str());
+        close();
+        return false;
+    }
+
+    mTarget = target;
+    mFirstFrameOffset = std::ftell(mFile);
+    return true;
+}
+
+
+void
+TrackingLogReader::close()
+{
+    if (mFile != nullptr)
+    {
+        std::fclose(mFile);
+        mFile = nullptr;
+    }
+}
+
+
+bool
+TrackingLogReader::read(TrackingFrame& frame)
+{
+    mRecord.resize(FRAME_RECORD_SIZE);
+    if (mFile == nullptr || std::fread(mRecord.data(), 1, FRAME_RECORD_SIZE, mFile) != FRAME_RECORD_SIZE)
+    {
+        return false;
+    }
+
+    ByteReader in(mRecord.data(), mRecord.size());
+    std::int32_t hasCameraCalibration = 0;
+    std::int32_t hasDeviceResult = 0;
+    std::uint32_t resultCount = 0;
+    if (!(in.read(frame.frameIndex) && in.read(frame.captureTime) && in.read(hasCameraCalibration) &&
+          in.readArray(frame.cameraSize.data, 2) && in.readArray(frame.cameraFocalLength.data, 2) &&
+          in.readArray(frame.cameraPrincipalPoint.data, 2) && in.readArray(frame.cameraFieldOfViewRads.data, 2) &&
+          in.readArray(frame.viewport.data, 4) && in.readArray(frame.projectionMatrix.data, 16) &&
+          in.read(frame.displayAspectRatio) && in.read(hasDeviceResult) && getResult(in, frame.deviceResult) &&
+          in.read(resultCount)))
+    {
+        return false;
+    }
+    frame.hasCameraCalibration = hasCameraCalibration != 0;
+    frame.hasDeviceResult = hasDeviceResult != 0;
+
+    if (resultCount > MAX_RESULTS_PER_FRAME)
+    {
+        LOG("Corrupt tracking log, frame %d has %u results", frame.frameIndex, resultCount);
+        return false;
+    }
+
+    mRecord.resize(resultCount * RESULT_RECORD_SIZE);
+    if (std::fread(mRecord.data(), 1, mRecord.size(), mFile) != mRecord.size())
+    {
+        return false;
+    }
+    ByteReader resultsIn(mRecord.data(), mRecord.size());
+    frame.results.resize(resultCount);
+    for (TrackingResult& result : frame.results)
+    {
+        if (!getResult(resultsIn, result))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool
+TrackingLogReader::rewind()
+{
+    return mFile != nullptr && std::fseek(mFile, mFirstFrameOffset, SEEK_SET) == 0;
+}
@@ -0,0 +1,86 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __TRACKING_LOG_H__
+#define __TRACKING_LOG_H__
+
+#include "TrackingFrame.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+/*
+ * Binary log of TrackingFrames.
+ * The file starts with a small header (magic, version, the selected target) followed by one
+ * record per frame: the fixed fields of the TrackingFrame followed by its results, each
+ * stored field by field without padding.
+ * Values are stored little endian and read back with a bounds checked ByteReader.
+ */
+
+/// Writes TrackingFrames to a log file
+class TrackingLogWriter
+{
+public:
+    TrackingLogWriter() = default;
+    TrackingLogWriter(const TrackingLogWriter&) = delete;
+    TrackingLogWriter& operator=(const TrackingLogWriter&) = delete;
+    ~TrackingLogWriter() { close(); }
+
+    /// Create or truncate the log at path. target is AppController::IMAGE_TARGET_ID or MODEL_TARGET_ID.
+    bool open(const std::string& path, int target);
+    void close();
+    bool isOpen() const { return mFile != nullptr; }
+
+    /// Append a frame. Returns false, and closes the log, if writing fails.
+    bool write(const TrackingFrame& frame);
+
+    std::uint64_t getFrameCount() const { return mFrameCount; }
+
+private: // data members
+
+    std::FILE* mFile = nullptr;
+    std::uint64_t mFrameCount = 0;
+    /// Bytes of the frame being written, kept to avoid allocating every frame
+    std::vector<char> mRecord;
+};
+
+/// Reads TrackingFrames back from a log file written by TrackingLogWriter
+class TrackingLogReader
+{
+public:
+    TrackingLogReader() = default;
+    TrackingLogReader(const TrackingLogReader&) = delete;
+    TrackingLogReader& operator=(const TrackingLogReader&) = delete;
+    ~TrackingLogReader() { close(); }
+
+    /// Open the log at path and check its header
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return mFile != nullptr; }
+
+    /// Target the log was recorded with, valid after open
+    int getTarget() const { return mTarget; }
+
+    /// Read the next frame. Returns false at the end of the log or if the log is corrupt.
+    bool read(TrackingFrame& frame);
+
+    /// Go back to the first frame
+    bool rewind();
+
+private: // data members
+
+    std::FILE* mFile = nullptr;
+    long mFirstFrameOffset = 0;
+    int mTarget = 0;
+    /// Bytes of the frame being read, kept to avoid allocating every frame
+    std::vector<char> mRecord;
+};
+
+#endif // __TRACKING_LOG_H__
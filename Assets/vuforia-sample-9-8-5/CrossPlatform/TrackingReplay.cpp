@@ -0,0 +1,79 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "TrackingReplay.h"
+
+#include <chrono>
+
+
+bool
+TrackingReplay::open(const std::string& path)
+{
+    if (!mReader.open(path))
+    {
+        return false;
+    }
+
+    mController.initReplay(mReader.getTarget());
+    resetStats();
+    return true;
+}
+
+
+bool
+TrackingReplay::step()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    if (!mReader.read(mFrame))
+    {
+        return false;
+    }
+
+    mController.publishTrackingFrame(mFrame);
+    mController.acquireFrameSnapshot();
+
+    // Same sequence of getters as the render loop
+    Vuforia::Matrix44F projectionMatrix;
+    Vuforia::Matrix44F modelViewMatrix;
+    Vuforia::Matrix44F scaledModelViewMatrix;
+    Vuforia::Image* guideViewImage;
+
+    if (mController.getOrigin(projectionMatrix, modelViewMatrix))
+    {
+        mStats.originFrames++;
+    }
+
+    if (mController.getImageTargetResult(projectionMatrix, modelViewMatrix, scaledModelViewMatrix) ||
+        mController.getModelTargetResult(projectionMatrix, modelViewMatrix, scaledModelViewMatrix))
+    {
+        mStats.targetFrames++;
+    }
+    else if (mController.getModelTargetGuideView(projectionMatrix, modelViewMatrix, &guideViewImage))
+    {
+        mStats.guideViewFrames++;
+    }
+
+    mStats.frames++;
+    mStats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+
+const TrackingReplay::Stats&
+TrackingReplay::run(std::uint64_t maxFrames)
+{
+    for (std::uint64_t i = 0; maxFrames == 0 || i < maxFrames; i++)
+    {
+        if (!step())
+        {
+            break;
+        }
+    }
+
+    return mStats;
+}
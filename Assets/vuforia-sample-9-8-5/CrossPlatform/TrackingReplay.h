@@ -0,0 +1,68 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __TRACKING_REPLAY_H__
+#define __TRACKING_REPLAY_H__
+
+#include "AppController.h"
+#include "TrackingLog.h"
+
+#include <cstdint>
+#include <string>
+
+
+/// Feeds a TrackingLog recorded with AppController::startRecording back through an AppController.
+/**
+ * Each frame goes through publishTrackingFrame and is then read back with getOrigin,
+ * getImageTargetResult, getModelTargetResult and getModelTargetGuideView, the same calls the
+ * render loop makes. Frames are replayed as fast as possible, without a camera, a rendering
+ * device or the Vuforia engine, which makes this usable as a benchmark and regression harness.
+ */
+class TrackingReplay
+{
+public:
+
+    /// What the getters returned over the replayed frames
+    struct Stats
+    {
+        std::uint64_t frames = 0;
+        std::uint64_t originFrames = 0;
+        std::uint64_t targetFrames = 0;
+        std::uint64_t guideViewFrames = 0;
+        /// Wall clock time spent in step(), in seconds
+        double seconds = 0.0;
+    };
+
+    explicit TrackingReplay(AppController& controller) : mController(controller) {}
+
+    /// Open the log at path and prepare the controller for its target
+    bool open(const std::string& path);
+
+    /// Replay the next frame. Returns false at the end of the log.
+    bool step();
+
+    /// Replay all remaining frames, or at most maxFrames if it is not 0, and return the statistics
+    const Stats& run(std::uint64_t maxFrames = 0);
+
+    /// Go back to the first frame, keeps the statistics
+    bool rewind() { return mReader.rewind(); }
+
+    const Stats& getStats() const { return mStats; }
+    void resetStats() { mStats = Stats(); }
+
+    /// Matrices returned for the last replayed frame, valid if the matching Stats counter was incremented
+    const AppController::FrameSnapshot& getLastSnapshot() const { return mController.getFrameSnapshot(); }
+
+private: // data members
+
+    AppController& mController;
+    TrackingLogReader mReader;
+    TrackingFrame mFrame;
+    Stats mStats;
+};
+
+#endif // __TRACKING_REPLAY_H__
@@ -0,0 +1,79 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __TRIPLE_BUFFER_H__
+#define __TRIPLE_BUFFER_H__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+
+/// Lock-free single producer, single consumer triple buffer.
+/**
+ * The producer fills getWriteBuffer() and calls publish(). The consumer calls acquireLatest()
+ * and then reads getReadBuffer(), which stays unchanged until its next acquireLatest() call.
+ * One buffer is owned by each side and the third is handed between them with a single atomic
+ * exchange, so neither side ever waits for the other. Snapshots published while the consumer
+ * is busy replace each other: the consumer always gets the most recent complete one.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+
+    /// Buffer the producer may fill, not visible to the consumer until publish()
+    T& getWriteBuffer() { return mBuffers[mWriteIndex].value; }
+
+    /// Make the write buffer available to the consumer and take over the previous shared buffer
+    void publish()
+    {
+        std::uint8_t previous = mShared.exchange(static_cast<std::uint8_t>(mWriteIndex | FRESH_BIT),
+                                                 std::memory_order_acq_rel);
+        mWriteIndex = previous & INDEX_MASK;
+    }
+
+    /// Switch the read buffer to the latest published one.
+    /// Returns false, leaving the read buffer as it was, if nothing was published since the last call.
+    bool acquireLatest()
+    {
+        if ((mShared.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+        {
+            return false;
+        }
+
+        std::uint8_t previous = mShared.exchange(mReadIndex, std::memory_order_acq_rel);
+        mReadIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    /// Buffer the consumer may read
+    const T& getReadBuffer() const { return mBuffers[mReadIndex].value; }
+
+private: // types
+
+    /// Keep each buffer on its own cache line so producer and consumer do not share one
+    struct alignas(64) Slot
+    {
+        T value{};
+    };
+
+    static constexpr std::uint8_t INDEX_MASK = 0x3;
+    static constexpr std::uint8_t FRESH_BIT = 0x4;
+
+private: // data members
+
+    std::array<Slot, 3> mBuffers;
+    /// Index of the buffer in transit, plus FRESH_BIT when the consumer has not taken it yet
+    std::atomic<std::uint8_t> mShared{ 1 };
+    /// Owned by the producer
+    std::uint8_t mWriteIndex = 0;
+    /// Owned by the consumer
+    std::uint8_t mReadIndex = 2;
+};
+
+#endif // __TRIPLE_BUFFER_H__
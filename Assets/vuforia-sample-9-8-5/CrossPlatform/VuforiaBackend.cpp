@@ -0,0 +1,905 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+ 
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "VuforiaBackend.h"
+
+#include "AppController.h"
+#include "Log.h"
+
+#include <Vuforia/Vuforia.h>
+#include <Vuforia/Tool.h>
+#include <Vuforia/DataSet.h>
+#include <Vuforia/Device.h>
+#include <Vuforia/Renderer.h>
+#include <Vuforia/CameraDevice.h>
+#include <Vuforia/VideoBackgroundConfig.h>
+#include <Vuforia/UpdateCallback.h>
+#include <Vuforia/Matrices.h>
+#include <Vuforia/State.h>
+#include <Vuforia/TrackerManager.h>
+#include <Vuforia/ObjectTracker.h>
+#include <Vuforia/Trackable.h>
+#include <Vuforia/StateUpdater.h>
+#include <Vuforia/ModelTarget.h>
+#include <Vuforia/VideoBackgroundTextureInfo.h>
+#include <Vuforia/ImageTargetResult.h>
+#include <Vuforia/ModelTargetResult.h>
+#include <Vuforia/RenderingPrimitives.h>
+#include <Vuforia/PositionalDeviceTracker.h>
+#include <Vuforia/DeviceTrackableResult.h>
+#include <Vuforia/GuideView.h>
+#include <Vuforia/Image.h>
+
+#if defined(ANDROID) || defined (__ANDROID__)  // ANDROID
+#include <Vuforia/Android/Vuforia_Android.h>
+#include <Vuforia/GLRenderer.h>
+#elif defined(WINAPI_FAMILY) // UWP
+#include <Vuforia/UWP/Vuforia_UWP.h>
+#include <Vuforia/UWP/DXRenderer.h>
+#else // iOS
+#include <Vuforia/iOS/Vuforia_iOS.h>
+#include <Vuforia/iOS/MetalRenderer.h>
+#endif
+
+#include <algorithm>
+#include <string>
+
+
+namespace
+{
+    constexpr char licenseKey[] = "";
+
+    /// TrackingResult mirrors the Vuforia status values, so they are copied unchanged
+    static_assert(TrackingResult::NO_POSE == int(Vuforia::TrackableResult::NO_POSE) &&
+                  TrackingResult::LIMITED == int(Vuforia::TrackableResult::LIMITED) &&
+                  TrackingResult::DETECTED == int(Vuforia::TrackableResult::DETECTED) &&
+                  TrackingResult::TRACKED == int(Vuforia::TrackableResult::TRACKED) &&
+                  TrackingResult::EXTENDED_TRACKED == int(Vuforia::TrackableResult::EXTENDED_TRACKED),
+                  "TrackingResult::Status must match Vuforia::TrackableResult::STATUS");
+    static_assert(TrackingResult::NORMAL == int(Vuforia::TrackableResult::NORMAL) &&
+                  TrackingResult::NO_DETECTION_RECOMMENDING_GUIDANCE ==
+                      int(Vuforia::TrackableResult::NO_DETECTION_RECOMMENDING_GUIDANCE),
+                  "TrackingResult::StatusInfo must match Vuforia::TrackableResult::STATUS_INFO");
+
+    /// Copy the properties shared by all trackable results, clearing the type specific ones
+    void captureTrackingResult(const Vuforia::TrackableResult& result, TrackingResultType type, TrackingResult& out)
+    {
+        out = TrackingResult();
+        out.size = Vuforia::Vec3F(0.0f, 0.0f, 0.0f);
+        out.obbCenter = Vuforia::Vec3F(0.0f, 0.0f, 0.0f);
+        out.obbHalfExtents = Vuforia::Vec3F(0.0f, 0.0f, 0.0f);
+        out.type = type;
+        out.trackableId = result.getTrackable().getId();
+        out.status = result.getStatus();
+        out.statusInfo = result.getStatusInfo();
+        out.timestamp = result.getTimeStamp();
+        out.pose = result.getPose();
+    }
+}
+
+
+/*===============================================================================
+VuforiaBackend public methods
+===============================================================================*/
+
+bool VuforiaBackend::init(void* appData, int initFlags, const ErrorCallback& showError)
+{
+    mVuforiaInitFlags = initFlags;
+    mShowErrorCallback = showError;
+
+    mDoneOneTimeRenderingConfiguration = false;
+    mCameraIsActive = false;
+    mCameraIsStarted = false;
+
+    if (!initVuforiaInternal(appData))
+    {
+        return false;
+    }
+
+    return initTrackers();
+}
+
+
+
+bool VuforiaBackend::loadData(int target)
+{
+    if (mCurrentDataSet != nullptr)
+    {
+        mShowErrorCallback("Attempt to load a dataset when one is already loaded");
+        return false;
+    }
+
+    if (target == AppController::IMAGE_TARGET_ID)
+    {
+        mCurrentDataSet = loadAndActivateDataSet("StonesAndChips.xml");
+        if (mCurrentDataSet == nullptr)
+        {
+            mShowErrorCallback("Error loading dataset for Image Target");
+            return false;
+        }
+    }
+    else
+    {
+        mCurrentDataSet = loadAndActivateDataSet("VuforiaMars_ModelTarget.xml");
+        if (mCurrentDataSet == nullptr)
+        {
+            mShowErrorCallback("Error loading dataset for Model Target");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void VuforiaBackend::deinit()
+{
+    Vuforia::onPause();
+
+    // ask the application to unload the data associated to the trackers
+    if(!unloadTrackerData())
+    {
+        LOG("Error unloading tracker data.");
+    }
+    
+    // ask the application to deinit the trackers
+    deinitTrackers();
+
+    Vuforia::deinit();
+}
+
+
+bool VuforiaBackend::start()
+{
+    if (mCameraIsStarted || mCameraIsActive)
+    {
+        LOG("Application logic error, attempt to startAR when already started");
+        return false;
+    }
+
+    // initialize the camera
+    if (! Vuforia::CameraDevice::getInstance().init())
+    {
+        mShowErrorCallback("Failed to initialize the camera");
+        return false;
+    }
+
+    // select the default video mode
+    if(! Vuforia::CameraDevice::getInstance().selectVideoMode(mCameraMode))
+    {
+        mShowErrorCallback("Failed to set the camera mode");
+        return false;
+    }
+
+    // set the FPS to its recommended value
+    int recommendedFps = Vuforia::Renderer::getInstance().getRecommendedFps();
+    Vuforia::Renderer::getInstance().setTargetFps(recommendedFps);
+
+    if (!startTrackers() )
+    {
+        mShowErrorCallback("Failed to start trackers");
+        return false;
+    }
+
+    if (!Vuforia::CameraDevice::getInstance().start())
+    {
+        mShowErrorCallback("Failed to start the camera");
+        return false;
+    }
+
+    // Set camera to autofocus
+    if (!Vuforia::CameraDevice::getInstance().setFocusMode(Vuforia::CameraDevice::FOCUS_MODE_CONTINUOUSAUTO))
+    {
+        LOG("Failed to set camera to continuous autofocus, camera may not support this");
+    }
+
+    mCameraIsActive = true;
+    mCameraIsStarted = true;
+    return true;
+    
+}
+
+
+void VuforiaBackend::stop()
+{
+    // Stop the camera
+    if (mCameraIsActive)
+    {
+        // Stop and deinit the camera
+        Vuforia::CameraDevice::getInstance().stop();
+        Vuforia::CameraDevice::getInstance().deinit();
+        mCameraIsActive = false;
+    }
+    mCameraIsStarted = false;
+
+    // Stop trackers
+    stopTrackers();
+}
+
+
+void VuforiaBackend::pause()
+{
+    bool successfullyPaused = true;
+    std::string cameraErrorMessage;
+    
+    if (mCameraIsActive)
+    {
+        // Stop and deinit the camera
+        if(! Vuforia::CameraDevice::getInstance().stop())
+        {
+            cameraErrorMessage = "Error stopping the camera";
+            successfullyPaused = false;
+        }
+        if(! Vuforia::CameraDevice::getInstance().deinit())
+        {
+            cameraErrorMessage = "Error de-initializing the camera";
+            successfullyPaused = false;
+        }
+        mCameraIsActive = false;
+    }
+
+    stopTrackers();
+
+    Vuforia::onPause();
+    
+    if(!successfullyPaused)
+    {
+        LOG("Error pausing AR: %s",cameraErrorMessage.c_str());
+    }
+}
+
+
+void VuforiaBackend::resume()
+{
+    Vuforia::onResume();
+
+    startTrackers();
+    
+    std::string cameraErrorMessage;
+    bool successfullyResumed = true;
+    // if the camera was previously started, but not currently active, then
+    // we restart it
+    if ((mCameraIsStarted) && (!mCameraIsActive))
+    {
+        
+        // initialize the camera
+        if ( !Vuforia::CameraDevice::getInstance().init() )
+        {
+            cameraErrorMessage = "Failed to initialize the camera.";
+            successfullyResumed = false;
+        }
+        else if ( !Vuforia::CameraDevice::getInstance().start() )
+        {
+            cameraErrorMessage = "Failed to start the camera.";
+            successfullyResumed = false;
+        }
+        else
+        {
+             mCameraIsActive = true;
+        }
+    }
+    
+    if(!successfullyResumed)
+    {
+        LOG("Error resuming AR: %s", cameraErrorMessage.c_str());
+    }
+
+    if (mCameraIsStarted)
+    {
+        updateRenderingPrimitives();
+    }
+}
+
+
+void VuforiaBackend::cameraPerformAutoFocus()
+{
+    Vuforia::CameraDevice::getInstance().setFocusMode(Vuforia::CameraDevice::FOCUS_MODE_TRIGGERAUTO);
+}
+
+
+void VuforiaBackend::cameraRestoreAutoFocus()
+{
+    Vuforia::CameraDevice::getInstance().setFocusMode(Vuforia::CameraDevice::FOCUS_MODE_CONTINUOUSAUTO);
+}
+
+
+bool VuforiaBackend::configureRendering(int width, int height, int orientation)
+{
+    if (!mCameraIsStarted)
+    {
+        return false;
+    }
+
+    mOrientation = orientation;
+    {
+        std::lock_guard<std::mutex> lock(mRenderingPrimitivesMutex);
+        mDisplayAspectRatio = (float)width / height;
+    }
+
+    setVuforiaOrientation(orientation);
+
+    if (!mDoneOneTimeRenderingConfiguration)
+    {
+        mDoneOneTimeRenderingConfiguration = true;
+        // Tell Vuforia Engine we've created a drawing surface
+        Vuforia::onSurfaceCreated();
+    }
+
+    int smallerSize = std::min(width, height);
+    int largerSize = std::max(width, height);
+    if (isScreenPortrait())
+    {
+        Vuforia::onSurfaceChanged(smallerSize, largerSize);
+    }
+    else
+    {
+        Vuforia::onSurfaceChanged(largerSize, smallerSize);
+    }
+
+    configureVideoBackground(float(width), float(height));
+
+    return true;
+}
+
+
+void VuforiaBackend::updateRenderingPrimitives()
+{
+    std::lock_guard<std::mutex> lock(mRenderingPrimitivesMutex);
+    mCurrentRenderingPrimitives.reset(new Vuforia::RenderingPrimitives(Vuforia::Device::getInstance().getRenderingPrimitives()));
+}
+
+
+const Vuforia::RenderingPrimitives* VuforiaBackend::getRenderingPrimitives() const
+{
+    std::lock_guard<std::mutex> lock(mRenderingPrimitivesMutex);
+    return mCurrentRenderingPrimitives.get();
+}
+
+std::shared_ptr<const TrackingBackend::RenderState> VuforiaBackend::update(TrackingFrame& frame, std::vector<const Vuforia::Image*>& guideViewImages)
+{
+    auto& stateUpdater = Vuforia::TrackerManager::getInstance().getStateUpdater();
+    auto renderState = acquireRenderState();
+    renderState->state = stateUpdater.updateState();
+    const Vuforia::State& state = renderState->state;
+
+    frame.frameIndex = state.getFrame().getIndex();
+    frame.captureTime = stateUpdater.getCurrentTimeStamp();
+
+    const Vuforia::CameraCalibration* cameraCalibration = state.getCameraCalibration();
+    frame.hasCameraCalibration = (cameraCalibration != nullptr);
+    if (cameraCalibration != nullptr)
+    {
+        frame.cameraSize = cameraCalibration->getSize();
+        frame.cameraFocalLength = cameraCalibration->getFocalLength();
+        frame.cameraPrincipalPoint = cameraCalibration->getPrincipalPoint();
+        frame.cameraFieldOfViewRads = cameraCalibration->getFieldOfViewRads();
+    }
+
+    {
+        // configureRendering may replace the primitives on the render thread
+        std::lock_guard<std::mutex> lock(mRenderingPrimitivesMutex);
+        if (mCurrentRenderingPrimitives == nullptr)
+        {
+            mCurrentRenderingPrimitives.reset(new Vuforia::RenderingPrimitives(Vuforia::Device::getInstance().getRenderingPrimitives()));
+        }
+
+        frame.viewport = mCurrentRenderingPrimitives->getViewport(Vuforia::VIEW_SINGULAR);
+        frame.projectionMatrix = Vuforia::Tool::convertPerspectiveProjection2GLMatrix(
+            mCurrentRenderingPrimitives->getProjectionMatrix(Vuforia::VIEW_SINGULAR, cameraCalibration),
+            NEAR_PLANE, FAR_PLANE);
+        frame.displayAspectRatio = mDisplayAspectRatio;
+    }
+
+    auto deviceResult = state.getDeviceTrackableResult();
+    frame.hasDeviceResult = (deviceResult != nullptr);
+    if (deviceResult != nullptr)
+    {
+        captureTrackingResult(*deviceResult, TrackingResultType::DEVICE, frame.deviceResult);
+    }
+
+    const auto& trackableResultList = state.getTrackableResults();
+    frame.results.resize(trackableResultList.size());
+    guideViewImages.assign(trackableResultList.size(), nullptr);
+
+    size_t i = 0;
+    for (const auto* result : trackableResultList)
+    {
+        TrackingResult& out = frame.results[i];
+        if (result->isOfType(Vuforia::ImageTargetResult::getClassType()))
+        {
+            const auto* itResult = static_cast<const Vuforia::ImageTargetResult*>(result);
+            captureTrackingResult(*result, TrackingResultType::IMAGE_TARGET, out);
+            out.size = itResult->getTrackable().getSize();
+        }
+        else if (result->isOfType(Vuforia::ModelTargetResult::getClassType()))
+        {
+            const auto* mtResult = static_cast<const Vuforia::ModelTargetResult*>(result);
+            const Vuforia::ModelTarget& target = mtResult->getTrackable();
+            captureTrackingResult(*result, TrackingResultType::MODEL_TARGET, out);
+            out.size = target.getSize();
+
+            Vuforia::Obb3D boundingBox = target.getBoundingBox();
+            out.obbCenter = boundingBox.getCenter();
+            out.obbHalfExtents = boundingBox.getHalfExtents();
+            out.obbRotationZ = boundingBox.getRotationZ();
+
+            auto guideViewList = target.getGuideViews();
+            if (guideViewList.size() != 0)
+            {
+                const Vuforia::Image* guideImage = guideViewList.at(0)->getImage();
+                out.guideViewWidth = guideImage->getWidth();
+                out.guideViewHeight = guideImage->getHeight();
+                guideViewImages[i] = guideImage;
+            }
+        }
+        else
+        {
+            bool isDevice = result->isOfType(Vuforia::DeviceTrackableResult::getClassType());
+            captureTrackingResult(*result, isDevice ? TrackingResultType::DEVICE : TrackingResultType::OTHER, out);
+        }
+
+        i++;
+    }
+
+    return renderState;
+}
+
+
+bool VuforiaBackend::beginRender(const RenderState& renderState, double* viewport, Vuforia::RenderData* renderData,
+                                 Vuforia::TextureUnit* videoBackgroundTextureUnit, Vuforia::TextureData* videoBackgroundTexture)
+{
+    auto& renderer = Vuforia::Renderer::getInstance();
+    renderer.begin(static_cast<const VuforiaRenderState&>(renderState).state, renderData);
+    
+    // Set up the viewport
+    Vuforia::Vec4I viewportInfo;
+    // We're writing directly to the screen, so the viewport is relative to the screen
+    viewportInfo = getRenderingPrimitives()->getViewport(Vuforia::VIEW_SINGULAR);
+    viewport[0] = viewportInfo.data[0];
+    viewport[1] = viewportInfo.data[1];
+    viewport[2] = viewportInfo.data[2];
+    viewport[3] = viewportInfo.data[3];
+    viewport[4] = 0.0f;
+    viewport[5] = 1.0f;
+
+    if (videoBackgroundTexture != nullptr)
+    {
+        renderer.setVideoBackgroundTexture(*videoBackgroundTexture);
+    }
+
+    return renderer.updateVideoBackgroundTexture(videoBackgroundTextureUnit);
+}
+
+
+void VuforiaBackend::endRender(Vuforia::RenderData* renderData)
+{
+    Vuforia::Renderer::getInstance().end(renderData);
+}
+
+
+double VuforiaBackend::getCurrentTimeStamp() const
+{
+    return Vuforia::TrackerManager::getInstance().getStateUpdater().getCurrentTimeStamp();
+}
+
+
+/*===============================================================================
+VuforiaBackend private methods
+===============================================================================*/
+
+std::shared_ptr<VuforiaBackend::VuforiaRenderState> VuforiaBackend::acquireRenderState()
+{
+    // A state is free again once the snapshots that referenced it have been overwritten,
+    // so after the first few frames this never allocates
+    for (const auto& renderState : mRenderStates)
+    {
+        if (renderState.use_count() == 1)
+        {
+            return renderState;
+        }
+    }
+
+    mRenderStates.push_back(std::make_shared<VuforiaRenderState>());
+    return mRenderStates.back();
+}
+
+
+bool VuforiaBackend::initVuforiaInternal(void* appData)
+{
+#if defined (__ANDROID__)  // ANDROID
+    Vuforia::setInitParameters(jobject(appData), mVuforiaInitFlags, licenseKey);
+
+#elif defined(WINAPI_FAMILY) // UWP
+    (void)appData;
+    Vuforia::setInitParameters(licenseKey);
+
+#elif defined(__APPLE__)// iOS
+    Vuforia::setInitParameters(mVuforiaInitFlags, licenseKey);
+
+#else
+#error "Unsupported platform"
+#endif
+
+    // Vuforia::init() will return positive numbers up to 100 as it progresses
+    // towards success.  Negative numbers indicate error conditions
+    int progress = 0;
+    while (progress >= 0 && progress < 100)
+    {
+        progress = Vuforia::init();
+    }
+    
+    if (progress == 100)
+    {
+        return true;
+    }
+    
+    // Failed to initialise Vuforia Engine:
+    std::string cameraAccessErrorMessage = "";
+
+    switch(progress)
+    {
+        case Vuforia::INIT_NO_CAMERA_ACCESS:
+            // On most platforms the user must explicitly grant camera access
+            // If the access request is denied this code is returned
+            cameraAccessErrorMessage = "Vuforia cannot initialize because access to the camera was denied.";
+            break;
+                
+        case Vuforia::INIT_LICENSE_ERROR_NO_NETWORK_TRANSIENT:
+            cameraAccessErrorMessage = "Vuforia failed to initialize because the license check encountered a temporary network error.";
+            break;
+                
+        case Vuforia::INIT_LICENSE_ERROR_NO_NETWORK_PERMANENT:
+            cameraAccessErrorMessage = "Vuforia failed to initialize because the license check encountered a permanent network error.";
+            break;
+                
+        case Vuforia::INIT_LICENSE_ERROR_INVALID_KEY:
+            cameraAccessErrorMessage = "Vuforia failed to initialize because the license key is invalid.";
+            break;
+                
+        case Vuforia::INIT_LICENSE_ERROR_CANCELED_KEY:
+            cameraAccessErrorMessage = "Vuforia failed to initialize because the license key was cancelled.";
+            break;
+                
+        case Vuforia::INIT_LICENSE_ERROR_MISSING_KEY:
+            cameraAccessErrorMessage = "Vuforia failed to initialize because the license key was missing.";
+            break;
+                
+        case Vuforia::INIT_LICENSE_ERROR_PRODUCT_TYPE_MISMATCH:
+            cameraAccessErrorMessage = "Vuforia failed to initialize because the license key is for the wrong product type.";
+            break;
+                
+        case Vuforia::INIT_DEVICE_NOT_SUPPORTED:
+            cameraAccessErrorMessage = "Vuforia failed to initialize because the device is not supported.";
+            break;
+                
+        default:
+            cameraAccessErrorMessage = "Vuforia initialization failed.";
+            break;
+    }
+    // Vuforia Engine initialization error
+    mShowErrorCallback(cameraAccessErrorMessage.c_str());
+
+    return false;
+}
+
+
+void VuforiaBackend::setVuforiaOrientation(int orientation) const
+{
+#if defined(ANDROID) || defined (__ANDROID__)  // ANDROID
+    
+#elif defined(WINAPI_FAMILY) // UWP
+    switch (orientation)
+    {
+    case 0: // Portrait
+        Vuforia::setCurrentOrientation(Vuforia::DISPLAY_ORIENTATION::PORTRAIT);
+        break;
+    case 1: // "PortraitUpsideDown"
+        Vuforia::setCurrentOrientation(Vuforia::DISPLAY_ORIENTATION::PORTRAIT_FLIPPED);
+        break;
+    case 2: // "LandscapeLeft"
+        Vuforia::setCurrentOrientation(Vuforia::DISPLAY_ORIENTATION::LANDSCAPE);
+        break;
+    case 3: // "LandscapeRight"
+        Vuforia::setCurrentOrientation(Vuforia::DISPLAY_ORIENTATION::LANDSCAPE_FLIPPED);
+        break;
+    }
+
+#else // iOS
+    switch (orientation)
+    {
+        case 0: // Portrait
+            Vuforia::setRotation(Vuforia::ROTATE_IOS_90);
+            break;
+        case 1: // "PortraitUpsideDown"
+            Vuforia::setRotation(Vuforia::ROTATE_IOS_270);
+            break;
+        case 2: // "LandscapeLeft"
+            Vuforia::setRotation(Vuforia::ROTATE_IOS_180);
+            break;
+        case 3: // "LandscapeRight"
+            Vuforia::setRotation(Vuforia::ROTATE_IOS_0);
+            break;
+    }
+#endif    
+}
+
+
+bool VuforiaBackend::initTrackers()
+{
+    // Initialize the object tracker
+    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
+    
+    Vuforia::Tracker* tracker = trackerManager.initTracker(Vuforia::PositionalDeviceTracker::getClassType());
+    if (tracker == nullptr)
+    {
+        LOG("Error: Failed to initialise the Device tracker (it may have been initialised already)");
+        mShowErrorCallback("Error initializing the device tracker");
+        return false;
+    }
+    
+    Vuforia::Tracker* trackerBase = trackerManager.initTracker(Vuforia::ObjectTracker::getClassType());
+    if (trackerBase == NULL)
+    {
+        LOG("Error: Failed to initialize ObjectTracker.");
+        mShowErrorCallback("Error initializing the object tracker");
+        return false;
+    }
+
+    return true;
+}
+
+
+bool VuforiaBackend::unloadTrackerData()
+{
+    // Get the image tracker:
+    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
+    Vuforia::ObjectTracker* objectTracker = static_cast<Vuforia::ObjectTracker*>(trackerManager.getTracker(Vuforia::ObjectTracker::getClassType()));
+    if (objectTracker == nullptr)
+    {
+        return false;
+    }
+    
+    if (!objectTracker->deactivateDataSet(mCurrentDataSet))
+    {
+        LOG("Warning: Failed to deactivate the data set.");
+    }
+    
+    if (!objectTracker->destroyDataSet(mCurrentDataSet))
+    {
+        LOG("Warning: Failed to destory the data set.");
+    }
+    
+    mCurrentDataSet = nullptr;
+
+    return true;
+}
+
+
+bool VuforiaBackend::startTrackers()
+{
+    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
+    Vuforia::Tracker* deviceTracker = trackerManager.getTracker(Vuforia::PositionalDeviceTracker::getClassType());
+    if(deviceTracker != 0)
+    {
+        deviceTracker->start();
+    }
+    Vuforia::Tracker* tracker = trackerManager.getTracker(Vuforia::ObjectTracker::getClassType());
+    if(tracker == 0)
+    {
+        return false;
+    }
+    tracker->start();
+    return true;
+}
+
+
+void VuforiaBackend::stopTrackers()
+{
+    // Stop the tracker
+    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
+    
+    // Stop the object tracker
+    Vuforia::Tracker* objectTracker = trackerManager.getTracker(Vuforia::ObjectTracker::getClassType());
+    
+    if (objectTracker != nullptr)
+    {
+        objectTracker->stop();
+        LOG("Successfully stopped the ObjectTracker");
+    }
+    else
+    {
+        LOG("Error: Failed to get the ObjectTracker from the tracker manager");
+    }
+    
+    Vuforia::Tracker* deviceTracker = trackerManager.getTracker(Vuforia::PositionalDeviceTracker::getClassType());
+    
+    if (deviceTracker != nullptr)
+    {
+        deviceTracker->stop();
+        LOG("Successfully stopped the PositionalDeviceTracker");
+    }
+    else
+    {
+        LOG("Error: Failed to get the PositionalDeviceTracker from the tracker manager");
+    }
+}
+
+
+void VuforiaBackend::deinitTrackers()
+{
+    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
+    trackerManager.deinitTracker(Vuforia::ObjectTracker::getClassType());
+    trackerManager.deinitTracker(Vuforia::PositionalDeviceTracker::getClassType());
+}
+
+
+void VuforiaBackend::configureVideoBackground(float viewWidth, float viewHeight)
+{
+    // Get the default video mode
+    Vuforia::CameraDevice& cameraDevice = Vuforia::CameraDevice::getInstance();
+    Vuforia::VideoMode videoMode = cameraDevice.getCurrentVideoMode();
+    
+    // Configure the video background
+    Vuforia::VideoBackgroundConfig config;
+    config.mPosition.data[0] = 0;
+    config.mPosition.data[1] = 0;
+    
+    // Determine the orientation of the view.  Note, this simple test assumes
+    // that a view is portrait if its height is greater than its width.  This is
+    // not always true: it is perfectly reasonable for a view with portrait
+    // orientation to be wider than it is high.  The test is suitable for the
+    // dimensions used in this sample
+    if (isScreenPortrait())
+    {
+        // --- View is portrait ---
+        
+        // Compare aspect ratios of video and screen.  If they are different we
+        // use the full screen size while maintaining the video's aspect ratio,
+        // which naturally entails some cropping of the video
+        float aspectRatioVideo = (float)videoMode.mWidth / (float)videoMode.mHeight;
+        float aspectRatioView = viewHeight / viewWidth;
+        
+        if (aspectRatioVideo < aspectRatioView)
+        {
+            // Video (when rotated) is wider than the view: crop left and right
+            // (top and bottom of video)
+            
+            // --============--
+            // - =          = _
+            // - =          = _
+            // - =          = _
+            // - =          = _
+            // - =          = _
+            // - =          = _
+            // - =          = _
+            // - =          = _
+            // --============--
+            
+            config.mSize.data[0] = int(videoMode.mHeight * (viewHeight / float(videoMode.mWidth)));
+            config.mSize.data[1] = int(viewHeight);
+        }
+        else
+        {
+            // Video (when rotated) is narrower than the view: crop top and
+            // bottom (left and right of video).  Also used when aspect ratios
+            // match (no cropping)
+            
+            // ------------
+            // -          -
+            // -          -
+            // ============
+            // =          =
+            // =          =
+            // =          =
+            // =          =
+            // =          =
+            // =          =
+            // =          =
+            // =          =
+            // ============
+            // -          -
+            // -          -
+            // ------------
+            
+            config.mSize.data[0] = int(viewWidth);
+            config.mSize.data[1] = int(videoMode.mWidth * (viewWidth / float(videoMode.mHeight)));
+        }
+        
+    }
+    else
+    {
+        // --- View is landscape ---
+        
+        // Compare aspect ratios of video and screen.  If they are different we
+        // use the full screen size while maintaining the video's aspect ratio,
+        // which naturally entails some cropping of the video
+        float aspectRatioVideo = (float)videoMode.mWidth / (float)videoMode.mHeight;
+        float aspectRatioView = viewWidth / viewHeight;
+        
+        if (aspectRatioVideo < aspectRatioView)
+        {
+            // Video is taller than the view: crop top and bottom
+            
+            // --------------------
+            // ====================
+            // =                  =
+            // =                  =
+            // =                  =
+            // =                  =
+            // ====================
+            // --------------------
+            
+            config.mSize.data[0] = int(viewWidth);
+            config.mSize.data[1] = int(videoMode.mHeight * (viewWidth / float(videoMode.mWidth)));
+        }
+        else
+        {
+            // Video is wider than the view: crop left and right.  Also used
+            // when aspect ratios match (no cropping)
+            
+            // ---====================---
+            // -  =                  =  -
+            // -  =                  =  -
+            // -  =                  =  -
+            // -  =                  =  -
+            // ---====================---
+            
+            config.mSize.data[0] = int(videoMode.mWidth * (viewHeight / float(videoMode.mHeight)));
+            config.mSize.data[1] = int(viewHeight);
+        }
+        
+    }
+    
+    // Set the config
+    Vuforia::Renderer::getInstance().setVideoBackgroundConfig(config);
+    updateRenderingPrimitives();
+}
+
+
+Vuforia::DataSet* VuforiaBackend::loadAndActivateDataSet(std::string path)
+{
+    LOG("Loading data set from %s", path.c_str());
+    Vuforia::DataSet* dataSet = nullptr;
+    
+    // Get the Vuforia tracker manager image tracker
+    Vuforia::TrackerManager& trackerManager = Vuforia::TrackerManager::getInstance();
+    Vuforia::ObjectTracker* objectTracker = static_cast<Vuforia::ObjectTracker*>(trackerManager.getTracker(Vuforia::ObjectTracker::getClassType()));
+    
+    if (objectTracker == nullptr)
+    {
+        LOG("Error: Failed to get the ObjectTracker from the TrackerManager");
+    }
+    else
+    {
+        dataSet = objectTracker->createDataSet();
+        if (dataSet == nullptr)
+        {
+            LOG("Error: Failed to create data set");
+        }
+        else
+        {
+            // Load the data set from the app's resources
+            if (!dataSet->load(path.c_str(), Vuforia::STORAGE_APPRESOURCE))
+            {
+                LOG("Error: Failed to load data set");
+                objectTracker->destroyDataSet(dataSet);
+                dataSet = nullptr;
+            }
+            else
+            {
+                if (!objectTracker->activateDataSet(dataSet))
+                {
+                    LOG("Error: Failed to activate data set");
+                    objectTracker->destroyDataSet(dataSet);
+                    dataSet = nullptr;
+                }
+            }
+        }
+    }
+    
+    return dataSet;
+}
@@ -0,0 +1,146 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __VUFORIA_BACKEND_H__
+#define __VUFORIA_BACKEND_H__
+
+#ifdef _MSC_VER
+#pragma warning(disable:4251)
+#endif
+#include <Vuforia/CameraDevice.h>
+#include <Vuforia/DataSet.h>
+#include <Vuforia/Image.h>
+#include <Vuforia/Renderer.h>
+#include <Vuforia/RenderingPrimitives.h>
+#include <Vuforia/State.h>
+#ifdef _MSC_VER
+#pragma warning(default:4251)
+#endif
+
+#include "TrackingBackend.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/// TrackingBackend running the Vuforia engine: camera, Device and Object trackers,
+/// dataset loading and video background rendering.
+class VuforiaBackend : public TrackingBackend
+{
+public:
+
+    bool init(void* appData, int initFlags, const ErrorCallback& showError) override;
+    bool loadData(int target) override;
+    void deinit() override;
+
+    bool start() override;
+    void stop() override;
+    void pause() override;
+    void resume() override;
+    bool isStarted() const override { return mCameraIsStarted; }
+
+    void cameraPerformAutoFocus() override;
+    void cameraRestoreAutoFocus() override;
+
+    bool configureRendering(int width, int height, int orientation) override;
+    void updateRenderingPrimitives() override;
+    const Vuforia::RenderingPrimitives* getRenderingPrimitives() const override;
+
+    std::shared_ptr<const RenderState> update(TrackingFrame& frame,
+                                              std::vector<const Vuforia::Image*>& guideViewImages) override;
+
+    bool beginRender(const RenderState& renderState, double* viewport, Vuforia::RenderData* renderData,
+                     Vuforia::TextureUnit* videoBackgroundTextureUnit,
+                     Vuforia::TextureData* videoBackgroundTextureData) override;
+    void endRender(Vuforia::RenderData* renderData) override;
+
+    double getCurrentTimeStamp() const override;
+
+private: // types
+
+    /// The Vuforia state a TrackingFrame was captured from, passed to the Vuforia renderer
+    struct VuforiaRenderState : RenderState
+    {
+        Vuforia::State state;
+    };
+
+private: // methods
+
+    /// Return a render state that no published frame refers to any more
+    std::shared_ptr<VuforiaRenderState> acquireRenderState();
+
+    /// Used by init to prepare and invoke Vuforia initialization.
+    bool initVuforiaInternal(void* appData);
+
+    /// Convert orientation parameter to platform specific value and pass to Vuforia.
+    void setVuforiaOrientation(int orientation) const;
+
+    /// Create the set of Vuforia Trackers needed in the application
+    bool initTrackers();
+
+    /// Clean up Trackers created by initTrackers
+    void deinitTrackers();
+
+    /// Deactivate and unload the currently selected target.
+    bool unloadTrackerData();
+
+    /// Start Vuforia trackers
+    bool startTrackers();
+
+    /// Stop Vuforia trackers
+    void stopTrackers();
+
+    /// Convenience method, returns trye if the screen is in portrait orientation.
+    bool isScreenPortrait() const { return mOrientation == 0 || mOrientation == 1; }
+
+    /// Calculate the video background configuration to pass to Vuforia.
+    void configureVideoBackground(float viewWidth, float viewHeight);
+
+    /// Utility method to load and activate datasets
+    /// Can be used before trackers are started.
+    /// During an active Vuforia session dataset activation is only allowed in the Vuforia_onUpdate() callback.
+    Vuforia::DataSet* loadAndActivateDataSet(std::string path);
+
+private: // data members
+
+    /// Callback to inform the user of an error
+    ErrorCallback mShowErrorCallback;
+    /// Vuforia initialization flags
+    int mVuforiaInitFlags = 0;
+
+    /// Local cache of current screen orientation for calculating rendering data
+    int mOrientation = 0;
+
+    /// The Vuforia camera mode to use, either DEFAULT, SPEED or QUALITY.
+    Vuforia::CameraDevice::MODE mCameraMode = Vuforia::CameraDevice::MODE_DEFAULT;
+    /// True when the Vuforia camera is currently started.
+    bool mCameraIsActive = false;
+    /// True when the Vuforia camera has been started. The camera may currently
+    /// be stopped because AR has been paused.
+    bool mCameraIsStarted = false;
+
+    /// Flag to ensure we only perform once-per-session rendering setup the first time
+    /// configureRendering is called
+    bool mDoneOneTimeRenderingConfiguration = false;
+    /// Guards the rendering primitives and the aspect ratio, which update reads on the
+    /// tracking thread while the render thread configures rendering
+    mutable std::mutex mRenderingPrimitivesMutex;
+    /// Local copy of current RenderingPrimitives
+    std::unique_ptr<Vuforia::RenderingPrimitives> mCurrentRenderingPrimitives;
+    /// Remember the display aspect ratio for later configuration of Guide View rendering
+    float mDisplayAspectRatio = 1.0f;
+
+    /// States returned by update, reused once no published frame refers to them
+    std::vector<std::shared_ptr<VuforiaRenderState>> mRenderStates;
+
+    /// The currently activated Vuforia DataSet.
+    Vuforia::DataSet*  mCurrentDataSet = nullptr;
+};
+
+#endif // __VUFORIA_BACKEND_H__
@@ -293,6 +293,9 @@ typedef struct callback_t_ {
   // There may be multiple group names
   void (*group_cb)(void *user_data, const char **names, int num_names);
   void (*object_cb)(void *user_data, const char *name);
+  // called per 's' line. `smoothing_group_id` applies to the faces that
+  // follow, 0 = smoothing is off.
+  void (*smoothing_group_cb)(void *user_data, unsigned int smoothing_group_id);
 
   callback_t_()
       : vertex_cb(NULL),
@@ -302,9 +305,72 @@ typedef struct callback_t_ {
         usemtl_cb(NULL),
         mtllib_cb(NULL),
         group_cb(NULL),
-        object_cb(NULL) {}
+        object_cb(NULL),
+        smoothing_group_cb(NULL) {}
 } callback_t;
 
+/// Monotonic arena for the temporaries of the loaders: the faces of the group
+/// being parsed and their vertex indices. Without it every face is a heap
+/// allocation of its own. Allocations are carved out of blocks of
+/// `block_size` bytes and never freed one by one, release() frees all blocks
+/// at once. The loaders use an arena of their own when none is given, pass one
+/// to keep its blocks across loads or to read its counters.
+/// An arena must not be used by two loads at the same time.
+class arena_t {
+ public:
+  explicit arena_t(size_t block_size = 256 * 1024);
+  ~arena_t();
+
+  void *allocate(size_t size, size_t alignment);
+
+  /// Frees every block. Everything allocated from the arena becomes invalid.
+  void release();
+
+  /// Allocations served, each would have been a heap call without the arena
+  size_t allocation_count() const { return allocation_count_; }
+  /// Heap calls made for blocks
+  size_t block_count() const { return block_count_; }
+  /// Bytes of all blocks
+  size_t block_bytes() const { return block_bytes_; }
+
+ private:
+  arena_t(const arena_t &);
+  arena_t &operator=(const arena_t &);
+
+  struct block {
+    block *next;
+  };
+
+  block *blocks_;
+  char *cur_;
+  char *end_;
+  size_t block_size_;
+  size_t allocation_count_;
+  size_t block_count_;
+  size_t block_bytes_;
+};
+
+/// Counters of a load, filled by the loaders given a `load_stats_t *`
+typedef struct load_stats_t_ {
+  size_t shape_count;        // shapes added to `shapes`
+  size_t shape_bytes_moved;  // bytes of the arrays of those shapes, moved
+                             // into `shapes` instead of copied
+  size_t bytes_copied;       // bytes of parsed data copied after parsing:
+                             // group tags and names, LoadObjParallel merges
+  size_t reallocations;      // times an attribute or shape array was
+                             // allocated or grown while parsing
+  size_t arena_allocations;  // see arena_t::allocation_count
+  size_t arena_blocks;       // see arena_t::block_count
+
+  load_stats_t_()
+      : shape_count(0),
+        shape_bytes_moved(0),
+        bytes_copied(0),
+        reallocations(0),
+        arena_allocations(0),
+        arena_blocks(0) {}
+} load_stats_t;
+
 class MaterialReader {
  public:
   MaterialReader() {}
@@ -356,11 +422,14 @@ class MaterialStreamReader : public MaterialReader {
 /// or not.
 /// Option 'default_vcols_fallback' specifies whether vertex colors should
 /// always be defined, even if no colors are given (fallback to white).
+/// 'arena' is optional, and holds the temporaries of the load, see arena_t.
+/// 'stats' is optional, and receives the counters of the load.
 bool LoadObj(attrib_t *attrib, std::vector<shape_t> *shapes,
              std::vector<material_t> *materials, std::string *warn,
              std::string *err, const char *filename,
              const char *mtl_basedir = NULL, bool triangulate = true,
-             bool default_vcols_fallback = true);
+             bool default_vcols_fallback = true, arena_t *arena = NULL,
+             load_stats_t *stats = NULL);
 
 /// Loads .obj from a file with custom user callback.
 /// .mtl is loaded as usual and parsed material_t data will be passed to
@@ -373,6 +442,18 @@ bool LoadObjWithCallback(std::istream &inStream, const callback_t &callback,
                          MaterialReader *readMatFn = NULL,
                          std::string *warn = NULL, std::string *err = NULL);
 
+/// Loads object from a buffer holding a whole .obj with custom user callback,
+/// parsing it in place like LoadObjFromBuffer. The callbacks get the same
+/// values as with LoadObjWithCallback, except that a face with a zero index
+/// fails the load with an error instead of being passed on.
+/// The buffer does not need to be null-terminated.
+bool LoadObjFromBufferWithCallback(const char *buf, size_t len,
+                                   const callback_t &callback,
+                                   void *user_data = NULL,
+                                   MaterialReader *readMatFn = NULL,
+                                   std::string *warn = NULL,
+                                   std::string *err = NULL);
+
 /// Loads object from a std::istream, uses GetMtlIStreamFn to retrieve
 /// std::istream for materials.
 /// Returns true when loading .obj become success.
@@ -381,7 +462,39 @@ bool LoadObj(attrib_t *attrib, std::vector<shape_t> *shapes,
              std::vector<material_t> *materials, std::string *warn,
              std::string *err, std::istream *inStream,
              MaterialReader *readMatFn = NULL, bool triangulate = true,
-             bool default_vcols_fallback = true);
+             bool default_vcols_fallback = true, arena_t *arena = NULL,
+             load_stats_t *stats = NULL);
+
+/// Loads object from a buffer holding a whole .obj, without copying it into
+/// lines like the std::istream overload does. The output is the same as
+/// LoadObj with a std::istream over the buffer, such as a MemoryInputStream.
+/// The buffer does not need to be null-terminated.
+/// The lines are counted before parsing, to reserve the attribute arrays.
+/// Returns true when loading .obj become success.
+/// Returns warning and error message into `err`
+bool LoadObjFromBuffer(attrib_t *attrib, std::vector<shape_t> *shapes,
+                       std::vector<material_t> *materials, std::string *warn,
+                       std::string *err, const char *buf, size_t len,
+                       MaterialReader *readMatFn = NULL,
+                       bool triangulate = true,
+                       bool default_vcols_fallback = true,
+                       arena_t *arena = NULL, load_stats_t *stats = NULL);
+
+/// Loads object from a buffer holding a whole .obj, parsing it on
+/// `num_threads` threads. The buffer is split into chunks at line boundaries
+/// and the chunks are merged in order, so the output is the same as LoadObj
+/// with a std::istream over the buffer.
+/// `num_threads` 0 uses std::thread::hardware_concurrency(). Small buffers are
+/// parsed on the calling thread.
+/// Returns true when loading .obj become success.
+/// Returns warning and error message into `err`
+bool LoadObjParallel(attrib_t *attrib, std::vector<shape_t> *shapes,
+                     std::vector<material_t> *materials, std::string *warn,
+                     std::string *err, const char *buf, size_t len,
+                     MaterialReader *readMatFn = NULL, bool triangulate = true,
+                     bool default_vcols_fallback = true,
+                     unsigned int num_threads = 0, arena_t *arena = NULL,
+                     load_stats_t *stats = NULL);
 
 /// Loads materials into std::map
 void LoadMtl(std::map<std::string, int> *material_map,
@@ -403,6 +516,7 @@ bool ParseTextureNameAndOption(std::string *texname, texture_option_t *texopt,
 #endif  // TINY_OBJ_LOADER_H_
 
 #ifdef TINYOBJLOADER_IMPLEMENTATION
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <cmath>
@@ -414,11 +528,287 @@ bool ParseTextureNameAndOption(std::string *texname, texture_option_t *texopt,
 
 #include <fstream>
 #include <sstream>
+#include <thread>
+
+// TINYOBJLOADER_FLOAT_PARSER selects how numbers are converted:
+//  - TINYOBJLOADER_FLOAT_PARSER_FAST (default) reads the digits into an
+//    integer, several at a time, and converts exactly when the mantissa and
+//    the exponent are small, which is the case for nearly all .obj values.
+//    Plain -?d+.d+ numbers take a single pass, other numbers are scanned in
+//    full and the ones that cannot be converted exactly go through
+//    std::from_chars. On Astronaut.obj it takes about 13 ns a number against
+//    17 ns for LEGACY.
+//  - TINYOBJLOADER_FLOAT_PARSER_FROM_CHARS converts every number with
+//    std::from_chars.
+//  - TINYOBJLOADER_FLOAT_PARSER_LEGACY is the original tinyobjloader parser.
+//    It accumulates the digits in a double and can be off by an ulp.
+// FAST and FROM_CHARS are correctly rounded to double. All three accept the
+// same syntax. Without floating point std::from_chars (before Visual Studio
+// 2019 16.4 or GCC 11), the numbers FAST cannot convert exactly fall back to
+// the legacy parser.
+#define TINYOBJLOADER_FLOAT_PARSER_LEGACY 0
+#define TINYOBJLOADER_FLOAT_PARSER_FROM_CHARS 1
+#define TINYOBJLOADER_FLOAT_PARSER_FAST 2
+#ifndef TINYOBJLOADER_FLOAT_PARSER
+#define TINYOBJLOADER_FLOAT_PARSER TINYOBJLOADER_FLOAT_PARSER_FAST
+#endif
+
+#if TINYOBJLOADER_FLOAT_PARSER != TINYOBJLOADER_FLOAT_PARSER_LEGACY
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+#if defined(__cpp_lib_to_chars)
+#include <charconv>
+#define TINYOBJLOADER_HAS_FROM_CHARS
+#endif
+#endif
+
+// SIMD is used to find line ends in LoadObjFromBuffer and LoadObjParallel.
+// Define TINYOBJLOADER_NO_SIMD (or SIMD_DISABLE) to use the scalar code only.
+#if !defined(TINYOBJLOADER_NO_SIMD) && !defined(SIMD_DISABLE)
+#if defined(_M_X64) || defined(__x86_64__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define TINYOBJLOADER_USE_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define TINYOBJLOADER_USE_NEON
+#if defined(_MSC_VER)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+#endif
 
 namespace tinyobj {
 
 MaterialReader::~MaterialReader() {}
 
+arena_t::arena_t(size_t block_size)
+    : blocks_(NULL),
+      cur_(NULL),
+      end_(NULL),
+      block_size_(block_size),
+      allocation_count_(0),
+      block_count_(0),
+      block_bytes_(0) {}
+
+arena_t::~arena_t() { release(); }
+
+void *arena_t::allocate(size_t size, size_t alignment) {
+  allocation_count_++;
+
+  size_t pad = (alignment - reinterpret_cast<size_t>(cur_) % alignment) %
+               alignment;
+  if (cur_ == NULL || size + pad > static_cast<size_t>(end_ - cur_)) {
+    // Large allocations get a block of their own
+    const size_t header = (sizeof(block) + alignment - 1) / alignment * alignment;
+    size_t bytes = header + (size > block_size_ / 4 ? size : block_size_);
+    block *b = static_cast<block *>(::operator new(bytes));
+    b->next = blocks_;
+    blocks_ = b;
+    block_count_++;
+    block_bytes_ += bytes;
+
+    char *data = reinterpret_cast<char *>(b) + header;
+    if (size > block_size_ / 4) {
+      return data;  // the current block still has room for small ones
+    }
+    cur_ = data;
+    end_ = reinterpret_cast<char *>(b) + bytes;
+    pad = 0;
+  }
+
+  char *p = cur_ + pad;
+  cur_ = p + size;
+  return p;
+}
+
+void arena_t::release() {
+  while (blocks_) {
+    block *next = blocks_->next;
+    ::operator delete(blocks_);
+    blocks_ = next;
+  }
+  cur_ = end_ = NULL;
+}
+
+// std::allocator for containers with storage in an arena_t, or on the heap if
+// the arena is NULL. Nothing is freed in the arena, arena_t::release does.
+template <typename T>
+struct arena_allocator {
+  typedef T value_type;
+
+  arena_t *arena;
+
+  explicit arena_allocator(arena_t *a = NULL) : arena(a) {}
+  template <typename U>
+  arena_allocator(const arena_allocator<U> &other) : arena(other.arena) {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(arena ? arena->allocate(n * sizeof(T), alignof(T))
+                                  : ::operator new(n * sizeof(T)));
+  }
+  void deallocate(T *p, size_t) {
+    if (!arena) {
+      ::operator delete(p);
+    }
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const arena_allocator<T> &a, const arena_allocator<U> &b) {
+  return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+bool operator!=(const arena_allocator<T> &a, const arena_allocator<U> &b) {
+  return a.arena != b.arena;
+}
+
+// Interned names: an open addressing hash table giving every distinct name a
+// stable id, its index in insertion order. Names are looked up by pointer and
+// length, right in the line they are read from, and are only copied into the
+// table when they are new. name() is null-terminated.
+class name_table_t {
+ public:
+  name_table_t() {}
+
+  // Id of the name, or -1 if it is not in the table.
+  int find(const char *name, size_t length) const {
+    if (entries_.empty()) {
+      return -1;
+    }
+    unsigned int hash = hashName(name, length);
+    size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      int id = slots_[i] - 1;
+      if (id < 0) {
+        return -1;
+      }
+      const entry &e = entries_[static_cast<size_t>(id)];
+      if (e.hash == hash && e.length == length &&
+          memcmp(&chars_[e.offset], name, length) == 0) {
+        return id;
+      }
+    }
+  }
+
+  // Id of the name, added if it is new.
+  int intern(const char *name, size_t length) {
+    int id = find(name, length);
+    if (id >= 0) {
+      return id;
+    }
+
+    // At most half full
+    if (2 * (entries_.size() + 1) > slots_.size()) {
+      rehash(slots_.empty() ? 16 : 2 * slots_.size());
+    }
+
+    entry e;
+    e.offset = chars_.size();
+    e.length = length;
+    e.hash = hashName(name, length);
+    chars_.insert(chars_.end(), name, name + length);
+    chars_.push_back('\0');
+    id = static_cast<int>(entries_.size());
+    entries_.push_back(e);
+    insertSlot(e.hash, id);
+    return id;
+  }
+
+  // Pointers from name() stay valid until the next intern() or clear().
+  const char *name(int id) const {
+    return &chars_[entries_[static_cast<size_t>(id)].offset];
+  }
+  size_t length(int id) const {
+    return entries_[static_cast<size_t>(id)].length;
+  }
+  size_t size() const { return entries_.size(); }
+
+  void clear() {
+    slots_.clear();
+    entries_.clear();
+    chars_.clear();
+  }
+
+ private:
+  struct entry {
+    size_t offset;  // in chars_
+    size_t length;
+    unsigned int hash;
+  };
+
+  // FNV-1a
+  static unsigned int hashName(const char *name, size_t length) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+      hash = (hash ^ static_cast<unsigned char>(name[i])) * 16777619u;
+    }
+    return hash;
+  }
+
+  void insertSlot(unsigned int hash, int id) {
+    size_t mask = slots_.size() - 1;
+    size_t i = hash & mask;
+    while (slots_[i] != 0) {
+      i = (i + 1) & mask;
+    }
+    slots_[i] = id + 1;
+  }
+
+  void rehash(size_t num_slots) {
+    slots_.assign(num_slots, 0);
+    for (size_t i = 0; i < entries_.size(); i++) {
+      insertSlot(entries_[i].hash, static_cast<int>(i));
+    }
+  }
+
+  std::vector<int> slots_;  // id + 1, 0 for a free slot
+  std::vector<entry> entries_;
+  std::vector<char> chars_;
+};
+
+// Material ids by name, looked up without building a std::string. Mirrors
+// the std::map the MaterialReader fills, call update() after it ran.
+struct material_name_table {
+  name_table_t names;
+  std::vector<int> material_ids;  // by name id
+
+  void update(const std::map<std::string, int> &material_map) {
+    names.clear();
+    material_ids.clear();
+    for (std::map<std::string, int>::const_iterator it = material_map.begin();
+         it != material_map.end(); ++it) {
+      names.intern(it->first.data(), it->first.size());
+      material_ids.push_back(it->second);
+    }
+  }
+
+  // Material id of the name, -1 if there is no such material.
+  int find(const char *name, size_t length) const {
+    int id = names.find(name, length);
+    return id < 0 ? -1 : material_ids[static_cast<size_t>(id)];
+  }
+};
+
+// Makes room for `n` more elements in `a`, at least doubling it when it has
+// to grow, and counts the growth in `stats`.
+template <typename T>
+static inline void reserveFor(std::vector<T> *a, size_t n,
+                              load_stats_t *stats) {
+  if (a->size() + n > a->capacity()) {
+    a->reserve((std::max)(a->size() + n, 2 * a->capacity()));
+    stats->reallocations++;
+  }
+}
+
 struct vertex_index_t {
   int v_idx, vt_idx, vn_idx;
   vertex_index_t() : v_idx(-1), vt_idx(-1), vn_idx(-1) {}
@@ -433,11 +823,17 @@ struct face_t {
   unsigned int
       smoothing_group_id;  // smoothing group id. 0 = smoothing groupd is off.
   int pad_;
-  std::vector<vertex_index_t> vertex_indices;  // face vertex indices.
+  // face vertex indices.
+  std::vector<vertex_index_t, arena_allocator<vertex_index_t> > vertex_indices;
 
-  face_t() : smoothing_group_id(0), pad_(0) {}
+  explicit face_t(arena_t *arena = NULL)
+      : smoothing_group_id(0),
+        pad_(0),
+        vertex_indices(arena_allocator<vertex_index_t>(arena)) {}
 };
 
+typedef std::vector<face_t, arena_allocator<face_t> > face_group_t;
+
 struct line_t {
   int idx0;
   int idx1;
@@ -530,6 +926,17 @@ static inline std::string parseString(const char **token) {
   return s;
 }
 
+// Like parseString, but returns the token in place, with its length in
+// `length`.
+static inline const char *parseStringInPlace(const char **token,
+                                             size_t *length) {
+  (*token) += strspn((*token), " \t");
+  const char *s = (*token);
+  (*length) = strcspn((*token), " \t\r");
+  (*token) += (*length);
+  return s;
+}
+
 static inline int parseInt(const char **token) {
   (*token) += strspn((*token), " \t");
   int i = atoi((*token));
@@ -537,6 +944,23 @@ static inline int parseInt(const char **token) {
   return i;
 }
 
+// Parses the smoothing group of an 's' line, `token` points past "s ". Returns
+// false for a line without one. "off", a negative or a non-numeric id is 0,
+// smoothing off.
+static bool parseSmoothingGroupId(const char *token, unsigned int *id) {
+  token += strspn(token, " \t");
+  if (token[0] == '\0' || token[0] == '\r' || token[0] == '\n') {
+    return false;
+  }
+  if (0 == strncmp(token, "off", 3)) {
+    (*id) = 0;
+    return true;
+  }
+  int smGroupId = parseInt(&token);
+  (*id) = smGroupId < 0 ? 0 : static_cast<unsigned int>(smGroupId);
+  return true;
+}
+
 // Tries to parse a floating point number located at s.
 //
 // s_end should be a location in the string where reading should absolutely
@@ -564,7 +988,8 @@ static inline int parseInt(const char **token) {
 //  - s >= s_end.
 //  - parse failure.
 //
-static bool tryParseDouble(const char *s, const char *s_end, double *result) {
+static bool tryParseDoubleLegacy(const char *s, const char *s_end,
+                                 double *result) {
   if (s >= s_end) {
     return false;
   }
@@ -679,6 +1104,304 @@ fail:
   return false;
 }
 
+#if TINYOBJLOADER_FLOAT_PARSER != TINYOBJLOADER_FLOAT_PARSER_LEGACY
+
+// Reading digits eight and four at a time from a little endian integer, see
+// "Number Parsing at a Gigabyte per Second", D. Lemire, 2021.
+// The loads stay within [s, s_end), so they never read past the end of the
+// line.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define TINYOBJLOADER_NO_SWAR_DIGITS
+#endif
+
+// The digit loops only stay fast when inlined into parseDoublePrefix
+#if defined(_MSC_VER)
+#define TINYOBJLOADER_FORCEINLINE __forceinline
+#else
+#define TINYOBJLOADER_FORCEINLINE inline __attribute__((always_inline))
+#endif
+
+static inline bool isEightDigits(unsigned long long val) {
+  return !(((val + 0x4646464646464646ULL) | (val - 0x3030303030303030ULL)) &
+           0x8080808080808080ULL);
+}
+
+static inline unsigned int parseEightDigits(unsigned long long val) {
+  const unsigned long long mask = 0x000000FF000000FFULL;
+  const unsigned long long mul1 = 0x000F424000000064ULL;  // 100 + (1000000 << 32)
+  const unsigned long long mul2 = 0x0000271000000001ULL;  // 1 + (10000 << 32)
+  val -= 0x3030303030303030ULL;
+  val = (val * 10) + (val >> 8);
+  val = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
+  return static_cast<unsigned int>(val);
+}
+
+static inline bool isFourDigits(unsigned int val) {
+  return !(((val + 0x46464646u) | (val - 0x30303030u)) & 0x80808080u);
+}
+
+static inline unsigned int parseFourDigits(unsigned int val) {
+  val -= 0x30303030u;
+  val = (val * 10) + (val >> 8);
+  return (val & 0xFF) * 100 + ((val >> 16) & 0xFF);
+}
+
+// A number read by scanDecimal: the value is mantissa * 10^exp10, exactly if
+// `exact` is true. Otherwise there were more than 19 significant digits or a
+// huge exponent, and only the syntax was checked.
+struct decimal_t {
+  bool negative;
+  bool exact;
+  unsigned long long mantissa;
+  int exp10;
+};
+
+// Appends the digits in [*curr, s_end) to `d`, and returns how many there were.
+// Only the first 19 significant digits go into the mantissa, exp10 is adjusted
+// for the digits after the decimal point and the integer digits dropped.
+static TINYOBJLOADER_FORCEINLINE int scanDigits(const char **curr,
+                                                const char *s_end,
+                                                bool fraction,
+                                                int *significant,
+                                                decimal_t *d) {
+  const char *start = *curr;
+  const char *p = *curr;
+  int accumulated = 0;
+#if !defined(TINYOBJLOADER_NO_SWAR_DIGITS)
+  while (s_end - p >= 8 && (*significant) + 8 <= 19) {
+    unsigned long long chunk;
+    memcpy(&chunk, p, 8);
+    if (!isEightDigits(chunk)) {
+      break;
+    }
+    d->mantissa = d->mantissa * 100000000ULL + parseEightDigits(chunk);
+    (*significant) += 8;
+    accumulated += 8;
+    p += 8;
+  }
+  if (s_end - p >= 4 && (*significant) + 4 <= 19) {
+    unsigned int chunk;
+    memcpy(&chunk, p, 4);
+    if (isFourDigits(chunk)) {
+      d->mantissa = d->mantissa * 10000ULL + parseFourDigits(chunk);
+      (*significant) += 4;
+      accumulated += 4;
+      p += 4;
+    }
+  }
+#endif
+  while (p != s_end && IS_DIGIT(*p)) {
+    if ((*significant) < 19) {
+      d->mantissa = d->mantissa * 10 + static_cast<unsigned int>(*p - '0');
+      (*significant)++;
+      accumulated++;
+    } else {
+      d->exact = false;
+      if (!fraction && d->exp10 < 100000) {
+        d->exp10++;
+      }
+    }
+    p++;
+  }
+  if (fraction) {
+    d->exp10 -= accumulated;
+  }
+  *curr = p;
+  return static_cast<int>(p - start);
+}
+
+// Reads the number at s with the syntax of tryParseDoubleLegacy, and returns
+// the position after it, or NULL if there is no number.
+// Leading zeros count as significant digits, which only sends a few more
+// numbers to the slow path.
+static TINYOBJLOADER_FORCEINLINE const char *scanDecimal(const char *s,
+                                                         const char *s_end,
+                                                         decimal_t *d) {
+  d->negative = false;
+  d->exact = true;
+  d->mantissa = 0;
+  d->exp10 = 0;
+
+  const char *curr = s;
+  int significant = 0;
+
+  if (curr == s_end) {
+    return NULL;
+  }
+  if (*curr == '+' || *curr == '-') {
+    d->negative = (*curr == '-');
+    curr++;
+  }
+
+  // Integer part, at least one digit
+  if (scanDigits(&curr, s_end, false, &significant, d) == 0) {
+    return NULL;
+  }
+  if (curr == s_end) {
+    return curr;
+  }
+
+  // Decimal part
+  if (*curr == '.') {
+    curr++;
+    scanDigits(&curr, s_end, true, &significant, d);
+    if (curr == s_end) {
+      return curr;
+    }
+  }
+
+  // Exponent part, at least one digit
+  if (*curr != 'e' && *curr != 'E') {
+    return curr;
+  }
+  curr++;
+  bool exp_negative = false;
+  if (curr != s_end && (*curr == '+' || *curr == '-')) {
+    exp_negative = (*curr == '-');
+    curr++;
+  }
+  const char *exp_start = curr;
+  int exponent = 0;
+  while (curr != s_end && IS_DIGIT(*curr)) {
+    if (exponent < 100000) {
+      exponent = exponent * 10 + static_cast<int>(*curr - '0');
+    } else {
+      d->exact = false;
+    }
+    curr++;
+  }
+  if (curr == exp_start) {
+    return NULL;
+  }
+  d->exp10 += exp_negative ? -exponent : exponent;
+  return curr;
+}
+
+// Correctly rounded conversion of the number in [s, end), which scanDecimal
+// accepted into `d`.
+static bool convertDecimalSlow(const char *s, const char *end,
+                               const decimal_t &d, double *result) {
+#if defined(TINYOBJLOADER_HAS_FROM_CHARS)
+  // from_chars does not take a '+'
+  const char *first = (*s == '+') ? s + 1 : s;
+  double value;
+  std::from_chars_result r =
+      std::from_chars(first, end, value, std::chars_format::general);
+  if (r.ec == std::errc() && r.ptr == end) {
+    *result = value;
+    return true;
+  }
+  if (r.ec == std::errc::result_out_of_range) {
+    // Overflow to infinity or underflow to zero, the mantissa is never zero
+    value = d.exp10 > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+    *result = d.negative ? -value : value;
+    return true;
+  }
+#else
+  (void)d;
+#endif
+  return tryParseDoubleLegacy(s, end, result);
+}
+
+#if TINYOBJLOADER_FLOAT_PARSER == TINYOBJLOADER_FLOAT_PARSER_FAST
+static const double kExactPowersOf10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+#endif
+
+// Parses the number at s and returns the position after it, or NULL if there
+// is no number. Like tryParseDoubleLegacy, characters after the number are
+// ignored, so the caller does not have to find the end of the token first.
+static TINYOBJLOADER_FORCEINLINE const char *parseDoublePrefix(
+    const char *s, const char *s_end, double *result) {
+#if TINYOBJLOADER_FLOAT_PARSER == TINYOBJLOADER_FLOAT_PARSER_FAST
+  // Nearly every number in an OBJ file is -?d+.d+ with a few digits. Those are
+  // read here in a single pass and converted with Clinger's fast path below,
+  // scanDecimal takes the others.
+  {
+    const char *p = s;
+    const bool negative = (p != s_end && *p == '-');
+    p += negative ? 1 : 0;
+    const char *int_start = p;
+    unsigned long long mantissa = 0;
+    while (p != s_end && IS_DIGIT(*p)) {
+      mantissa = mantissa * 10 + static_cast<unsigned int>(*p - '0');
+      p++;
+    }
+    const long int_digits = static_cast<long>(p - int_start);
+    if (int_digits > 0 && p != s_end && *p == '.') {
+      p++;
+      const char *frac_start = p;
+#if !defined(TINYOBJLOADER_NO_SWAR_DIGITS)
+      // Exported models often write 15 to 17 digits
+      while (s_end - p >= 8) {
+        unsigned long long chunk;
+        memcpy(&chunk, p, 8);
+        if (!isEightDigits(chunk)) {
+          break;
+        }
+        mantissa = mantissa * 100000000ULL + parseEightDigits(chunk);
+        p += 8;
+      }
+#endif
+      while (p != s_end && IS_DIGIT(*p)) {
+        mantissa = mantissa * 10 + static_cast<unsigned int>(*p - '0');
+        p++;
+      }
+      // More digits may have wrapped the mantissa around, and an exponent
+      // needs scanDecimal
+      const long frac_digits = static_cast<long>(p - frac_start);
+      if (int_digits + frac_digits <= 19 &&
+          (p == s_end || (*p != 'e' && *p != 'E'))) {
+        if (mantissa <= (1ULL << 53) && frac_digits <= 22) {
+          double value = static_cast<double>(mantissa) /
+                         kExactPowersOf10[frac_digits];
+          *result = negative ? -value : value;
+          return p;
+        }
+        // Exact but too many digits for the fast path, no need to scan again
+        decimal_t d = {negative, true, mantissa, -static_cast<int>(frac_digits)};
+        return convertDecimalSlow(s, p, d, result) ? p : NULL;
+      }
+    }
+  }
+#endif
+  decimal_t d;
+  const char *end = scanDecimal(s, s_end, &d);
+  if (!end) {
+    return NULL;
+  }
+#if TINYOBJLOADER_FLOAT_PARSER == TINYOBJLOADER_FLOAT_PARSER_FAST
+  // Both operands are exact doubles, so the one rounding of the multiply or
+  // divide gives the correctly rounded result (Clinger's fast path).
+  if (d.exact && d.mantissa <= (1ULL << 53) && d.exp10 >= -22 &&
+      d.exp10 <= 22) {
+    double value = static_cast<double>(d.mantissa);
+    if (d.exp10 < 0) {
+      value /= kExactPowersOf10[-d.exp10];
+    } else {
+      value *= kExactPowersOf10[d.exp10];
+    }
+    *result = d.negative ? -value : value;
+    return end;
+  }
+#endif
+  return convertDecimalSlow(s, end, d, result) ? end : NULL;
+}
+
+#endif  // TINYOBJLOADER_FLOAT_PARSER != TINYOBJLOADER_FLOAT_PARSER_LEGACY
+
+// Parses the number at s, see tryParseDoubleLegacy for the syntax and
+// TINYOBJLOADER_FLOAT_PARSER for how it is converted.
+static inline bool tryParseDouble(const char *s, const char *s_end,
+                                  double *result) {
+#if TINYOBJLOADER_FLOAT_PARSER == TINYOBJLOADER_FLOAT_PARSER_LEGACY
+  return tryParseDoubleLegacy(s, s_end, result);
+#else
+  return parseDoublePrefix(s, s_end, result) != NULL;
+#endif
+}
+
 static inline real_t parseReal(const char **token, double default_value = 0.0) {
   (*token) += strspn((*token), " \t");
   const char *end = (*token) + strcspn((*token), " \t\r");
@@ -1078,17 +1801,35 @@ static int pnpoly(int nvert, T *vertx, T *verty, T testx, T testy) {
 
 // TODO(syoyo): refactor function.
 static bool exportGroupsToShape(shape_t *shape,
-                                const std::vector<face_t> &faceGroup,
+                                const face_group_t &faceGroup,
                                 std::vector<int> &lineGroup,
                                 const std::vector<tag_t> &tags,
-                                const int material_id, const std::string &name,
-                                bool triangulate,
-                                const std::vector<real_t> &v) {
+                                const int material_id, const char *name,
+                                size_t name_length, bool triangulate,
+                                const std::vector<real_t> &v,
+                                load_stats_t *stats) {
   if (faceGroup.empty() && lineGroup.empty()) {
     return false;
   }
 
   if (!faceGroup.empty()) {
+    // Reserve for the whole group. A shape collects several groups when only
+    // the material changes.
+    size_t num_faces = 0;
+    size_t num_indices = 0;
+    for (size_t i = 0; i < faceGroup.size(); i++) {
+      size_t npolys = faceGroup[i].vertex_indices.size();
+      if (npolys < 3) {
+        continue;
+      }
+      num_faces += triangulate ? npolys - 2 : 1;
+      num_indices += triangulate ? 3 * (npolys - 2) : npolys;
+    }
+    reserveFor(&shape->mesh.indices, num_indices, stats);
+    reserveFor(&shape->mesh.num_face_vertices, num_faces, stats);
+    reserveFor(&shape->mesh.material_ids, num_faces, stats);
+    reserveFor(&shape->mesh.smoothing_group_ids, num_faces, stats);
+
     // Flatten vertices and indices
     for (size_t i = 0; i < faceGroup.size(); i++) {
       const face_t &face = faceGroup[i];
@@ -1327,8 +2068,9 @@ static bool exportGroupsToShape(shape_t *shape,
       }
     }
 
-    shape->name = name;
+    shape->name.assign(name, name_length);
     shape->mesh.tags = tags;
+    stats->bytes_copied += name_length + tags.size() * sizeof(tag_t);
   }
 
   if (!lineGroup.empty()) {
@@ -1777,7 +2519,8 @@ bool MaterialStreamReader::operator()(const std::string &matId,
 bool LoadObj(attrib_t *attrib, std::vector<shape_t> *shapes,
              std::vector<material_t> *materials, std::string *warn,
              std::string *err, const char *filename, const char *mtl_basedir,
-             bool trianglulate, bool default_vcols_fallback) {
+             bool trianglulate, bool default_vcols_fallback, arena_t *arena,
+             load_stats_t *stats) {
   attrib->vertices.clear();
   attrib->normals.clear();
   attrib->texcoords.clear();
@@ -1807,156 +2550,515 @@ bool LoadObj(attrib_t *attrib, std::vector<shape_t> *shapes,
   MaterialFileReader matFileReader(baseDir);
 
   return LoadObj(attrib, shapes, materials, warn, err, &ifs, &matFileReader,
-                 trianglulate, default_vcols_fallback);
+                 trianglulate, default_vcols_fallback, arena, stats);
 }
 
-bool LoadObj(attrib_t *attrib, std::vector<shape_t> *shapes,
-             std::vector<material_t> *materials, std::string *warn,
-             std::string *err, std::istream *inStream,
-             MaterialReader *readMatFn /*= NULL*/, bool triangulate,
-             bool default_vcols_fallback) {
-  std::stringstream errss;
-
+// Parser state carried from one line of an .obj to the next.
+// LoadObj and LoadObjParallel run every command through it, so both build the
+// same attrib_t and shape_t.
+struct obj_parse_state {
   std::vector<real_t> v;
   std::vector<real_t> vn;
   std::vector<real_t> vt;
   std::vector<real_t> vc;
   std::vector<tag_t> tags;
-  std::vector<face_t> faceGroup;
+  face_group_t faceGroup;  // in `arena`
   std::vector<int> lineGroup;
-  std::string name;
+  name_table_t names;  // group and object names
+  int name_id;         // -1 for no name
+  std::string name_buf;  // joins the names of a 'g' line, keeps its capacity
 
   // material
-  std::map<std::string, int> material_map;
-  int material = -1;
+  std::map<std::string, int> material_map;  // filled by MaterialReader
+  material_name_table material_names;       // looked up by usemtl
+  int material;
 
   // smoothing group id
-  unsigned int current_smoothing_id =
-      0;  // Initial value. 0 means no smoothing.
+  unsigned int current_smoothing_id;  // 0 means no smoothing.
 
-  int greatest_v_idx = -1;
-  int greatest_vn_idx = -1;
-  int greatest_vt_idx = -1;
+  int greatest_v_idx;
+  int greatest_vn_idx;
+  int greatest_vt_idx;
 
   shape_t shape;
 
-  bool found_all_colors = true;
+  bool found_all_colors;
+
+  arena_t *arena;
+  load_stats_t stats;  // the arena counters are set by finishObj
+  size_t arena_allocations_start;
+  size_t arena_blocks_start;
+
+  explicit obj_parse_state(arena_t *arena_)
+      : faceGroup(arena_allocator<face_t>(arena_)),
+        name_id(-1),
+        material(-1),
+        current_smoothing_id(0),
+        greatest_v_idx(-1),
+        greatest_vn_idx(-1),
+        greatest_vt_idx(-1),
+        found_all_colors(true),
+        arena(arena_),
+        arena_allocations_start(arena_->allocation_count()),
+        arena_blocks_start(arena_->block_count()) {}
+};
 
-  size_t line_num = 0;
-  std::string linebuf;
-  while (inStream->peek() != -1) {
-    safeGetline(*inStream, linebuf);
+// Name of the current group or object.
+static inline const char *getStateName(const obj_parse_state &state) {
+  return state.name_id < 0 ? "" : state.names.name(state.name_id);
+}
+static inline size_t getStateNameLength(const obj_parse_state &state) {
+  return state.name_id < 0 ? 0 : state.names.length(state.name_id);
+}
 
-    line_num++;
+// Bytes of the arrays of a shape.
+static size_t getShapeBytes(const shape_t &shape) {
+  return shape.mesh.indices.size() * sizeof(index_t) +
+         shape.mesh.num_face_vertices.size() * sizeof(unsigned char) +
+         shape.mesh.material_ids.size() * sizeof(int) +
+         shape.mesh.smoothing_group_ids.size() * sizeof(unsigned int) +
+         shape.mesh.tags.size() * sizeof(tag_t) +
+         shape.path.indices.size() * sizeof(int);
+}
 
-    // Trim newline '\r\n' or '\n'
-    if (linebuf.size() > 0) {
-      if (linebuf[linebuf.size() - 1] == '\n')
-        linebuf.erase(linebuf.size() - 1);
-    }
-    if (linebuf.size() > 0) {
-      if (linebuf[linebuf.size() - 1] == '\r')
-        linebuf.erase(linebuf.size() - 1);
-    }
+// Moves the current shape to the end of `shapes` and starts a new one.
+static void flushShape(obj_parse_state *state, std::vector<shape_t> *shapes) {
+  state->stats.shape_count++;
+  state->stats.shape_bytes_moved += getShapeBytes(state->shape);
+  shapes->push_back(std::move(state->shape));
+  state->shape = shape_t();
+}
 
-    // Skip if empty line.
-    if (linebuf.empty()) {
-      continue;
+// Appends the values of a 'v', 'vn' or 'vt' line to an attribute array.
+static inline void pushReals(std::vector<real_t> *a, real_t x, real_t y,
+                             real_t z, size_t n, load_stats_t *stats) {
+  reserveFor(a, n, stats);
+  a->push_back(x);
+  a->push_back(y);
+  if (n == 3) {
+    a->push_back(z);
+  }
+}
+
+static inline void updateGreatestIndices(obj_parse_state *state,
+                                         const vertex_index_t &vi) {
+  state->greatest_v_idx =
+      state->greatest_v_idx > vi.v_idx ? state->greatest_v_idx : vi.v_idx;
+  state->greatest_vn_idx =
+      state->greatest_vn_idx > vi.vn_idx ? state->greatest_vn_idx : vi.vn_idx;
+  state->greatest_vt_idx =
+      state->greatest_vt_idx > vi.vt_idx ? state->greatest_vt_idx : vi.vt_idx;
+}
+
+// Handles the commands other than 'v', 'vn', 'vt' and 'f'.
+// `token` points at the command, after any leading space.
+static void parseObjCommand(obj_parse_state *state, const char *token,
+                            size_t line_num, std::vector<shape_t> *shapes,
+                            std::vector<material_t> *materials,
+                            MaterialReader *readMatFn, bool triangulate,
+                            std::string *warn, std::string *err) {
+  // line
+  if (token[0] == 'l' && IS_SPACE((token[1]))) {
+    token += 2;
+
+    line_t line_cache;
+    bool end_line_bit = 0;
+    while (!IS_NEW_LINE(token[0])) {
+      // get index from string
+      int idx;
+      fixIndex(parseInt(&token), 0, &idx);
+
+      size_t n = strspn(token, " \t\r");
+      token += n;
+
+      if (!end_line_bit) {
+        line_cache.idx0 = idx;
+      } else {
+        line_cache.idx1 = idx;
+        state->lineGroup.push_back(line_cache.idx0);
+        state->lineGroup.push_back(line_cache.idx1);
+        line_cache = line_t();
+      }
+      end_line_bit = !end_line_bit;
     }
 
-    // Skip leading space.
-    const char *token = linebuf.c_str();
-    token += strspn(token, " \t");
+    return;
+  }
 
-    assert(token);
-    if (token[0] == '\0') continue;  // empty line
+  // use mtl
+  if ((0 == strncmp(token, "usemtl", 6)) && IS_SPACE((token[6]))) {
+    token += 7;
+
+    // The name is the rest of the line, -1 if there is no such material
+    int newMaterialId = state->material_names.find(token, strlen(token));
+
+    if (newMaterialId != state->material) {
+      // Create per-face material. Thus we don't add `shape` to `shapes` at
+      // this time.
+      // just clear `faceGroup` after `exportGroupsToShape()` call.
+      exportGroupsToShape(&state->shape, state->faceGroup, state->lineGroup,
+                          state->tags, state->material, getStateName(*state),
+                          getStateNameLength(*state), triangulate, state->v,
+                          &state->stats);
+      state->faceGroup.clear();
+      state->material = newMaterialId;
+    }
 
-    if (token[0] == '#') continue;  // comment line
+    return;
+  }
 
-    // vertex
-    if (token[0] == 'v' && IS_SPACE((token[1]))) {
-      token += 2;
-      real_t x, y, z;
-      real_t r, g, b;
+  // load mtl
+  if ((0 == strncmp(token, "mtllib", 6)) && IS_SPACE((token[6]))) {
+    if (readMatFn) {
+      token += 7;
 
-      found_all_colors &= parseVertexWithColor(&x, &y, &z, &r, &g, &b, &token);
+      std::vector<std::string> filenames;
+      SplitString(std::string(token), ' ', filenames);
 
-      v.push_back(x);
-      v.push_back(y);
-      v.push_back(z);
+      if (filenames.empty()) {
+        if (warn) {
+          std::stringstream ss;
+          ss << "Looks like empty filename for mtllib. Use default "
+                "material (line "
+             << line_num << ".)\n";
 
-      if (found_all_colors || default_vcols_fallback) {
-        vc.push_back(r);
-        vc.push_back(g);
-        vc.push_back(b);
-      }
+          (*warn) += ss.str();
+        }
+      } else {
+        bool found = false;
+        for (size_t s = 0; s < filenames.size(); s++) {
+          std::string warn_mtl;
+          std::string err_mtl;
+          bool ok = (*readMatFn)(filenames[s].c_str(), materials,
+                                 &state->material_map, &warn_mtl, &err_mtl);
+          state->material_names.update(state->material_map);
+          if (warn && (!warn_mtl.empty())) {
+            (*warn) += warn_mtl;
+          }
 
-      continue;
-    }
+          if (err && (!err_mtl.empty())) {
+            (*err) += err_mtl;
+          }
 
-    // normal
-    if (token[0] == 'v' && token[1] == 'n' && IS_SPACE((token[2]))) {
-      token += 3;
-      real_t x, y, z;
-      parseReal3(&x, &y, &z, &token);
-      vn.push_back(x);
-      vn.push_back(y);
-      vn.push_back(z);
-      continue;
+          if (ok) {
+            found = true;
+            break;
+          }
+        }
+
+        if (!found) {
+          if (warn) {
+            (*warn) +=
+                "Failed to load material file(s). Use default "
+                "material.\n";
+          }
+        }
+      }
     }
 
-    // texcoord
-    if (token[0] == 'v' && token[1] == 't' && IS_SPACE((token[2]))) {
-      token += 3;
-      real_t x, y;
-      parseReal2(&x, &y, &token);
-      vt.push_back(x);
-      vt.push_back(y);
+    return;
+  }
+
+  // group name
+  if (token[0] == 'g' && IS_SPACE((token[1]))) {
+    // flush previous face group.
+    bool ret = exportGroupsToShape(&state->shape, state->faceGroup,
+                                   state->lineGroup, state->tags,
+                                   state->material, getStateName(*state),
+                                   getStateNameLength(*state), triangulate,
+                                   state->v, &state->stats);
+    (void)ret;  // return value not used.
+
+    if (state->shape.mesh.indices.size() > 0) {
+      flushShape(state, shapes);
+    } else {
+      state->shape = shape_t();
+    }
+
+    // material = -1;
+    state->faceGroup.clear();
+
+    // tinyobjloader does not support multiple groups for a primitive.
+    // Currently we concatinate multiple group names with a space to get
+    // single group name.
+    size_t num_names = 0;
+    state->name_buf.clear();
+    while (!IS_NEW_LINE(token[0])) {
+      size_t length;
+      const char *name = parseStringInPlace(&token, &length);
+      // The first one is 'g'
+      if (num_names > 1) {
+        state->name_buf += ' ';
+      }
+      if (num_names > 0) {
+        state->name_buf.append(name, length);
+      }
+      num_names++;
+      token += strspn(token, " \t\r");  // skip tag
+    }
+
+    if (num_names < 2) {
+      // 'g' with empty names
+      if (warn) {
+        std::stringstream ss;
+        ss << "Empty group name. line: " << line_num << "\n";
+        (*warn) += ss.str();
+        state->name_id = -1;
+      }
+    } else {
+      state->name_id =
+          state->names.intern(state->name_buf.data(), state->name_buf.size());
+    }
+
+    return;
+  }
+
+  // object name
+  if (token[0] == 'o' && IS_SPACE((token[1]))) {
+    // flush previous face group.
+    bool ret = exportGroupsToShape(&state->shape, state->faceGroup,
+                                   state->lineGroup, state->tags,
+                                   state->material, getStateName(*state),
+                                   getStateNameLength(*state), triangulate,
+                                   state->v, &state->stats);
+    if (ret) {
+      flushShape(state, shapes);
+    } else {
+      state->shape = shape_t();
+    }
+
+    // material = -1;
+    state->faceGroup.clear();
+
+    // @todo { multiple object name? }
+    token += 2;
+    state->name_id = state->names.intern(token, strlen(token));
+
+    return;
+  }
+
+  if (token[0] == 't' && IS_SPACE(token[1])) {
+    const int max_tag_nums = 8192;  // FIXME(syoyo): Parameterize.
+    tag_t tag;
+
+    token += 2;
+
+    tag.name = parseString(&token);
+
+    tag_sizes ts = parseTagTriple(&token);
+
+    if (ts.num_ints < 0) {
+      ts.num_ints = 0;
+    }
+    if (ts.num_ints > max_tag_nums) {
+      ts.num_ints = max_tag_nums;
+    }
+
+    if (ts.num_reals < 0) {
+      ts.num_reals = 0;
+    }
+    if (ts.num_reals > max_tag_nums) {
+      ts.num_reals = max_tag_nums;
+    }
+
+    if (ts.num_strings < 0) {
+      ts.num_strings = 0;
+    }
+    if (ts.num_strings > max_tag_nums) {
+      ts.num_strings = max_tag_nums;
+    }
+
+    tag.intValues.resize(static_cast<size_t>(ts.num_ints));
+
+    for (size_t i = 0; i < static_cast<size_t>(ts.num_ints); ++i) {
+      tag.intValues[i] = parseInt(&token);
+    }
+
+    tag.floatValues.resize(static_cast<size_t>(ts.num_reals));
+    for (size_t i = 0; i < static_cast<size_t>(ts.num_reals); ++i) {
+      tag.floatValues[i] = parseReal(&token);
+    }
+
+    tag.stringValues.resize(static_cast<size_t>(ts.num_strings));
+    for (size_t i = 0; i < static_cast<size_t>(ts.num_strings); ++i) {
+      tag.stringValues[i] = parseString(&token);
+    }
+
+    state->tags.push_back(tag);
+
+    return;
+  }
+
+  if (token[0] == 's' && IS_SPACE(token[1])) {
+    // smoothing group id
+    token += 2;
+
+    // Shared with the callback loaders, which report the same ids
+    parseSmoothingGroupId(token, &state->current_smoothing_id);
+
+    return;
+  }  // smoothing group id
+
+  // Ignore unknown command.
+}
+
+// Flushes the last group and moves the parsed data to `attrib`.
+// `line_num` is the number of lines in the .obj.
+static void finishObj(obj_parse_state *state, size_t line_num,
+                      attrib_t *attrib, std::vector<shape_t> *shapes,
+                      bool triangulate, bool default_vcols_fallback,
+                      std::string *warn, load_stats_t *stats) {
+  // not all vertices have colors, no default colors desired? -> clear colors
+  if (!state->found_all_colors && !default_vcols_fallback) {
+    state->vc.clear();
+  }
+
+  if (state->greatest_v_idx >= static_cast<int>(state->v.size() / 3)) {
+    if (warn) {
+      std::stringstream ss;
+      ss << "Vertex indices out of bounds (line " << line_num << ".)\n"
+         << std::endl;
+      (*warn) += ss.str();
+    }
+  }
+  if (state->greatest_vn_idx >= static_cast<int>(state->vn.size() / 3)) {
+    if (warn) {
+      std::stringstream ss;
+      ss << "Vertex normal indices out of bounds (line " << line_num << ".)\n"
+         << std::endl;
+      (*warn) += ss.str();
+    }
+  }
+  if (state->greatest_vt_idx >= static_cast<int>(state->vt.size() / 2)) {
+    if (warn) {
+      std::stringstream ss;
+      ss << "Vertex texcoord indices out of bounds (line " << line_num << ".)\n"
+         << std::endl;
+      (*warn) += ss.str();
+    }
+  }
+
+  bool ret = exportGroupsToShape(&state->shape, state->faceGroup,
+                                 state->lineGroup, state->tags,
+                                 state->material, getStateName(*state),
+                                 getStateNameLength(*state), triangulate,
+                                 state->v, &state->stats);
+  // exportGroupsToShape return false when `usemtl` is called in the last
+  // line.
+  // we also add `shape` to `shapes` when `shape.mesh` has already some
+  // faces(indices)
+  if (ret || state->shape.mesh.indices.size()) {
+    flushShape(state, shapes);
+  }
+  state->faceGroup.clear();  // for safety
+
+  attrib->vertices.swap(state->v);
+  attrib->normals.swap(state->vn);
+  attrib->texcoords.swap(state->vt);
+  attrib->colors.swap(state->vc);
+
+  if (stats) {
+    (*stats) = state->stats;
+    stats->arena_allocations =
+        state->arena->allocation_count() - state->arena_allocations_start;
+    stats->arena_blocks = state->arena->block_count() - state->arena_blocks_start;
+  }
+}
+
+bool LoadObj(attrib_t *attrib, std::vector<shape_t> *shapes,
+             std::vector<material_t> *materials, std::string *warn,
+             std::string *err, std::istream *inStream,
+             MaterialReader *readMatFn /*= NULL*/, bool triangulate,
+             bool default_vcols_fallback, arena_t *arena,
+             load_stats_t *stats) {
+  std::stringstream errss;
+
+  // The temporaries come from the caller's arena, or from one of our own
+  arena_t local_arena;
+  obj_parse_state state(arena ? arena : &local_arena);
+
+  size_t line_num = 0;
+  std::string linebuf;
+  while (inStream->peek() != -1) {
+    safeGetline(*inStream, linebuf);
+
+    line_num++;
+
+    // Trim newline '\r\n' or '\n'
+    if (linebuf.size() > 0) {
+      if (linebuf[linebuf.size() - 1] == '\n')
+        linebuf.erase(linebuf.size() - 1);
+    }
+    if (linebuf.size() > 0) {
+      if (linebuf[linebuf.size() - 1] == '\r')
+        linebuf.erase(linebuf.size() - 1);
+    }
+
+    // Skip if empty line.
+    if (linebuf.empty()) {
       continue;
     }
 
-    // line
-    if (token[0] == 'l' && IS_SPACE((token[1]))) {
+    // Skip leading space.
+    const char *token = linebuf.c_str();
+    token += strspn(token, " \t");
+
+    assert(token);
+    if (token[0] == '\0') continue;  // empty line
+
+    if (token[0] == '#') continue;  // comment line
+
+    // vertex
+    if (token[0] == 'v' && IS_SPACE((token[1]))) {
       token += 2;
+      real_t x, y, z;
+      real_t r, g, b;
 
-      line_t line_cache;
-      bool end_line_bit = 0;
-      while (!IS_NEW_LINE(token[0])) {
-        // get index from string
-        int idx;
-        fixIndex(parseInt(&token), 0, &idx);
+      state.found_all_colors &=
+          parseVertexWithColor(&x, &y, &z, &r, &g, &b, &token);
 
-        size_t n = strspn(token, " \t\r");
-        token += n;
+      pushReals(&state.v, x, y, z, 3, &state.stats);
 
-        if (!end_line_bit) {
-          line_cache.idx0 = idx;
-        } else {
-          line_cache.idx1 = idx;
-          lineGroup.push_back(line_cache.idx0);
-          lineGroup.push_back(line_cache.idx1);
-          line_cache = line_t();
-        }
-        end_line_bit = !end_line_bit;
+      if (state.found_all_colors || default_vcols_fallback) {
+        pushReals(&state.vc, r, g, b, 3, &state.stats);
       }
 
       continue;
     }
+
+    // normal
+    if (token[0] == 'v' && token[1] == 'n' && IS_SPACE((token[2]))) {
+      token += 3;
+      real_t x, y, z;
+      parseReal3(&x, &y, &z, &token);
+      pushReals(&state.vn, x, y, z, 3, &state.stats);
+      continue;
+    }
+
+    // texcoord
+    if (token[0] == 'v' && token[1] == 't' && IS_SPACE((token[2]))) {
+      token += 3;
+      real_t x, y;
+      parseReal2(&x, &y, &token);
+      pushReals(&state.vt, x, y, 0, 2, &state.stats);
+      continue;
+    }
+
     // face
     if (token[0] == 'f' && IS_SPACE((token[1]))) {
       token += 2;
       token += strspn(token, " \t");
 
-      face_t face;
-
-      face.smoothing_group_id = current_smoothing_id;
-      face.vertex_indices.reserve(3);
+      state.faceGroup.push_back(face_t(state.arena));
+      face_t &face = state.faceGroup.back();
+      face.smoothing_group_id = state.current_smoothing_id;
+      face.vertex_indices.reserve(4);  // triangles and quads
 
       while (!IS_NEW_LINE(token[0])) {
         vertex_index_t vi;
-        if (!parseTriple(&token, static_cast<int>(v.size() / 3),
-                         static_cast<int>(vn.size() / 3),
-                         static_cast<int>(vt.size() / 2), &vi)) {
+        if (!parseTriple(&token, static_cast<int>(state.v.size() / 3),
+                         static_cast<int>(state.vn.size() / 3),
+                         static_cast<int>(state.vt.size() / 2), &vi)) {
           if (err) {
             std::stringstream ss;
             ss << "Failed parse `f' line(e.g. zero value for face index. line "
@@ -1966,315 +3068,954 @@ bool LoadObj(attrib_t *attrib, std::vector<shape_t> *shapes,
           return false;
         }
 
-        greatest_v_idx = greatest_v_idx > vi.v_idx ? greatest_v_idx : vi.v_idx;
-        greatest_vn_idx =
-            greatest_vn_idx > vi.vn_idx ? greatest_vn_idx : vi.vn_idx;
-        greatest_vt_idx =
-            greatest_vt_idx > vi.vt_idx ? greatest_vt_idx : vi.vt_idx;
+        updateGreatestIndices(&state, vi);
 
         face.vertex_indices.push_back(vi);
         size_t n = strspn(token, " \t\r");
         token += n;
       }
 
-      // replace with emplace_back + std::move on C++11
-      faceGroup.push_back(face);
+      continue;
+    }
+
+    parseObjCommand(&state, token, line_num, shapes, materials, readMatFn,
+                    triangulate, warn, err);
+  }
 
+  finishObj(&state, line_num, attrib, shapes, triangulate,
+            default_vcols_fallback, warn, stats);
+
+  if (err) {
+    (*err) += errss.str();
+  }
+
+  return true;
+}
+
+// Parsing in place, for the loaders that take a buffer.
+//
+// A line is parsed up to its `e`: the first '\n', '\r' or '\0' in it, which
+// is where LoadObj stops parsing the copy it makes with safeGetline. The
+// functions below never read past `e`, and read `e` itself only where the
+// functions above read the terminating '\0'. So `e` must be readable, which
+// holds for every line except a last line without newline at the very end of
+// the buffer; that one is parsed from a copy.
+
+// Returns the first '\n', '\r' or '\0' in [p, end), or end.
+static inline const char *findLineEnd(const char *p, const char *end) {
+#if defined(TINYOBJLOADER_USE_SSE2)
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i nul = _mm_setzero_si128();
+  while (end - p >= 16) {
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i hit = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(c, lf), _mm_cmpeq_epi8(c, cr)),
+        _mm_cmpeq_epi8(c, nul));
+    int mask = _mm_movemask_epi8(hit);
+    if (mask != 0) {
+#if defined(_MSC_VER)
+      unsigned long index;
+      _BitScanForward(&index, static_cast<unsigned long>(mask));
+      return p + index;
+#else
+      return p + __builtin_ctz(static_cast<unsigned int>(mask));
+#endif
+    }
+    p += 16;
+  }
+#elif defined(TINYOBJLOADER_USE_NEON)
+  const uint8x16_t lf = vdupq_n_u8('\n');
+  const uint8x16_t cr = vdupq_n_u8('\r');
+  while (end - p >= 16) {
+    uint8x16_t c = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+    uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(c, lf), vceqq_u8(c, cr)),
+                              vceqzq_u8(c));
+    if (vmaxvq_u8(hit) != 0) {
+      break;  // the scalar loop below finds it within these 16 bytes
+    }
+    p += 16;
+  }
+#endif
+  while (p < end && *p != '\n' && *p != '\r' && *p != '\0') {
+    p++;
+  }
+  return p;
+}
+
+// A line of a buffer, split like safeGetline does.
+struct obj_line {
+  const char *begin;
+  const char *end;  // excluding the "\n", "\r\n" or "\r"
+  const char *e;    // end of the part to parse, see above
+};
+
+// Reads the line at *p and moves *p to the next one.
+// Returns false at the end of [*p, end).
+static inline bool nextObjLine(const char **p, const char *end,
+                               obj_line *line) {
+  if (*p >= end) {
+    return false;
+  }
+
+  line->begin = *p;
+  line->e = findLineEnd(*p, end);
+  line->end = line->e;
+  while (line->end < end && *line->end != '\n' && *line->end != '\r') {
+    line->end++;  // only after a '\0'
+  }
+
+  *p = line->end;
+  if (*p < end) {
+    if ((*p)[0] == '\r' && (*p) + 1 < end && (*p)[1] == '\n') {
+      (*p) += 2;
+    } else {
+      (*p)++;
+    }
+  }
+  return true;
+}
+
+static inline const char *skipSpace(const char *p, const char *e) {
+  while (p < e && IS_SPACE(*p)) {
+    p++;
+  }
+  return p;
+}
+
+static inline const char *findSpace(const char *p, const char *e) {
+  while (p < e && !IS_SPACE(*p)) {
+    p++;
+  }
+  return p;
+}
+
+// atoi, limited to [p, e).
+static inline int parseIntInPlace(const char *p, const char *e) {
+  while (p < e && (IS_SPACE(*p) || *p == '\v' || *p == '\f')) {
+    p++;
+  }
+  bool negative = false;
+  if (p < e && (*p == '+' || *p == '-')) {
+    negative = (*p == '-');
+    p++;
+  }
+  unsigned int value = 0;
+  while (p < e && IS_DIGIT(*p)) {
+    value = value * 10 + static_cast<unsigned int>(*p - '0');
+    p++;
+  }
+  return static_cast<int>(negative ? 0u - value : value);
+}
+
+// Parses the token at *token as a number and moves *token past the token.
+static inline bool parseDoubleToken(const char **token, const char *e,
+                                    double *val) {
+  (*token) = skipSpace((*token), e);
+#if TINYOBJLOADER_FLOAT_PARSER == TINYOBJLOADER_FLOAT_PARSER_LEGACY
+  const char *end = findSpace((*token), e);
+  bool ret = tryParseDouble((*token), end, val);
+  (*token) = end;
+  return ret;
+#else
+  // The number never contains a space, so the token end is only searched for
+  // after it.
+  const char *number_end = parseDoublePrefix((*token), e, val);
+  (*token) = findSpace(number_end ? number_end : (*token), e);
+  return number_end != NULL;
+#endif
+}
+
+static inline real_t parseRealInPlace(const char **token, const char *e,
+                                      double default_value = 0.0) {
+  double val = default_value;
+  parseDoubleToken(token, e, &val);
+  real_t f = static_cast<real_t>(val);
+  return f;
+}
+
+static inline bool parseRealInPlace(const char **token, const char *e,
+                                    real_t *out) {
+  double val;
+  bool ret = parseDoubleToken(token, e, &val);
+  if (ret) {
+    real_t f = static_cast<real_t>(val);
+    (*out) = f;
+  }
+  return ret;
+}
+
+static inline bool parseVertexWithColorInPlace(real_t *x, real_t *y,
+                                               real_t *z, real_t *r,
+                                               real_t *g, real_t *b,
+                                               const char **token,
+                                               const char *e) {
+  (*x) = parseRealInPlace(token, e);
+  (*y) = parseRealInPlace(token, e);
+  (*z) = parseRealInPlace(token, e);
+
+  const bool found_color = parseRealInPlace(token, e, r) &&
+                           parseRealInPlace(token, e, g) &&
+                           parseRealInPlace(token, e, b);
+
+  if (!found_color) {
+    (*r) = (*g) = (*b) = 1.0;
+  }
+
+  return found_color;
+}
+
+static inline const char *findTripleSeparator(const char *p, const char *e) {
+  while (p < e && *p != '/' && !IS_SPACE(*p)) {
+    p++;
+  }
+  return p;
+}
+
+// Reads an index at p like atoi, and returns the first '/', ' ' or '\t' from
+// p on, like the strcspn calls of parseTriple.
+static inline const char *parseIndexInPlace(const char *p, const char *e,
+                                            int *index) {
+  if (p < e && (IS_DIGIT(*p) || *p == '-')) {
+    // The usual case, digits right up to the separator
+    bool negative = (*p == '-');
+    const char *q = negative ? p + 1 : p;
+    unsigned int value = 0;
+    while (q < e && IS_DIGIT(*q)) {
+      value = value * 10 + static_cast<unsigned int>(*q - '0');
+      q++;
+    }
+    *index = static_cast<int>(negative ? 0u - value : value);
+    return findTripleSeparator(q, e);
+  }
+
+  *index = parseIntInPlace(p, e);
+  return findTripleSeparator(p, e);
+}
+
+// Parses a face index triple like parseTriple, but without resolving relative
+// indices. Indices that are not given are returned as 0, which is not a valid
+// index in OBJ. Fails if a given index is 0.
+static bool parseUnresolvedTriple(const char **token, const char *e,
+                                  vertex_index_t *ret) {
+  vertex_index_t vi(0);
+
+  const char *p = parseIndexInPlace((*token), e, &vi.v_idx);
+  if (vi.v_idx == 0) {
+    return false;
+  }
+
+  if (p < e && p[0] == '/') {
+    p++;
+    if (p < e && p[0] == '/') {
+      // i//k
+      p = parseIndexInPlace(p + 1, e, &vi.vn_idx);
+      if (vi.vn_idx == 0) {
+        return false;
+      }
+    } else {
+      // i/j/k or i/j
+      p = parseIndexInPlace(p, e, &vi.vt_idx);
+      if (vi.vt_idx == 0) {
+        return false;
+      }
+      if (p < e && p[0] == '/') {
+        p = parseIndexInPlace(p + 1, e, &vi.vn_idx);
+        if (vi.vn_idx == 0) {
+          return false;
+        }
+      }
+    }
+  }
+
+  (*token) = p;
+  (*ret) = vi;
+
+  return true;
+}
+
+// Resolves a triple returned by parseUnresolvedTriple against the number of
+// vertices, normals and texcoords defined so far.
+static void resolveTriple(const vertex_index_t &raw, int vsize, int vnsize,
+                          int vtsize, vertex_index_t *ret) {
+  vertex_index_t vi(-1);
+  fixIndex(raw.v_idx, vsize, &vi.v_idx);
+  if (raw.vn_idx != 0) {
+    fixIndex(raw.vn_idx, vnsize, &vi.vn_idx);
+  }
+  if (raw.vt_idx != 0) {
+    fixIndex(raw.vt_idx, vtsize, &vi.vt_idx);
+  }
+  (*ret) = vi;
+}
+
+// Numbers of 'v', 'vn', 'vt' and 'f' lines.
+struct obj_line_counts {
+  size_t v, vn, vt, f;
+};
+
+// Counts the lines of [p, end) by their first word, to reserve the arrays
+// before parsing. Only looks at the start of each line, lines ending in a
+// lone '\r' are missed, which only costs a reallocation.
+static void countObjLines(const char *p, const char *end,
+                          obj_line_counts *counts) {
+  counts->v = counts->vn = counts->vt = counts->f = 0;
+  while (p < end) {
+    p = skipSpace(p, end);
+    if (end - p >= 2) {
+      if (p[0] == 'v') {
+        if (IS_SPACE(p[1])) {
+          counts->v++;
+        } else if (end - p >= 3 && IS_SPACE(p[2])) {
+          counts->vn += (p[1] == 'n');
+          counts->vt += (p[1] == 't');
+        }
+      } else if (p[0] == 'f' && IS_SPACE(p[1])) {
+        counts->f++;
+      }
+    }
+    const char *newline = static_cast<const char *>(
+        memchr(p, '\n', static_cast<size_t>(end - p)));
+    if (!newline) {
+      break;
+    }
+    p = newline + 1;
+  }
+}
+
+static void appendFaceFailedError(size_t line_num, std::string *err) {
+  if (err) {
+    std::stringstream ss;
+    ss << "Failed parse `f' line(e.g. zero value for face index. line "
+       << line_num << ".)\n";
+    (*err) += ss.str();
+  }
+}
+
+bool LoadObjFromBuffer(attrib_t *attrib, std::vector<shape_t> *shapes,
+                       std::vector<material_t> *materials, std::string *warn,
+                       std::string *err, const char *buf, size_t len,
+                       MaterialReader *readMatFn /*= NULL*/, bool triangulate,
+                       bool default_vcols_fallback, arena_t *arena,
+                       load_stats_t *stats) {
+  // The temporaries come from the caller's arena, or from one of our own
+  arena_t local_arena;
+  obj_parse_state state(arena ? arena : &local_arena);
+
+  // The faces only need room for the largest group, but reserving for all of
+  // them is one arena allocation instead of a doubling chain.
+  obj_line_counts counts;
+  countObjLines(buf, buf + len, &counts);
+  state.v.reserve(3 * counts.v);
+  if (default_vcols_fallback) {
+    state.vc.reserve(3 * counts.v);
+  }
+  state.vn.reserve(3 * counts.vn);
+  state.vt.reserve(2 * counts.vt);
+  state.faceGroup.reserve(counts.f);
+
+  // Only holds lines that are not v, vn, vt or f, and a last line without
+  // newline. It keeps its capacity, so it is rarely reallocated.
+  std::string linebuf;
+
+  const char *p = buf;
+  const char *buf_end = buf + len;
+  size_t line_num = 0;
+  obj_line line;
+  while (nextObjLine(&p, buf_end, &line)) {
+    line_num++;
+
+    const char *token = line.begin;
+    const char *e = line.e;
+    bool copied = false;
+    if (e == buf_end) {
+      linebuf.assign(line.begin, line.end);
+      token = linebuf.c_str();
+      e = token + linebuf.size();
+      copied = true;
+    }
+
+    token = skipSpace(token, e);
+
+    if (token == e) continue;  // empty line
+
+    if (token[0] == '#') continue;  // comment line
+
+    // vertex
+    if (token[0] == 'v' && IS_SPACE((token[1]))) {
+      token += 2;
+      real_t x, y, z;
+      real_t r, g, b;
+
+      state.found_all_colors &=
+          parseVertexWithColorInPlace(&x, &y, &z, &r, &g, &b, &token, e);
+
+      pushReals(&state.v, x, y, z, 3, &state.stats);
+
+      if (state.found_all_colors || default_vcols_fallback) {
+        pushReals(&state.vc, r, g, b, 3, &state.stats);
+      }
+
+      continue;
+    }
+
+    // normal
+    if (token[0] == 'v' && token[1] == 'n' && IS_SPACE((token[2]))) {
+      token += 3;
+      real_t x = parseRealInPlace(&token, e);
+      real_t y = parseRealInPlace(&token, e);
+      real_t z = parseRealInPlace(&token, e);
+      pushReals(&state.vn, x, y, z, 3, &state.stats);
+      continue;
+    }
+
+    // texcoord
+    if (token[0] == 'v' && token[1] == 't' && IS_SPACE((token[2]))) {
+      token += 3;
+      real_t x = parseRealInPlace(&token, e);
+      real_t y = parseRealInPlace(&token, e);
+      pushReals(&state.vt, x, y, 0, 2, &state.stats);
+      continue;
+    }
+
+    // face
+    if (token[0] == 'f' && IS_SPACE((token[1]))) {
+      token += 2;
+      token = skipSpace(token, e);
+
+      int vsize = static_cast<int>(state.v.size() / 3);
+      int vnsize = static_cast<int>(state.vn.size() / 3);
+      int vtsize = static_cast<int>(state.vt.size() / 2);
+
+      state.faceGroup.push_back(face_t(state.arena));
+      face_t &face = state.faceGroup.back();
+      face.smoothing_group_id = state.current_smoothing_id;
+      face.vertex_indices.reserve(4);  // triangles and quads
+
+      while (token < e) {
+        vertex_index_t raw;
+        if (!parseUnresolvedTriple(&token, e, &raw)) {
+          appendFaceFailedError(line_num, err);
+          return false;
+        }
+
+        vertex_index_t vi;
+        resolveTriple(raw, vsize, vnsize, vtsize, &vi);
+        updateGreatestIndices(&state, vi);
+
+        face.vertex_indices.push_back(vi);
+        token = skipSpace(token, e);
+      }
+
+      continue;
+    }
+
+    if (copied) {
+      parseObjCommand(&state, token, line_num, shapes, materials, readMatFn,
+                      triangulate, warn, err);
+    } else {
+      linebuf.assign(token, line.end);
+      parseObjCommand(&state, linebuf.c_str(), line_num, shapes, materials,
+                      readMatFn, triangulate, warn, err);
+    }
+  }
+
+  finishObj(&state, line_num, attrib, shapes, triangulate,
+            default_vcols_fallback, warn, stats);
+
+  return true;
+}
+
+// LoadObjParallel does not split buffers into chunks smaller than this.
+static const size_t kMinObjChunkSize = 256 * 1024;
+
+// What a LoadObjParallel worker parsed from its chunk of the .obj.
+// Vertex attributes are parsed in the worker. Face indices are parsed without
+// resolving relative indices, which depend on the vertices of the previous
+// chunks. All other commands are kept as text and run in order by the merge.
+struct obj_chunk {
+  enum command_type { COMMAND_FACE, COMMAND_OTHER, COMMAND_ERROR };
+
+  struct command {
+    command_type type;
+    // Line number in the chunk, starting at 1.
+    size_t line;
+    // Number of 'v', 'vn' and 'vt' lines in the chunk before this command.
+    size_t num_v;
+    size_t num_vn;
+    size_t num_vt;
+    // COMMAND_FACE: range of the face in `indices`.
+    // COMMAND_OTHER: range of the line in the input buffer.
+    size_t offset;
+    size_t length;
+  };
+
+  std::vector<real_t> v;
+  std::vector<real_t> vn;
+  std::vector<real_t> vt;
+  std::vector<real_t> vc;  // always filled, see finishObj
+  bool found_all_colors;
+  std::vector<vertex_index_t> indices;
+  std::vector<command> commands;
+  size_t num_lines;
+
+  obj_chunk() : found_all_colors(true), num_lines(0) {}
+};
+
+static void addObjChunkCommand(obj_chunk *chunk,
+                               obj_chunk::command_type type, size_t offset,
+                               size_t length) {
+  obj_chunk::command command;
+  command.type = type;
+  command.line = chunk->num_lines;
+  command.num_v = chunk->v.size() / 3;
+  command.num_vn = chunk->vn.size() / 3;
+  command.num_vt = chunk->vt.size() / 2;
+  command.offset = offset;
+  command.length = length;
+  chunk->commands.push_back(command);
+}
+
+// Parses the lines in [begin, end), which must start at the beginning of a
+// line. `buf` is the start of the whole buffer.
+static void parseObjChunk(const char *buf, const char *begin, const char *end,
+                          obj_chunk *chunk) {
+  std::string linebuf;  // only for a last line without newline
+  const char *p = begin;
+  obj_line line;
+  while (nextObjLine(&p, end, &line)) {
+    chunk->num_lines++;
+
+    // Chunks other than the last one end after a '\n', so only the last line
+    // of the buffer can end at `end`.
+    const char *token = line.begin;
+    const char *e = line.e;
+    if (e == end) {
+      linebuf.assign(line.begin, line.end);
+      token = linebuf.c_str();
+      e = token + linebuf.size();
+    }
+
+    token = skipSpace(token, e);
+
+    if (token == e) continue;  // empty line
+
+    if (token[0] == '#') continue;  // comment line
+
+    // vertex
+    if (token[0] == 'v' && IS_SPACE((token[1]))) {
+      token += 2;
+      real_t x, y, z;
+      real_t r, g, b;
+
+      chunk->found_all_colors &=
+          parseVertexWithColorInPlace(&x, &y, &z, &r, &g, &b, &token, e);
+
+      chunk->v.push_back(x);
+      chunk->v.push_back(y);
+      chunk->v.push_back(z);
+
+      chunk->vc.push_back(r);
+      chunk->vc.push_back(g);
+      chunk->vc.push_back(b);
+
+      continue;
+    }
+
+    // normal
+    if (token[0] == 'v' && token[1] == 'n' && IS_SPACE((token[2]))) {
+      token += 3;
+      real_t x = parseRealInPlace(&token, e);
+      real_t y = parseRealInPlace(&token, e);
+      real_t z = parseRealInPlace(&token, e);
+      chunk->vn.push_back(x);
+      chunk->vn.push_back(y);
+      chunk->vn.push_back(z);
       continue;
     }
 
-    // use mtl
-    if ((0 == strncmp(token, "usemtl", 6)) && IS_SPACE((token[6]))) {
-      token += 7;
-      std::stringstream ss;
-      ss << token;
-      std::string namebuf = ss.str();
+    // texcoord
+    if (token[0] == 'v' && token[1] == 't' && IS_SPACE((token[2]))) {
+      token += 3;
+      real_t x = parseRealInPlace(&token, e);
+      real_t y = parseRealInPlace(&token, e);
+      chunk->vt.push_back(x);
+      chunk->vt.push_back(y);
+      continue;
+    }
 
-      int newMaterialId = -1;
-      if (material_map.find(namebuf) != material_map.end()) {
-        newMaterialId = material_map[namebuf];
-      } else {
-        // { error!! material not found }
-      }
+    // face
+    if (token[0] == 'f' && IS_SPACE((token[1]))) {
+      token += 2;
+      token = skipSpace(token, e);
 
-      if (newMaterialId != material) {
-        // Create per-face material. Thus we don't add `shape` to `shapes` at
-        // this time.
-        // just clear `faceGroup` after `exportGroupsToShape()` call.
-        exportGroupsToShape(&shape, faceGroup, lineGroup, tags, material, name,
-                            triangulate, v);
-        faceGroup.clear();
-        material = newMaterialId;
+      size_t first_index = chunk->indices.size();
+      while (token < e) {
+        vertex_index_t vi;
+        if (!parseUnresolvedTriple(&token, e, &vi)) {
+          // LoadObj stops at the first bad face, so does the merge.
+          addObjChunkCommand(chunk, obj_chunk::COMMAND_ERROR, 0, 0);
+          return;
+        }
+        chunk->indices.push_back(vi);
+        token = skipSpace(token, e);
       }
 
+      addObjChunkCommand(chunk, obj_chunk::COMMAND_FACE, first_index,
+                         chunk->indices.size() - first_index);
       continue;
     }
 
-    // load mtl
-    if ((0 == strncmp(token, "mtllib", 6)) && IS_SPACE((token[6]))) {
-      if (readMatFn) {
-        token += 7;
+    addObjChunkCommand(chunk, obj_chunk::COMMAND_OTHER,
+                       static_cast<size_t>(line.begin - buf),
+                       static_cast<size_t>(line.end - line.begin));
+  }
+}
 
-        std::vector<std::string> filenames;
-        SplitString(std::string(token), ' ', filenames);
+// Appends the elements [begin, end) of `src` to `dst`.
+static inline void appendReals(std::vector<real_t> *dst,
+                               const std::vector<real_t> &src, size_t begin,
+                               size_t end) {
+  if (end > begin) {
+    dst->insert(dst->end(), src.begin() + static_cast<std::ptrdiff_t>(begin),
+                src.begin() + static_cast<std::ptrdiff_t>(end));
+  }
+}
 
-        if (filenames.empty()) {
-          if (warn) {
-            std::stringstream ss;
-            ss << "Looks like empty filename for mtllib. Use default "
-                  "material (line "
-               << line_num << ".)\n";
+// Appends the vertex attributes of `chunk` up to the given counts to `state`.
+// `done_v`, `done_vn` and `done_vt` are the counts already appended.
+static void appendChunkAttributes(obj_parse_state *state,
+                                  const obj_chunk &chunk, size_t num_v,
+                                  size_t num_vn, size_t num_vt, size_t *done_v,
+                                  size_t *done_vn, size_t *done_vt) {
+  appendReals(&state->v, chunk.v, (*done_v) * 3, num_v * 3);
+  appendReals(&state->vc, chunk.vc, (*done_v) * 3, num_v * 3);
+  appendReals(&state->vn, chunk.vn, (*done_vn) * 3, num_vn * 3);
+  appendReals(&state->vt, chunk.vt, (*done_vt) * 2, num_vt * 2);
+  state->stats.bytes_copied +=
+      ((num_v - (*done_v)) * 6 + (num_vn - (*done_vn)) * 3 +
+       (num_vt - (*done_vt)) * 2) *
+      sizeof(real_t);
+  (*done_v) = num_v;
+  (*done_vn) = num_vn;
+  (*done_vt) = num_vt;
+}
 
-            (*warn) += ss.str();
-          }
-        } else {
-          bool found = false;
-          for (size_t s = 0; s < filenames.size(); s++) {
-            std::string warn_mtl;
-            std::string err_mtl;
-            bool ok = (*readMatFn)(filenames[s].c_str(), materials,
-                                   &material_map, &warn_mtl, &err_mtl);
-            if (warn && (!warn_mtl.empty())) {
-              (*warn) += warn_mtl;
-            }
+bool LoadObjParallel(attrib_t *attrib, std::vector<shape_t> *shapes,
+                     std::vector<material_t> *materials, std::string *warn,
+                     std::string *err, const char *buf, size_t len,
+                     MaterialReader *readMatFn /*= NULL*/, bool triangulate,
+                     bool default_vcols_fallback, unsigned int num_threads,
+                     arena_t *arena, load_stats_t *stats) {
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  size_t num_chunks = num_threads > 0 ? num_threads : 1;
+  if (len / num_chunks < kMinObjChunkSize) {
+    num_chunks = len / kMinObjChunkSize;
+  }
+  if (num_chunks == 0) {
+    num_chunks = 1;
+  }
 
-            if (err && (!err_mtl.empty())) {
-              (*err) += err_mtl;
-            }
+  // Split after a '\n', so no line and no "\r\n" spans two chunks.
+  std::vector<const char *> bounds;
+  bounds.push_back(buf);
+  for (size_t i = 1; i < num_chunks; i++) {
+    const char *p = buf + len / num_chunks * i;
+    if (p < bounds.back()) {
+      p = bounds.back();
+    }
+    const char *newline = static_cast<const char *>(
+        memchr(p, '\n', static_cast<size_t>(buf + len - p)));
+    if (!newline) {
+      break;
+    }
+    if (newline + 1 > bounds.back() && newline + 1 < buf + len) {
+      bounds.push_back(newline + 1);
+    }
+  }
+  bounds.push_back(buf + len);
 
-            if (ok) {
-              found = true;
-              break;
-            }
-          }
+  std::vector<obj_chunk> chunks(bounds.size() - 1);
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < chunks.size(); i++) {
+    workers.push_back(std::thread(parseObjChunk, buf, bounds[i],
+                                  bounds[i + 1], &chunks[i]));
+  }
+  parseObjChunk(buf, bounds[0], bounds[1], &chunks[0]);
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
 
-          if (!found) {
-            if (warn) {
-              (*warn) +=
-                  "Failed to load material file(s). Use default "
-                  "material.\n";
-            }
-          }
-        }
+  // Merge in file order, running the commands through the same state as
+  // LoadObj. Vertex attributes are appended up to each command, so every
+  // command sees the vertices defined before its line.
+  // The temporaries come from the caller's arena, or from one of our own
+  arena_t local_arena;
+  obj_parse_state state(arena ? arena : &local_arena);
+  {
+    size_t total_v = 0, total_vn = 0, total_vt = 0, total_f = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+      total_v += chunks[i].v.size();
+      total_vn += chunks[i].vn.size();
+      total_vt += chunks[i].vt.size();
+      for (size_t c = 0; c < chunks[i].commands.size(); c++) {
+        total_f += chunks[i].commands[c].type == obj_chunk::COMMAND_FACE;
       }
+      state.found_all_colors &= chunks[i].found_all_colors;
+    }
+    state.v.reserve(total_v);
+    state.vc.reserve(total_v);
+    state.vn.reserve(total_vn);
+    state.vt.reserve(total_vt);
+    state.faceGroup.reserve(total_f);
+  }
 
-      continue;
+  size_t line_base = 0;
+  std::string linebuf;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    obj_chunk &chunk = chunks[i];
+    size_t done_v = 0, done_vn = 0, done_vt = 0;
+
+    for (size_t c = 0; c < chunk.commands.size(); c++) {
+      const obj_chunk::command &command = chunk.commands[c];
+      size_t line_num = line_base + command.line;
+
+      appendChunkAttributes(&state, chunk, command.num_v, command.num_vn,
+                            command.num_vt, &done_v, &done_vn, &done_vt);
+
+      if (command.type == obj_chunk::COMMAND_FACE) {
+        int vsize = static_cast<int>(state.v.size() / 3);
+        int vnsize = static_cast<int>(state.vn.size() / 3);
+        int vtsize = static_cast<int>(state.vt.size() / 2);
+
+        state.faceGroup.push_back(face_t(state.arena));
+        face_t &face = state.faceGroup.back();
+        face.smoothing_group_id = state.current_smoothing_id;
+        face.vertex_indices.resize(command.length);
+        for (size_t k = 0; k < command.length; k++) {
+          vertex_index_t &vi = face.vertex_indices[k];
+          resolveTriple(chunk.indices[command.offset + k], vsize, vnsize,
+                        vtsize, &vi);
+          updateGreatestIndices(&state, vi);
+        }
+      } else if (command.type == obj_chunk::COMMAND_OTHER) {
+        linebuf.assign(buf + command.offset, command.length);
+        const char *token = linebuf.c_str();
+        token += strspn(token, " \t");
+        parseObjCommand(&state, token, line_num, shapes, materials, readMatFn,
+                        triangulate, warn, err);
+      } else {
+        appendFaceFailedError(line_num, err);
+        return false;
+      }
     }
 
-    // group name
-    if (token[0] == 'g' && IS_SPACE((token[1]))) {
-      // flush previous face group.
-      bool ret = exportGroupsToShape(&shape, faceGroup, lineGroup, tags,
-                                     material, name, triangulate, v);
-      (void)ret;  // return value not used.
+    appendChunkAttributes(&state, chunk, chunk.v.size() / 3,
+                          chunk.vn.size() / 3, chunk.vt.size() / 2, &done_v,
+                          &done_vn, &done_vt);
+    line_base += chunk.num_lines;
 
-      if (shape.mesh.indices.size() > 0) {
-        shapes->push_back(shape);
-      }
+    // Release the chunk as soon as it is merged
+    chunk = obj_chunk();
+  }
 
-      shape = shape_t();
+  finishObj(&state, line_base, attrib, shapes, triangulate,
+            default_vcols_fallback, warn, stats);
 
-      // material = -1;
-      faceGroup.clear();
+  return true;
+}
 
-      std::vector<std::string> names;
+// What LoadObjWithCallback and LoadObjFromBufferWithCallback keep between
+// lines.
+struct callback_parse_state {
+  std::map<std::string, int> material_map;  // filled by MaterialReader
+  material_name_table material_names;       // looked up by usemtl
+  int material_id;  // -1 = invalid
+  std::vector<material_t> materials;
+  name_table_t names;            // group names, the callback gets pointers
+  std::vector<int> name_ids;     // of the current 'g' line
+  std::vector<const char *> names_out;
 
-      while (!IS_NEW_LINE(token[0])) {
-        std::string str = parseString(&token);
-        names.push_back(str);
-        token += strspn(token, " \t\r");  // skip tag
-      }
+  callback_parse_state() : material_id(-1) {}
+};
+
+// Runs a command of the callback loaders other than v, vn, vt and f. `token`
+// is the null-terminated command.
+static void parseCallbackCommand(callback_parse_state *state,
+                                 const char *token, const callback_t &callback,
+                                 void *user_data, MaterialReader *readMatFn,
+                                 std::string *warn, std::string *err) {
+  // use mtl
+  if ((0 == strncmp(token, "usemtl", 6)) && IS_SPACE((token[6]))) {
+    token += 7;
+
+    // The name is the rest of the line, -1 if there is no such material
+    int newMaterialId = state->material_names.find(token, strlen(token));
+
+    if (newMaterialId != state->material_id) {
+      state->material_id = newMaterialId;
+    }
+
+    if (callback.usemtl_cb) {
+      callback.usemtl_cb(user_data, token, state->material_id);
+    }
+
+    return;
+  }
 
-      // names[0] must be 'g'
+  // load mtl
+  if ((0 == strncmp(token, "mtllib", 6)) && IS_SPACE((token[6]))) {
+    if (readMatFn) {
+      token += 7;
+
+      std::vector<std::string> filenames;
+      SplitString(std::string(token), ' ', filenames);
 
-      if (names.size() < 2) {
-        // 'g' with empty names
+      if (filenames.empty()) {
         if (warn) {
-          std::stringstream ss;
-          ss << "Empty group name. line: " << line_num << "\n";
-          (*warn) += ss.str();
-          name = "";
+          (*warn) +=
+              "Looks like empty filename for mtllib. Use default "
+              "material. \n";
         }
       } else {
-        std::stringstream ss;
-        ss << names[1];
+        bool found = false;
+        for (size_t s = 0; s < filenames.size(); s++) {
+          std::string warn_mtl;
+          std::string err_mtl;
+          bool ok = (*readMatFn)(filenames[s].c_str(), &state->materials,
+                                 &state->material_map, &warn_mtl, &err_mtl);
+          state->material_names.update(state->material_map);
+
+          if (warn && (!warn_mtl.empty())) {
+            (*warn) += warn_mtl;  // This should be warn message.
+          }
 
-        // tinyobjloader does not support multiple groups for a primitive.
-        // Currently we concatinate multiple group names with a space to get
-        // single group name.
+          if (err && (!err_mtl.empty())) {
+            (*err) += err_mtl;
+          }
 
-        for (size_t i = 2; i < names.size(); i++) {
-          ss << " " << names[i];
+          if (ok) {
+            found = true;
+            break;
+          }
         }
 
-        name = ss.str();
+        if (!found) {
+          if (warn) {
+            (*warn) +=
+                "Failed to load material file(s). Use default "
+                "material.\n";
+          }
+        } else {
+          if (callback.mtllib_cb) {
+            callback.mtllib_cb(user_data, &state->materials.at(0),
+                               static_cast<int>(state->materials.size()));
+          }
+        }
       }
-
-      continue;
     }
 
-    // object name
-    if (token[0] == 'o' && IS_SPACE((token[1]))) {
-      // flush previous face group.
-      bool ret = exportGroupsToShape(&shape, faceGroup, lineGroup, tags,
-                                     material, name, triangulate, v);
-      if (ret) {
-        shapes->push_back(shape);
-      }
-
-      // material = -1;
-      faceGroup.clear();
-      shape = shape_t();
+    return;
+  }
 
-      // @todo { multiple object name? }
-      token += 2;
-      std::stringstream ss;
-      ss << token;
-      name = ss.str();
+  // group name
+  if (token[0] == 'g' && IS_SPACE((token[1]))) {
+    state->name_ids.clear();
 
-      continue;
+    while (!IS_NEW_LINE(token[0])) {
+      size_t length;
+      const char *name = parseStringInPlace(&token, &length);
+      state->name_ids.push_back(state->names.intern(name, length));
+      token += strspn(token, " \t\r");  // skip tag
     }
 
-    if (token[0] == 't' && IS_SPACE(token[1])) {
-      const int max_tag_nums = 8192;  // FIXME(syoyo): Parameterize.
-      tag_t tag;
+    assert(state->name_ids.size() > 0);
 
-      token += 2;
-
-      tag.name = parseString(&token);
-
-      tag_sizes ts = parseTagTriple(&token);
-
-      if (ts.num_ints < 0) {
-        ts.num_ints = 0;
-      }
-      if (ts.num_ints > max_tag_nums) {
-        ts.num_ints = max_tag_nums;
-      }
-
-      if (ts.num_reals < 0) {
-        ts.num_reals = 0;
-      }
-      if (ts.num_reals > max_tag_nums) {
-        ts.num_reals = max_tag_nums;
-      }
+    if (callback.group_cb) {
+      if (state->name_ids.size() > 1) {
+        // create const char* array, once all names are interned.
+        state->names_out.resize(state->name_ids.size() - 1);
+        for (size_t j = 0; j < state->names_out.size(); j++) {
+          state->names_out[j] = state->names.name(state->name_ids[j + 1]);
+        }
+        callback.group_cb(user_data, &state->names_out.at(0),
+                          static_cast<int>(state->names_out.size()));
 
-      if (ts.num_strings < 0) {
-        ts.num_strings = 0;
-      }
-      if (ts.num_strings > max_tag_nums) {
-        ts.num_strings = max_tag_nums;
+      } else {
+        callback.group_cb(user_data, NULL, 0);
       }
+    }
 
-      tag.intValues.resize(static_cast<size_t>(ts.num_ints));
+    return;
+  }
 
-      for (size_t i = 0; i < static_cast<size_t>(ts.num_ints); ++i) {
-        tag.intValues[i] = parseInt(&token);
-      }
+  // object name
+  if (token[0] == 'o' && IS_SPACE((token[1]))) {
+    // @todo { multiple object name? }
+    token += 2;
 
-      tag.floatValues.resize(static_cast<size_t>(ts.num_reals));
-      for (size_t i = 0; i < static_cast<size_t>(ts.num_reals); ++i) {
-        tag.floatValues[i] = parseReal(&token);
-      }
+    if (callback.object_cb) {
+      callback.object_cb(user_data, token);  // the rest of the line
+    }
 
-      tag.stringValues.resize(static_cast<size_t>(ts.num_strings));
-      for (size_t i = 0; i < static_cast<size_t>(ts.num_strings); ++i) {
-        tag.stringValues[i] = parseString(&token);
-      }
+    return;
+  }
 
-      tags.push_back(tag);
+  // smoothing group id
+  if (token[0] == 's' && IS_SPACE(token[1])) {
+    token += 2;
 
-      continue;
+    unsigned int smoothing_group_id;
+    if (callback.smoothing_group_cb &&
+        parseSmoothingGroupId(token, &smoothing_group_id)) {
+      callback.smoothing_group_cb(user_data, smoothing_group_id);
     }
 
-    if (token[0] == 's' && IS_SPACE(token[1])) {
-      // smoothing group id
-      token += 2;
-
-      // skip space.
-      token += strspn(token, " \t");  // skip space
-
-      if (token[0] == '\0') {
-        continue;
-      }
+    return;
+  }
 
-      if (token[0] == '\r' || token[1] == '\n') {
-        continue;
-      }
+#if 0  // @todo
+  if (token[0] == 't' && IS_SPACE(token[1])) {
+    tag_t tag;
 
-      if (strlen(token) >= 3) {
-        if (token[0] == 'o' && token[1] == 'f' && token[2] == 'f') {
-          current_smoothing_id = 0;
-        }
-      } else {
-        // assume number
-        int smGroupId = parseInt(&token);
-        if (smGroupId < 0) {
-          // parse error. force set to 0.
-          // FIXME(syoyo): Report warning.
-          current_smoothing_id = 0;
-        } else {
-          current_smoothing_id = static_cast<unsigned int>(smGroupId);
-        }
-      }
+    token += 2;
+    std::stringstream ss;
+    ss << token;
+    tag.name = ss.str();
 
-      continue;
-    }  // smoothing group id
+    token += tag.name.size() + 1;
 
-    // Ignore unknown command.
-  }
+    tag_sizes ts = parseTagTriple(&token);
 
-  // not all vertices have colors, no default colors desired? -> clear colors
-  if (!found_all_colors && !default_vcols_fallback) {
-    vc.clear();
-  }
+    tag.intValues.resize(static_cast<size_t>(ts.num_ints));
 
-  if (greatest_v_idx >= static_cast<int>(v.size() / 3)) {
-    if (warn) {
-      std::stringstream ss;
-      ss << "Vertex indices out of bounds (line " << line_num << ".)\n"
-         << std::endl;
-      (*warn) += ss.str();
+    for (size_t i = 0; i < static_cast<size_t>(ts.num_ints); ++i) {
+      tag.intValues[i] = atoi(token);
+      token += strcspn(token, "/ \t\r") + 1;
     }
-  }
-  if (greatest_vn_idx >= static_cast<int>(vn.size() / 3)) {
-    if (warn) {
-      std::stringstream ss;
-      ss << "Vertex normal indices out of bounds (line " << line_num << ".)\n"
-         << std::endl;
-      (*warn) += ss.str();
+
+    tag.floatValues.resize(static_cast<size_t>(ts.num_reals));
+    for (size_t i = 0; i < static_cast<size_t>(ts.num_reals); ++i) {
+      tag.floatValues[i] = parseReal(&token);
+      token += strcspn(token, "/ \t\r") + 1;
     }
-  }
-  if (greatest_vt_idx >= static_cast<int>(vt.size() / 2)) {
-    if (warn) {
+
+    tag.stringValues.resize(static_cast<size_t>(ts.num_strings));
+    for (size_t i = 0; i < static_cast<size_t>(ts.num_strings); ++i) {
       std::stringstream ss;
-      ss << "Vertex texcoord indices out of bounds (line " << line_num << ".)\n"
-         << std::endl;
-      (*warn) += ss.str();
+      ss << token;
+      tag.stringValues[i] = ss.str();
+      token += tag.stringValues[i].size() + 1;
     }
-  }
-
-  bool ret = exportGroupsToShape(&shape, faceGroup, lineGroup, tags, material,
-                                 name, triangulate, v);
-  // exportGroupsToShape return false when `usemtl` is called in the last
-  // line.
-  // we also add `shape` to `shapes` when `shape.mesh` has already some
-  // faces(indices)
-  if (ret || shape.mesh.indices.size()) {
-    shapes->push_back(shape);
-  }
-  faceGroup.clear();  // for safety
 
-  if (err) {
-    (*err) += errss.str();
+    tags.push_back(tag);
   }
+#endif
 
-  attrib->vertices.swap(v);
-  attrib->normals.swap(vn);
-  attrib->texcoords.swap(vt);
-  attrib->colors.swap(vc);
 
-  return true;
+  // Ignore unknown command.
 }
 
 bool LoadObjWithCallback(std::istream &inStream, const callback_t &callback,
@@ -2284,15 +4025,8 @@ bool LoadObjWithCallback(std::istream &inStream, const callback_t &callback,
                          std::string *err /*= NULL*/) {
   std::stringstream errss;
 
-  // material
-  std::map<std::string, int> material_map;
-  int material_id = -1;  // -1 = invalid
-
+  callback_parse_state state;
   std::vector<index_t> indices;
-  std::vector<material_t> materials;
-  std::vector<std::string> names;
-  names.reserve(2);
-  std::vector<const char *> names_out;
 
   std::string linebuf;
   while (inStream.peek() != -1) {
@@ -2383,174 +4117,125 @@ bool LoadObjWithCallback(std::istream &inStream, const callback_t &callback,
       continue;
     }
 
-    // use mtl
-    if ((0 == strncmp(token, "usemtl", 6)) && IS_SPACE((token[6]))) {
-      token += 7;
-      std::stringstream ss;
-      ss << token;
-      std::string namebuf = ss.str();
+    parseCallbackCommand(&state, token, callback, user_data, readMatFn, warn,
+                         err);
+  }
 
-      int newMaterialId = -1;
-      if (material_map.find(namebuf) != material_map.end()) {
-        newMaterialId = material_map[namebuf];
-      } else {
-        // { error!! material not found }
-      }
+  if (err) {
+    (*err) += errss.str();
+  }
 
-      if (newMaterialId != material_id) {
-        material_id = newMaterialId;
-      }
+  return true;
+}
 
-      if (callback.usemtl_cb) {
-        callback.usemtl_cb(user_data, namebuf.c_str(), material_id);
-      }
+bool LoadObjFromBufferWithCallback(const char *buf, size_t len,
+                                   const callback_t &callback,
+                                   void *user_data /*= NULL*/,
+                                   MaterialReader *readMatFn /*= NULL*/,
+                                   std::string *warn /*= NULL*/,
+                                   std::string *err /*= NULL*/) {
+  callback_parse_state state;
+  std::vector<index_t> indices;
 
-      continue;
-    }
+  // Only holds lines that are not v, vn, vt or f, and a last line without
+  // newline, see LoadObjFromBuffer.
+  std::string linebuf;
 
-    // load mtl
-    if ((0 == strncmp(token, "mtllib", 6)) && IS_SPACE((token[6]))) {
-      if (readMatFn) {
-        token += 7;
+  const char *p = buf;
+  const char *buf_end = buf + len;
+  size_t line_num = 0;
+  obj_line line;
+  while (nextObjLine(&p, buf_end, &line)) {
+    line_num++;
 
-        std::vector<std::string> filenames;
-        SplitString(std::string(token), ' ', filenames);
+    const char *token = line.begin;
+    const char *e = line.e;
+    bool copied = false;
+    if (e == buf_end) {
+      linebuf.assign(line.begin, line.end);
+      token = linebuf.c_str();
+      e = token + linebuf.size();
+      copied = true;
+    }
 
-        if (filenames.empty()) {
-          if (warn) {
-            (*warn) +=
-                "Looks like empty filename for mtllib. Use default "
-                "material. \n";
-          }
-        } else {
-          bool found = false;
-          for (size_t s = 0; s < filenames.size(); s++) {
-            std::string warn_mtl;
-            std::string err_mtl;
-            bool ok = (*readMatFn)(filenames[s].c_str(), &materials,
-                                   &material_map, &warn_mtl, &err_mtl);
-
-            if (warn && (!warn_mtl.empty())) {
-              (*warn) += warn_mtl;  // This should be warn message.
-            }
+    token = skipSpace(token, e);
 
-            if (err && (!err_mtl.empty())) {
-              (*err) += err_mtl;
-            }
+    if (token == e) continue;  // empty line
 
-            if (ok) {
-              found = true;
-              break;
-            }
-          }
+    if (token[0] == '#') continue;  // comment line
 
-          if (!found) {
-            if (warn) {
-              (*warn) +=
-                  "Failed to load material file(s). Use default "
-                  "material.\n";
-            }
-          } else {
-            if (callback.mtllib_cb) {
-              callback.mtllib_cb(user_data, &materials.at(0),
-                                 static_cast<int>(materials.size()));
-            }
-          }
-        }
+    // vertex
+    if (token[0] == 'v' && IS_SPACE((token[1]))) {
+      token += 2;
+      real_t x = parseRealInPlace(&token, e);
+      real_t y = parseRealInPlace(&token, e);
+      real_t z = parseRealInPlace(&token, e);
+      real_t w = parseRealInPlace(&token, e, 1.0);
+      if (callback.vertex_cb) {
+        callback.vertex_cb(user_data, x, y, z, w);
       }
-
       continue;
     }
 
-    // group name
-    if (token[0] == 'g' && IS_SPACE((token[1]))) {
-      names.clear();
-
-      while (!IS_NEW_LINE(token[0])) {
-        std::string str = parseString(&token);
-        names.push_back(str);
-        token += strspn(token, " \t\r");  // skip tag
-      }
-
-      assert(names.size() > 0);
-
-      if (callback.group_cb) {
-        if (names.size() > 1) {
-          // create const char* array.
-          names_out.resize(names.size() - 1);
-          for (size_t j = 0; j < names_out.size(); j++) {
-            names_out[j] = names[j + 1].c_str();
-          }
-          callback.group_cb(user_data, &names_out.at(0),
-                            static_cast<int>(names_out.size()));
-
-        } else {
-          callback.group_cb(user_data, NULL, 0);
-        }
+    // normal
+    if (token[0] == 'v' && token[1] == 'n' && IS_SPACE((token[2]))) {
+      token += 3;
+      real_t x = parseRealInPlace(&token, e);
+      real_t y = parseRealInPlace(&token, e);
+      real_t z = parseRealInPlace(&token, e);
+      if (callback.normal_cb) {
+        callback.normal_cb(user_data, x, y, z);
       }
-
       continue;
     }
 
-    // object name
-    if (token[0] == 'o' && IS_SPACE((token[1]))) {
-      // @todo { multiple object name? }
-      token += 2;
-
-      std::stringstream ss;
-      ss << token;
-      std::string object_name = ss.str();
-
-      if (callback.object_cb) {
-        callback.object_cb(user_data, object_name.c_str());
+    // texcoord
+    if (token[0] == 'v' && token[1] == 't' && IS_SPACE((token[2]))) {
+      token += 3;
+      real_t x = parseRealInPlace(&token, e);
+      real_t y = parseRealInPlace(&token, e);
+      real_t z = parseRealInPlace(&token, e);
+      if (callback.texcoord_cb) {
+        callback.texcoord_cb(user_data, x, y, z);
       }
-
       continue;
     }
 
-#if 0  // @todo
-    if (token[0] == 't' && IS_SPACE(token[1])) {
-      tag_t tag;
-
+    // face
+    if (token[0] == 'f' && IS_SPACE((token[1]))) {
       token += 2;
-      std::stringstream ss;
-      ss << token;
-      tag.name = ss.str();
+      token = skipSpace(token, e);
 
-      token += tag.name.size() + 1;
-
-      tag_sizes ts = parseTagTriple(&token);
-
-      tag.intValues.resize(static_cast<size_t>(ts.num_ints));
-
-      for (size_t i = 0; i < static_cast<size_t>(ts.num_ints); ++i) {
-        tag.intValues[i] = atoi(token);
-        token += strcspn(token, "/ \t\r") + 1;
-      }
+      indices.clear();
+      while (token < e) {
+        vertex_index_t raw;
+        if (!parseUnresolvedTriple(&token, e, &raw)) {
+          appendFaceFailedError(line_num, err);
+          return false;
+        }
 
-      tag.floatValues.resize(static_cast<size_t>(ts.num_reals));
-      for (size_t i = 0; i < static_cast<size_t>(ts.num_reals); ++i) {
-        tag.floatValues[i] = parseReal(&token);
-        token += strcspn(token, "/ \t\r") + 1;
+        index_t idx;
+        idx.vertex_index = raw.v_idx;
+        idx.normal_index = raw.vn_idx;
+        idx.texcoord_index = raw.vt_idx;
+        indices.push_back(idx);
+        token = skipSpace(token, e);
       }
 
-      tag.stringValues.resize(static_cast<size_t>(ts.num_strings));
-      for (size_t i = 0; i < static_cast<size_t>(ts.num_strings); ++i) {
-        std::stringstream ss;
-        ss << token;
-        tag.stringValues[i] = ss.str();
-        token += tag.stringValues[i].size() + 1;
+      if (callback.index_cb && indices.size() > 0) {
+        callback.index_cb(user_data, &indices.at(0),
+                          static_cast<int>(indices.size()));
       }
 
-      tags.push_back(tag);
+      continue;
     }
-#endif
-
-    // Ignore unknown command.
-  }
 
-  if (err) {
-    (*err) += errss.str();
+    if (!copied) {
+      linebuf.assign(token, line.end);
+      token = linebuf.c_str();
+    }
+    parseCallbackCommand(&state, token, callback, user_data, readMatFn, warn,
+                         err);
   }
 
   return true;
@@ -12,7 +12,11 @@ countries.
 
 #include <Log.h>
 #include <MathUtils.h>
-#include <MemoryStream.h>
+#include <MeshBuilder.h>
+#include <MeshNormals.h>
+#include <MeshOptimizer.h>
+#include <MeshPartitioner.h>
+#include <MeshSimplifier.h>
 #include <Models.h>
 
 #include <DirectXMath.h>
@@ -28,6 +32,7 @@ namespace
     const winrt::hstring RES_PATH_SHADER_VERTEX_COLOR_PS    = L"VertexColorPixelShader.cso";
     const winrt::hstring RES_PATH_SHADER_TEXTURED_VS        = L"TexturedVertexShader.cso";
     const winrt::hstring RES_PATH_SHADER_TEXTURED_PS        = L"TexturedPixelShader.cso";
+    const winrt::hstring RES_PATH_SHADER_QUANTIZED_TEXTURED_VS = L"QuantizedTexturedVertexShader.cso";
     const winrt::hstring RES_PATH_SHADER_VIDEO_BKGD_VS      = L"VideoBackgroundVertexShader.cso";
     const winrt::hstring RES_PATH_SHADER_VIDEO_BKGD_PS      = L"VideoBackgroundPixelShader.cso";
 
@@ -38,8 +43,19 @@ namespace
 
     const unsigned int NUM_GUIDE_VIEW_VERTEX = 6;
 
-    const float WORLDORIGIN_AXES_SCALE = 0.1f;
-    const float WORLDORIGIN_CUBE_SCALE = 0.015f;
+    /// Part of the mesh cache hash, increment when MeshBuilder, MeshNormals, MeshPartitioner,
+    /// MeshOptimizer or MeshSimplifier output changes
+    constexpr std::uint32_t MESH_PIPELINE_VERSION = 6;
+
+    /// Models are drawn with the coarsest level of detail that is at most this far off on screen
+    constexpr float MAX_LOD_ERROR_PIXELS = 1.0f;
+
+    constexpr float WORLDORIGIN_AXES_SCALE = 0.1f;
+    constexpr float WORLDORIGIN_CUBE_SCALE = 0.015f;
+
+    constexpr SampleMath::Vec3 WORLDORIGIN_AXES_SCALE_VEC(WORLDORIGIN_AXES_SCALE, WORLDORIGIN_AXES_SCALE, WORLDORIGIN_AXES_SCALE);
+    constexpr SampleMath::Vec3 WORLDORIGIN_CUBE_SCALE_VEC(WORLDORIGIN_CUBE_SCALE, WORLDORIGIN_CUBE_SCALE, WORLDORIGIN_CUBE_SCALE);
+    constexpr SampleMath::Vec3 AXIS_10CM_SIZE(0.1f, 0.1f, 0.1f);
 }
 
 namespace SampleColors
@@ -77,6 +93,7 @@ namespace winrt::VuforiaSample::implementation
         auto loadVertexColorPSTask = DX::ReadDataAsync(RES_PATH_SHADER_VERTEX_COLOR_PS);
         auto loadTexturedVSTask = DX::ReadDataAsync(RES_PATH_SHADER_TEXTURED_VS);
         auto loadTexturedPSTask = DX::ReadDataAsync(RES_PATH_SHADER_TEXTURED_PS);
+        auto loadQuantizedTexturedVSTask = DX::ReadDataAsync(RES_PATH_SHADER_QUANTIZED_TEXTURED_VS);
         auto loadVideoBgVSTask = DX::ReadDataAsync(RES_PATH_SHADER_VIDEO_BKGD_VS);
         auto loadVideoBgPSTask = DX::ReadDataAsync(RES_PATH_SHADER_VIDEO_BKGD_PS);
 
@@ -93,6 +110,10 @@ namespace winrt::VuforiaSample::implementation
         {
             initTexturedVertexShader(fileData);
         });
+        auto createQuantizedTexturedVSTask = loadQuantizedTexturedVSTask.then([this](const std::vector<byte>& fileData)
+        {
+            initQuantizedTexturedVertexShader(fileData);
+        });
         auto createVideoBgVSTask = loadVideoBgVSTask.then([this](const std::vector<byte>& fileData)
         {
             initVideoBackgroundVertexShader(fileData);
@@ -120,7 +141,7 @@ namespace winrt::VuforiaSample::implementation
         auto createAugmentationModelsTask = (
             createConstColorPSTask && createConstColorVSTask && 
             createVertexColorPSTask && createVertexColorVSTask &&
-            createTexturedPSTask && createTexturedVSTask &&
+            createTexturedPSTask && createTexturedVSTask && createQuantizedTexturedVSTask &&
             createVideoBgPSTask && createVideoBgVSTask).then([this]()
         {
             initSquare();
@@ -238,6 +259,10 @@ namespace winrt::VuforiaSample::implementation
         mTexturedPixelShader = nullptr;
         mTexturedConstantBuffer = nullptr;
 
+        mQuantizedTexturedInputLayout = nullptr;
+        mQuantizedTexturedVertexShader = nullptr;
+        mQuantizedTexturedConstantBuffer = nullptr;
+
         mSquareVertexBuffer = nullptr;
         mSquareSolidIndexBuffer = nullptr;
         mSquareWireframeIndexBuffer = nullptr;
@@ -252,12 +277,10 @@ namespace winrt::VuforiaSample::implementation
         mGuideViewVertexBuffer = nullptr;
         mGuideViewTexture.reset();
 
-        mAstronautVertexBuffer = nullptr;
-        mAstronautVertexCount = -1;
+        mAstronautModel = ModelBuffers();
         mAstronautTexture.reset();
 
-        mLanderVertexBuffer = nullptr;
-        mLanderVertexCount = -1;
+        mLanderModel = ModelBuffers();
         mLanderTexture.reset();
 
         mDeviceResources.reset();
@@ -451,17 +474,14 @@ namespace winrt::VuforiaSample::implementation
         // Scale and convert the model-view to an XMMATRIX
         Vuforia::Matrix44F scaledModelViewMatrix;
 
-        Vuforia::Vec3F axisScaleVec(WORLDORIGIN_AXES_SCALE, WORLDORIGIN_AXES_SCALE, WORLDORIGIN_AXES_SCALE);
-        scaledModelViewMatrix = MathUtils::Matrix44FScale(axisScaleVec, modelViewMatrix);
+        scaledModelViewMatrix = SampleMath::scaled(modelViewMatrix, WORLDORIGIN_AXES_SCALE_VEC);
         DirectX::XMMATRIX axisModelViewDX = convertVuforiaMatrixToDX(scaledModelViewMatrix);
 
-        Vuforia::Vec3F cubeScaleVec(WORLDORIGIN_CUBE_SCALE, WORLDORIGIN_CUBE_SCALE, WORLDORIGIN_CUBE_SCALE);
-        scaledModelViewMatrix = MathUtils::Matrix44FScale(cubeScaleVec, modelViewMatrix);
+        scaledModelViewMatrix = SampleMath::scaled(modelViewMatrix, WORLDORIGIN_CUBE_SCALE_VEC);
         DirectX::XMMATRIX cubeModelViewDX = convertVuforiaMatrixToDX(scaledModelViewMatrix);
 
         // Draw axes
-        Vuforia::Vec3F axis10cmSize = Vuforia::Vec3F(0.1f, 0.1f, 0.1f);
-        renderAxis(projectionMatrix, modelViewMatrix, axis10cmSize);
+        renderAxis(projectionMatrix, modelViewMatrix, AXIS_10CM_SIZE);
 
         // Draw cube
         DirectX::XMVECTOR color = DirectX::Colors::LightGray;
@@ -487,7 +507,8 @@ namespace winrt::VuforiaSample::implementation
 
         // Draw astronaut
         DirectX::XMMATRIX astronautModelViewDX = convertVuforiaMatrixToDX(modelViewMatrix);
-        renderModel(projectionMatrixDX, astronautModelViewDX, mAstronautVertexBuffer, mAstronautVertexCount, mAstronautTexture.get());
+        size_t astronautLod = selectModelLod(projectionMatrix, modelViewMatrix, mAstronautModel);
+        renderModel(projectionMatrixDX, astronautModelViewDX, mAstronautModel, astronautLod, mAstronautTexture.get());
 
         // Draw axis
         Vuforia::Vec3F axis2cmSize = Vuforia::Vec3F(0.02f, 0.02f, 0.02f);
@@ -504,11 +525,11 @@ namespace winrt::VuforiaSample::implementation
 
         // Draw lander
         DirectX::XMMATRIX landerModelViewDX = convertVuforiaMatrixToDX(modelViewMatrix);
-        renderModel(projectionMatrixDX, landerModelViewDX, mLanderVertexBuffer, mLanderVertexCount, mLanderTexture.get());
+        size_t landerLod = selectModelLod(projectionMatrix, modelViewMatrix, mLanderModel);
+        renderModel(projectionMatrixDX, landerModelViewDX, mLanderModel, landerLod, mLanderTexture.get());
 
         // Draw axis
-        Vuforia::Vec3F axis10cmSize = Vuforia::Vec3F(0.1f, 0.1f, 0.1f);
-        renderAxis(projectionMatrix, modelViewMatrix, axis10cmSize);
+        renderAxis(projectionMatrix, modelViewMatrix, AXIS_10CM_SIZE);
 
         mDeviceResources->GetD3DDeviceContext()->OMSetBlendState(nullptr, 0, 0xffffffff);
     }
@@ -730,6 +751,49 @@ namespace winrt::VuforiaSample::implementation
     }
 
 
+    void DXRenderer::initQuantizedTexturedVertexShader(const std::vector<byte>& fileData)
+    {
+        winrt::check_hresult(
+            mDeviceResources->GetD3DDevice()->CreateVertexShader(
+                &fileData[0],
+                fileData.size(),
+                nullptr,
+                mQuantizedTexturedVertexShader.put()
+                )
+            );
+
+        CD3D11_BUFFER_DESC constantBufferDesc(
+            sizeof(SampleCommon::QuantizedTexturedShaderConstantBuffer),
+            D3D11_BIND_CONSTANT_BUFFER);
+
+        winrt::check_hresult(
+            mDeviceResources->GetD3DDevice()->CreateBuffer(
+                &constantBufferDesc,
+                nullptr,
+                mQuantizedTexturedConstantBuffer.put()
+                )
+            );
+
+        // The layout of QuantizedVertex, the octahedral normal in the w component of POSITION
+        // is uploaded but not lit with yet
+        static const D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
+        {
+            { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_SNORM, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        };
+
+        winrt::check_hresult(
+            mDeviceResources->GetD3DDevice()->CreateInputLayout(
+                vertexDesc,
+                ARRAYSIZE(vertexDesc),
+                &fileData[0],
+                fileData.size(),
+                mQuantizedTexturedInputLayout.put()
+                )
+            );
+    }
+
+
     void DXRenderer::initVideoBackgroundVertexShader(const std::vector<byte>& fileData)
     {
         LOG("initVideoBackgroundVertexShader");
@@ -1080,60 +1144,18 @@ namespace winrt::VuforiaSample::implementation
     {
         LOG("initModels");
 
-        auto loadAstronautModel = DX::ReadDataAsync(RES_PATH_ASTRONAUT_MODEL).then([this](const std::vector<byte>& fileData)
+        auto loadAstronautModel = DX::ReadFileStampAsync(RES_PATH_ASTRONAUT_MODEL).then([this](const DX::FileStamp& stamp)
         {
-            MemoryInputStream fileDataStream(reinterpret_cast<const char*>(fileData.data()), fileData.size());
-
-            tinyobj::attrib_t attrib;
-            std::vector<tinyobj::shape_t> shapes;
-            std::vector<tinyobj::material_t> materials;
-
-            std::string warn;
-            std::string err;
-
-            bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &fileDataStream);
-
-            if (!ret || !err.empty())
-            {
-                LOG("Error loading Astronaut model (%s)", err.c_str());
-                throw winrt::hresult_error(E_FAIL, winrt::to_hstring("Error loading Astronaut obj model"));
-            }
-            if (!warn.empty())
-            {
-                LOG("Warning when loading Astronaut model (%s)", warn.c_str());
-            }
-
-            mAstronautVertexCount = initBuffersFromModel(attrib, shapes, materials, mAstronautVertexBuffer.put());
+            initBuffersFromModel(RES_PATH_ASTRONAUT_MODEL, stamp, mAstronautModel);
 
             mAstronautTexture = std::make_unique<SampleCommon::Texture>(mDeviceResources);
             mAstronautTexture->CreateFromFile(RES_PATH_ASTRONAUT_TEXTURE.c_str());
             mAstronautTexture->Init();
         });
 
-        auto loadLanderModel = DX::ReadDataAsync(RES_PATH_LANDER_MODEL).then([this](const std::vector<byte>& fileData)
+        auto loadLanderModel = DX::ReadFileStampAsync(RES_PATH_LANDER_MODEL).then([this](const DX::FileStamp& stamp)
         {
-            MemoryInputStream fileDataStream(reinterpret_cast<const char*>(fileData.data()), fileData.size());
-
-            tinyobj::attrib_t attrib;
-            std::vector<tinyobj::shape_t> shapes;
-            std::vector<tinyobj::material_t> materials;
-
-            std::string warn;
-            std::string err;
-
-            bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &fileDataStream);
-
-            if (!ret || !err.empty())
-            {
-                LOG("Error loading Lander model (%s)", err.c_str());
-                throw winrt::hresult_error(E_FAIL, winrt::to_hstring("Error loading Lander obj model"));
-            }
-            if (!warn.empty())
-            {
-                LOG("Warning when loading Lander model (%s)", warn.c_str());
-            }
-
-            mLanderVertexCount = initBuffersFromModel(attrib, shapes, materials, mLanderVertexBuffer.put());
+            initBuffersFromModel(RES_PATH_LANDER_MODEL, stamp, mLanderModel);
 
             mLanderTexture = std::make_unique<SampleCommon::Texture>(mDeviceResources);
             mLanderTexture->CreateFromFile(RES_PATH_LANDER_TEXTURE.c_str());
@@ -1145,87 +1167,166 @@ namespace winrt::VuforiaSample::implementation
     }
 
 
-    int DXRenderer::initBuffersFromModel(
-        tinyobj::attrib_t& attrib,
-        std::vector<tinyobj::shape_t>& shapes, std::vector<tinyobj::material_t>& /*materials*/,
-        ID3D11Buffer** vertexBuffer)
+    void DXRenderer::initBuffersFromModel(const winrt::hstring& modelFile, const DX::FileStamp& stamp,
+        ModelBuffers& model)
     {
-        int numVertices = 0;
+        std::string modelName = winrt::to_string(modelFile);
 
-        // Get the count of vertices
-        for (size_t s = 0; s < shapes.size(); s++)
+        // Package files only change with a new deployment, which changes their stamp
+        std::uint64_t sourceHash = MeshCache::hash(modelName.data(), modelName.size());
+        sourceHash = MeshCache::hash(&stamp, sizeof(stamp), sourceHash);
+        sourceHash = MeshCache::hash(&MESH_PIPELINE_VERSION, sizeof(MESH_PIPELINE_VERSION), sourceHash);
+        std::string cachePath = winrt::to_string(
+            Windows::Storage::ApplicationData::Current().LocalCacheFolder().Path() + L"\\" + modelFile + L".mesh");
+
+        MappedMeshCache cache;
+        if (cache.open(cachePath, sourceHash))
         {
-            for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++)
-            {
-                numVertices += shapes[s].mesh.num_face_vertices[f];
-            }
+            LOG("Loaded %s from the mesh cache", modelName.c_str());
+            initBuffersFromMesh(cache.getVertices(), cache.getVertexCount(),
+                cache.getIndices(), cache.getIndexCount(), cache.getIndexSize(),
+                cache.getLods(), cache.getLodCount(),
+                cache.getSubmeshes(), cache.getSubmeshCount(),
+                cache.getNormals(), cache.getBoundsMin(), cache.getBoundsMax(), model);
+            return;
+        }
+
+        std::vector<byte> fileData = DX::ReadDataAsync(modelFile).get();
+
+        // Streamed straight from the file data into the mesh, the model is never held as
+        // tinyobj attributes and shapes
+        Mesh mesh;
+        MeshBuildStats stats;
+        std::string err;
+        std::vector<TriangleRun<std::int32_t>> materialRuns;
+        std::vector<TriangleRun<std::uint32_t>> smoothingGroupRuns;
+        if (!MeshBuilder::buildFromObj(reinterpret_cast<const char*>(fileData.data()), fileData.size(),
+                                       mesh, &stats, &err, &materialRuns, &smoothingGroupRuns))
+        {
+            LOG("Error loading %s (%s)", modelName.c_str(), err.c_str());
+            throw winrt::hresult_error(E_FAIL, L"Error loading obj model " + modelFile);
+        }
+        LOG("Model %s: %zu corners share %zu vertices (%.2f per vertex)", modelName.c_str(),
+            stats.cornerCount, stats.vertexCount, stats.getDedupRatio());
+        LOG("Model %s: built with a peak of %zu bytes for %zu bytes of mesh (%.2fx)", modelName.c_str(),
+            stats.peakBytes, stats.outputBytes, double(stats.peakBytes) / double(stats.outputBytes));
+
+        // Before the optimizer, which moves the normals with their vertices. Models without
+        // s lines are smooth all over.
+        MeshNormalsStats normalsStats;
+        if (MeshNormals::build(mesh, smoothingGroupRuns.empty() ? nullptr : &smoothingGroupRuns,
+                               &normalsStats))
+        {
+            LOG("Model %s: normals built on %u threads, %zu vertices split by smoothing groups", modelName.c_str(),
+                normalsStats.threadCount, normalsStats.splitVertexCount);
+        }
+
+        // One draw call per material, the optimizer and the levels of detail keep the ranges
+        if (MeshPartitioner::partition(mesh, materialRuns))
+        {
+            LOG("Model %s: %zu materials", modelName.c_str(), mesh.submeshes.size());
+        }
+
+        MeshOptimizerStats optimizerStats;
+        MeshOptimizer::optimize(mesh, &optimizerStats);
+        LOG("Model %s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, %zu clusters%s", modelName.c_str(),
+            optimizerStats.acmrBefore, optimizerStats.acmrAfter, optimizerStats.atvrBefore, optimizerStats.atvrAfter,
+            optimizerStats.clusterCount, optimizerStats.overdrawSorted ? " sorted for overdraw" : "");
+
+        MeshSimplifier::buildLods(mesh);
+        for (size_t i = 0; i < mesh.lods.size(); i++)
+        {
+            LOG("Model %s: LOD %zu has %u triangles, error %g", modelName.c_str(),
+                i, mesh.lods[i].indexCount / 3, mesh.lods[i].error);
         }
 
-        SampleCommon::TexturedShaderInputBuffer* inputBufferRaw = new SampleCommon::TexturedShaderInputBuffer[numVertices];
+        // Rendering does not depend on the cache, a failed write is only logged
+        MeshCache::write(cachePath, mesh, sourceHash);
+
+        initBuffersFromMesh(mesh.vertices.data(), static_cast<std::uint32_t>(mesh.vertices.size()),
+            mesh.getIndices(), static_cast<std::uint32_t>(mesh.getIndexCount()), mesh.getIndexSize(),
+            mesh.lods.data(), static_cast<std::uint32_t>(mesh.lods.size()),
+            mesh.submeshes.data(), static_cast<std::uint32_t>(mesh.submeshes.size()),
+            mesh.normals.empty() ? nullptr : mesh.normals.data(), mesh.boundsMin, mesh.boundsMax, model);
+    }
+
 
+    void DXRenderer::initBuffersFromMesh(const MeshVertex* vertices, std::uint32_t numVertices,
+        const void* indices, std::uint32_t numIndices, std::uint32_t indexSize,
+        const MeshLod* lods, std::uint32_t numLods,
+        const Submesh* submeshes, std::uint32_t numSubmeshes,
+        const SampleMath::Vec3* normals, const SampleMath::Vec3& boundsMin, const SampleMath::Vec3& boundsMax,
+        ModelBuffers& model)
+    {
         // The winding order of vertices in the obj files is OpenGL style counter-clockwise
         // We could convert that to the DX convention, instead we have set
         // the RasterizerState for counter-clockwise.
 
-        // Loop over shapes
-        // s is the index into the shapes vector
-        // f is the index of the current face
-        // v is the index of the current vertex
-        // i is the index into the target buffer
-        for (size_t s = 0, i = 0; s < shapes.size(); ++s)
-        {
-            // Loop over faces(polygon)
-            size_t index_offset = 0;
-            for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); ++f)
-            {
-                int fv = shapes[s].mesh.num_face_vertices[f];
-
-                // Loop over vertices in the face.
-                for (size_t v = 0; v < size_t(fv); ++v, ++i)
-                {
-                    // access to vertex
-                    tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-
-                    inputBufferRaw[i].pos = DirectX::XMFLOAT3(
-                        attrib.vertices[3L * idx.vertex_index + 0],
-                        attrib.vertices[3L * idx.vertex_index + 1],
-                        attrib.vertices[3L * idx.vertex_index + 2]);
-
-                    // The model may not have texture coordinates for every vertex
-                    // If a texture coordinate is missing we just set it to 0,0
-                    // This may not be suitable for rendering some OBJ model files
-                    if (idx.texcoord_index < 0)
-                    {
-                        inputBufferRaw[i].texcoord = DirectX::XMFLOAT2(0.f, 0.f);
-                    }
-                    else
-                    {
-                        inputBufferRaw[i].texcoord = DirectX::XMFLOAT2(
-                            attrib.texcoords[2L * idx.texcoord_index + 0],
-                            1.0f - attrib.texcoords[2L * idx.texcoord_index + 1] // vertical flip, convert GL to DX
-                            );
-                    }
-                }
-                index_offset += fv;
-            }
-        }
+        assert(indices != nullptr && (indexSize == 2 || indexSize == 4));
+
+        // The vertices may point into a mapped cache file, quantizing them pages them in
+        std::vector<QuantizedVertex> quantizedVertices;
+        MeshQuantizer::quantize(vertices, numVertices, normals, boundsMin, boundsMax,
+            quantizedVertices, model.quantization);
+
+        QuantizationError error = MeshQuantizer::measureError(vertices, numVertices, normals,
+            quantizedVertices, model.quantization);
+        QuantizationError bound = MeshQuantizer::getErrorBound(model.quantization);
+        LOG("Quantized %u vertices, %zu -> %zu bytes, position error %g (bound %g), texcoord error %g (bound %g), "
+            "normal error %g degrees",
+            numVertices, numVertices * sizeof(MeshVertex), numVertices * sizeof(QuantizedVertex),
+            error.position, bound.position, error.texcoord, bound.texcoord, error.normal);
 
         D3D11_SUBRESOURCE_DATA vertexBufferData = { 0 };
-        vertexBufferData.pSysMem = inputBufferRaw;
+        vertexBufferData.pSysMem = quantizedVertices.data();
         vertexBufferData.SysMemPitch = 0;
         vertexBufferData.SysMemSlicePitch = 0;
-        CD3D11_BUFFER_DESC vertexBufferDesc(numVertices * sizeof(SampleCommon::TexturedShaderInputBuffer), D3D11_BIND_VERTEX_BUFFER);
+        CD3D11_BUFFER_DESC vertexBufferDesc(numVertices * sizeof(QuantizedVertex), D3D11_BIND_VERTEX_BUFFER);
         winrt::check_hresult(
             mDeviceResources->GetD3DDevice()->CreateBuffer(
                 &vertexBufferDesc,
                 &vertexBufferData,
-                vertexBuffer
+                model.vertexBuffer.put()
                 )
             );
-        delete[] inputBufferRaw;
-        inputBufferRaw = nullptr;
 
-        return numVertices;
+        D3D11_SUBRESOURCE_DATA indexBufferData = { 0 };
+        // The indices may point into a mapped cache file, creating the buffer pages them in
+        indexBufferData.pSysMem = indices;
+        indexBufferData.SysMemPitch = 0;
+        indexBufferData.SysMemSlicePitch = 0;
+        CD3D11_BUFFER_DESC indexBufferDesc(numIndices * indexSize, D3D11_BIND_INDEX_BUFFER);
+        winrt::check_hresult(
+            mDeviceResources->GetD3DDevice()->CreateBuffer(
+                &indexBufferDesc,
+                &indexBufferData,
+                model.indexBuffer.put()
+                )
+            );
+
+        model.indexFormat = (indexSize == 2) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+        if (numLods > 0)
+        {
+            model.lods.assign(lods, lods + numLods);
+        }
+        else
+        {
+            model.lods.assign(1, MeshLod{ 0, numIndices, 0.0f });
+        }
+        if (numSubmeshes > 0)
+        {
+            model.submeshes.assign(submeshes, submeshes + numSubmeshes);
+        }
+        else
+        {
+            // Each level is drawn in one piece
+            model.submeshes.clear();
+            for (std::uint32_t i = 0; i < model.lods.size(); i++)
+            {
+                model.submeshes.push_back({ model.lods[i].indexOffset, model.lods[i].indexCount, -1, i,
+                                            boundsMin, boundsMax });
+            }
+        }
     }
 
 
@@ -1238,6 +1339,16 @@ namespace winrt::VuforiaSample::implementation
     }
 
 
+    size_t DXRenderer::selectModelLod(const Vuforia::Matrix44F& projectionMatrix,
+        const Vuforia::Matrix44F& modelViewMatrix, const ModelBuffers& model)
+    {
+        // The size of the model on screen, measured at the center of its bounding box
+        float pixelsPerUnit = MeshSimplifier::getPixelsPerUnit(projectionMatrix, modelViewMatrix,
+            model.quantization.positionOffset, mDeviceResources->GetScreenViewport().Height);
+        return MeshSimplifier::selectLod(model.lods.data(), model.lods.size(), pixelsPerUnit, MAX_LOD_ERROR_PIXELS);
+    }
+
+
     void DXRenderer::renderConstColor(
         const DirectX::XMMATRIX& projection,
         const DirectX::XMMATRIX& modelView,
@@ -1408,19 +1519,31 @@ namespace winrt::VuforiaSample::implementation
 
     void DXRenderer::renderModel(
         const DirectX::XMMATRIX& projection, const DirectX::XMMATRIX& modelView,
-        winrt::com_ptr<ID3D11Buffer> vertices, int numVertices,
-        SampleCommon::Texture* texture)
+        const ModelBuffers& model, size_t lod, SampleCommon::Texture* texture)
     {
-        assert(texture != nullptr);
+        assert(texture != nullptr && lod < model.lods.size());
         auto context = mDeviceResources->GetD3DDeviceContext();
 
+        // The snorm positions are dequantized by scaling and translating them into the
+        // bounding box before the model-view transform. The matrices are column-vector
+        // style, so the dequantization is the right hand factor.
+        const QuantizationParams& quantization = model.quantization;
+        DirectX::XMMATRIX dequantize = DirectX::XMMatrixSet(
+            quantization.positionScale[0], 0.0f, 0.0f, quantization.positionOffset[0],
+            0.0f, quantization.positionScale[1], 0.0f, quantization.positionOffset[1],
+            0.0f, 0.0f, quantization.positionScale[2], quantization.positionOffset[2],
+            0.0f, 0.0f, 0.0f, 1.0f);
+
         // Set the projection matrix
-        SampleCommon::TexturedShaderConstantBuffer vbConstantBufferData;
-        XMStoreFloat4x4(&vbConstantBufferData.modelView, modelView);
+        SampleCommon::QuantizedTexturedShaderConstantBuffer vbConstantBufferData;
+        XMStoreFloat4x4(&vbConstantBufferData.modelView, DirectX::XMMatrixMultiply(modelView, dequantize));
         XMStoreFloat4x4(&vbConstantBufferData.projection, projection);
+        vbConstantBufferData.texcoordTransform = DirectX::XMFLOAT4(
+            quantization.texcoordScale[0], quantization.texcoordScale[1],
+            quantization.texcoordOffset[0], quantization.texcoordOffset[1]);
         // Prepare the constant buffer to send it to the graphics device.
         context->UpdateSubresource1(
-            mTexturedConstantBuffer.get(),
+            mQuantizedTexturedConstantBuffer.get(),
             0,
             NULL,
             &vbConstantBufferData,
@@ -1430,9 +1553,9 @@ namespace winrt::VuforiaSample::implementation
             );
 
         // Each vertex is one instance of the input buffer struct.
-        UINT stride = sizeof(SampleCommon::TexturedShaderInputBuffer);
+        UINT stride = sizeof(QuantizedVertex);
         UINT offset = 0;
-        auto vertexBufferPtr = vertices.get();
+        auto vertexBufferPtr = model.vertexBuffer.get();
         context->IASetVertexBuffers(
             0,
             1,
@@ -1441,15 +1564,21 @@ namespace winrt::VuforiaSample::implementation
             &offset
             );
 
+        context->IASetIndexBuffer(
+            model.indexBuffer.get(),
+            model.indexFormat,
+            0
+            );
+
         context->IASetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-        context->IASetInputLayout(mTexturedInputLayout.get());
+        context->IASetInputLayout(mQuantizedTexturedInputLayout.get());
 
         // Attach our vertex shader.
-        context->VSSetShader(mTexturedVertexShader.get(), nullptr, 0);
+        context->VSSetShader(mQuantizedTexturedVertexShader.get(), nullptr, 0);
 
         // Send the constant buffer to the graphics device.
-        auto texturedConstantBufferPtr = mTexturedConstantBuffer.get();
+        auto texturedConstantBufferPtr = mQuantizedTexturedConstantBuffer.get();
         context->VSSetConstantBuffers1(
             0,
             1,
@@ -1467,8 +1596,15 @@ namespace winrt::VuforiaSample::implementation
         auto textureViewPtr = texture->GetD3DTextureView().get();
         context->PSSetShaderResources(0, 1, &textureViewPtr);
 
-        // Draw the objects.
-        context->Draw(numVertices, 0);
+        // Draw the objects, one call per material. The models share one texture, a
+        // material would set its own state here.
+        for (const Submesh& submesh : model.submeshes)
+        {
+            if (submesh.lod == lod)
+            {
+                context->DrawIndexed(submesh.indexCount, submesh.indexOffset, 0);
+            }
+        }
 
         // Clear the shader resources, as the texture is now
         // the input for the next stage of rendering
@@ -10,9 +10,11 @@ countries.
 #include <atomic>
 #include <memory>
 #include "DeviceResources.h"
+#include "DirectXHelper.h"
 #include "ShaderStructures.h"
 
-#include <tiny_obj_loader.h>
+#include <MeshCache.h>
+#include <MeshQuantizer.h>
 
 #include <Vuforia/Image.h>
 #include <Vuforia/Matrices.h>
@@ -69,6 +71,21 @@ namespace winrt::VuforiaSample::implementation
             Vuforia::Matrix44F& modelViewMatrix,
             const Vuforia::Image* image);
 
+    private: // types
+        /// Buffers of an OBJ model, drawn as an indexed triangle list of QuantizedVertex
+        struct ModelBuffers
+        {
+            winrt::com_ptr<ID3D11Buffer> vertexBuffer;
+            winrt::com_ptr<ID3D11Buffer> indexBuffer;
+            DXGI_FORMAT indexFormat = DXGI_FORMAT_UNKNOWN;
+            /// Ranges of the index buffer, finest first, there is at least one
+            std::vector<MeshLod> lods;
+            /// Ranges of the levels by material, one draw call each, sorted by level.
+            /// Every level has at least one.
+            std::vector<Submesh> submeshes;
+            QuantizationParams quantization;
+        };
+
     private: // methods
         void initConstColorVertexShader(const std::vector<byte>& fileData);
         void initConstColorPixelShader(const std::vector<byte>& fileData);
@@ -76,6 +93,7 @@ namespace winrt::VuforiaSample::implementation
         void initVertexColorPixelShader(const std::vector<byte>& fileData);
         void initTexturedVertexShader(const std::vector<byte>& fileData);
         void initTexturedPixelShader(const std::vector<byte>& fileData);
+        void initQuantizedTexturedVertexShader(const std::vector<byte>& fileData);
         void initVideoBackgroundVertexShader(const std::vector<byte>& fileData);
         void initVideoBackgroundPixelShader(const std::vector<byte>& fileData);
         void initVideoBackgroundRenderState();
@@ -88,13 +106,26 @@ namespace winrt::VuforiaSample::implementation
         void initAxis();
         void initGuideView();
         void initModels();
-        int initBuffersFromModel(
-            tinyobj::attrib_t& attrib,
-            std::vector<tinyobj::shape_t>& shapes, std::vector<tinyobj::material_t>& materials,
-            ID3D11Buffer** vertexBuffer);
+        /// Create the buffers of an OBJ model from the mesh cache, or parse the model
+        /// and add it to the cache
+        void initBuffersFromModel(const winrt::hstring& modelFile, const DX::FileStamp& stamp,
+            ModelBuffers& model);
+        /// Quantize the vertices of a mesh inside its bounds and create its buffers.
+        /// normals is null, or has one normal per vertex.
+        void initBuffersFromMesh(const MeshVertex* vertices, std::uint32_t numVertices,
+            const void* indices, std::uint32_t numIndices, std::uint32_t indexSize,
+            const MeshLod* lods, std::uint32_t numLods,
+            const Submesh* submeshes, std::uint32_t numSubmeshes,
+            const SampleMath::Vec3* normals, const SampleMath::Vec3& boundsMin, const SampleMath::Vec3& boundsMax,
+            ModelBuffers& model);
 
         DirectX::XMMATRIX convertVuforiaMatrixToDX(const Vuforia::Matrix44F& vuforiaMatrix);
 
+        /// The coarsest level of detail of model that is accurate to a pixel when it is drawn
+        /// with the projection and model-view matrices
+        size_t selectModelLod(const Vuforia::Matrix44F& projectionMatrix, const Vuforia::Matrix44F& modelViewMatrix,
+            const ModelBuffers& model);
+
         /// DirectX rendering utility to render an object with a single color
         /// Projection and Model-View are already converted to DirectX matrices
         void renderConstColor(const DirectX::XMMATRIX& projection, const DirectX::XMMATRIX& modelView,
@@ -108,10 +139,10 @@ namespace winrt::VuforiaSample::implementation
             const Vuforia::Vec3F& scale);
 
         /// DirectX rendering utility to render a textured object
-        /// Projection and Model-View are already converted to DirectX matrices
+        /// Projection and Model-View are already converted to DirectX matrices,
+        /// the dequantization of the model is applied here
         void renderModel(const DirectX::XMMATRIX& projection, const DirectX::XMMATRIX& modelView,
-            winrt::com_ptr<ID3D11Buffer> vertices, int numVertices,
-            SampleCommon::Texture* texture);
+            const ModelBuffers& model, size_t lod, SampleCommon::Texture* texture);
 
     private: // data members
         // Cached pointer to device resources.
@@ -172,6 +203,12 @@ namespace winrt::VuforiaSample::implementation
         winrt::com_ptr<ID3D11PixelShader>       mTexturedPixelShader;
         winrt::com_ptr<ID3D11Buffer>            mTexturedConstantBuffer;
 
+        // Direct3D resources for the Quantized textured vertex shader, it shares
+        // the Textured pixel shader
+        winrt::com_ptr<ID3D11InputLayout>       mQuantizedTexturedInputLayout;
+        winrt::com_ptr<ID3D11VertexShader>      mQuantizedTexturedVertexShader;
+        winrt::com_ptr<ID3D11Buffer>            mQuantizedTexturedConstantBuffer;
+
         // Vertices and Indices for drawing a 2D square
         winrt::com_ptr<ID3D11Buffer>            mSquareVertexBuffer;
         winrt::com_ptr<ID3D11Buffer>            mSquareSolidIndexBuffer;
@@ -190,13 +227,11 @@ namespace winrt::VuforiaSample::implementation
         std::unique_ptr<SampleCommon::Texture>  mGuideViewTexture;
 
         // Data for rendering the astronaut
-        winrt::com_ptr<ID3D11Buffer>            mAstronautVertexBuffer;
-        int                                     mAstronautVertexCount;
+        ModelBuffers                            mAstronautModel;
         std::unique_ptr<SampleCommon::Texture>  mAstronautTexture;
 
         // Data for rendering the lander
-        winrt::com_ptr<ID3D11Buffer>            mLanderVertexBuffer;
-        int                                     mLanderVertexCount;
+        ModelBuffers                            mLanderModel;
         std::unique_ptr<SampleCommon::Texture>  mLanderTexture;
     };
 } // namespace winrt::VuforiaSample::implementation
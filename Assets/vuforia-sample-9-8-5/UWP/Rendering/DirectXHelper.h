@@ -10,6 +10,7 @@ countries.
 #include <winrt/Windows.ApplicationModel.h>
 #include <winrt/Windows.Foundation.h>
 #include <winrt/Windows.Storage.h>
+#include <winrt/Windows.Storage.FileProperties.h>
 #include <winrt/Windows.Storage.Streams.h>
 #include <pplawait.h> // For concurrency types on winrt
 #include <d3d11.h>
@@ -36,6 +37,28 @@ namespace winrt::DX
     }
 
 
+    // Size and modification time of a file, identifies its version without reading it.
+    struct FileStamp
+    {
+        uint64_t size;
+        int64_t dateModified;
+    };
+
+    // Function that reads the FileStamp of a file asynchronously.
+    inline concurrency::task<FileStamp> ReadFileStampAsync(const hstring& filename)
+    {
+        using namespace Windows::Storage;
+
+        auto folder = Windows::ApplicationModel::Package::Current().InstalledLocation();
+
+        auto file = co_await folder.GetFileAsync(filename);
+
+        auto properties = co_await file.GetBasicPropertiesAsync();
+
+        co_return FileStamp{ properties.Size(), properties.DateModified().time_since_epoch().count() };
+    }
+
+
     // Converts a length in device-independent pixels (DIPs) to a length in physical pixels.
     inline float ConvertDipsToPixels(float dips, float dpi)
     {
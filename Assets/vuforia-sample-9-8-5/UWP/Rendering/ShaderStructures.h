@@ -53,6 +53,15 @@ namespace SampleCommon
         DirectX::XMFLOAT2 texcoord;
     };
 
+    // Constant buffer used to send projection matrices and the texture coordinate
+    // dequantization (scale in xy, offset in zw) to the vertex shader.
+    struct QuantizedTexturedShaderConstantBuffer
+    {
+        DirectX::XMFLOAT4X4 modelView;
+        DirectX::XMFLOAT4X4 projection;
+        DirectX::XMFLOAT4 texcoordTransform;
+    };
+
     // Constant buffer used to send projection matrices to the vertex shader.
     struct VideoBackgroundShaderConstantBuffer
     {
@@ -33,6 +33,17 @@ using namespace Windows::UI::Xaml::Controls;
 using namespace Windows::UI::Xaml::Navigation;
 
 
+namespace
+{
+    /// The tracking thread publishes a snapshot once per display frame
+    constexpr double TRACKING_INTERVAL = 1.0 / 60.0;
+
+    /// Augmentations are shown at the next vertical blank after Render, about one display frame
+    /// later, and Render takes a snapshot published half a tracking interval earlier on average
+    constexpr double POSE_PREDICTION_LATENCY = 1.0 / 60.0 + TRACKING_INTERVAL / 2.0;
+}
+
+
 namespace winrt::VuforiaSample::implementation
 {
 
@@ -201,6 +212,10 @@ namespace winrt::VuforiaSample::implementation
         config.showErrorCallback = std::bind(&VuforiaPage::PresentError, this, std::placeholders::_1);
         config.initDoneCallback = std::bind(&VuforiaPage::InitDone, this);
 
+        // Extrapolate tracked poses to the time the frame reaches the display
+        mController.setPosePredictionModel(PosePredictor::Model::CONSTANT_VELOCITY);
+        mController.setPredictionLatency(POSE_PREDICTION_LATENCY);
+
         mVuforiaInitializing = true;
         mController.initAR(config, target);
     }
@@ -449,6 +464,9 @@ namespace winrt::VuforiaSample::implementation
             // Only reset this flag if startAR succeeded so we deinit
             // Vuforia when navigating away from this page
             mVuforiaInitializing = false;
+
+            // Paused and stopped with Vuforia by pauseAR and stopAR
+            mController.startTrackingThread(TRACKING_INTERVAL);
         }
 
         // Switch to UI thread to update controls
@@ -483,6 +501,8 @@ namespace winrt::VuforiaSample::implementation
             // Calculate the updated frame and render once per vertical blanking interval.
             while (action.Status() == AsyncStatus::Started)
             {
+                // Tracking runs on the AppController tracking thread, Render takes its
+                // latest snapshot without locking
                 std::scoped_lock<std::mutex> lock(mCriticalSection);
 
                 if (mSwapChainPanelSizeChanged)
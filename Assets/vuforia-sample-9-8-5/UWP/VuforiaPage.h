@@ -10,6 +10,7 @@ countries.
 #include "VuforiaPage.g.h"
 
 #include <AppController.h>
+#include <VuforiaBackend.h>
 #include "Rendering/DeviceResources.h"
 #include "Rendering/StepTimer.h"
 #include "Rendering/DXRenderer.h"
@@ -17,6 +18,7 @@ countries.
 #include <atomic>
 #include <mutex>
 #include <future>
+#include <memory>
 
 
 namespace winrt::VuforiaSample::implementation
@@ -81,7 +83,7 @@ namespace winrt::VuforiaSample::implementation
         /// Resources used to render the DirectX content in the XAML page background.
         std::shared_ptr<winrt::DX::DeviceResources> mDeviceResources;
 
-        AppController mController;
+        AppController mController{ std::make_unique<VuforiaBackend>() };
         bool mVuforiaInitializing = false;
         bool mVuforiaStarted = false;
         std::atomic<bool> mRenderingConfigurationChanged{ true };